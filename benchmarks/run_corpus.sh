@@ -0,0 +1,42 @@
+#!/usr/bin/env bash
+# Solves every Patterson instance in benchmarks/ and a set of generated
+# j30-style instances with and without the model strengthening pass and
+# prints makespan and solve time side by side.
+#
+#   benchmarks/run_corpus.sh [build-dir] [extra rcpsp_solver flags...]
+#
+# The bundled instances are small enough that both runs prove optimality at
+# once. The generated ones follow the hardest j30 class of the PSPLIB (30
+# tasks, 4 resources, every task using every resource, resource strength 0.2),
+# where the solve time shows what the strengthening buys. Set GENERATED=K for
+# K of them (default 10) and TASKS=N for a different size.
+set -euo pipefail
+
+BUILD_DIR=${1:-build}
+shift || true
+SOLVER="$BUILD_DIR/rcpsp_solver"
+GENERATED=${GENERATED:-10}
+TASKS=${TASKS:-30}
+OUT=$(mktemp -d)
+trap 'rm -rf "$OUT"' EXIT
+
+field() {
+  grep -o "\"$1\": [^,]*" "$2" | head -1 | cut -d' ' -f2
+}
+
+instances=("$(dirname "$0")"/*.rcp)
+if [ "$GENERATED" -gt 0 ]; then
+  "$BUILD_DIR/rcpsp_gen" --tasks="$TASKS" --resources=4 --nc=1.8 --rf=1 --rs=0.2 \
+    --seed=1 --count="$GENERATED" --output="$OUT/j$TASKS" 2> /dev/null
+  instances+=("$OUT"/j"$TASKS"_*.rcp)
+fi
+
+printf "%-28s %10s %10s %10s %10s\n" instance makespan time "+makespan" "+time"
+for instance in "${instances[@]}"; do
+  name=$(basename "$instance" .rcp)
+  "$SOLVER" "$OUT/$name.json" --instance="$instance" "$@" > /dev/null
+  "$SOLVER" "$OUT/$name-s.json" --instance="$instance" --strengthen "$@" > /dev/null
+  printf "%-28s %10s %10s %10s %10s\n" "$name" \
+    "$(field makespan "$OUT/$name.json")" "$(field wallTime "$OUT/$name.json")" \
+    "$(field makespan "$OUT/$name-s.json")" "$(field wallTime "$OUT/$name-s.json")"
+done
@@ -1,9 +1,12 @@
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <fstream>
 #include <chrono>
 #include <sstream>
 #include <vector>
 #include <map>
+#include <memory>
 
 // Hack to access private members for debugging
 #define private public
@@ -17,157 +20,321 @@
 #include "ortools/sat/cp_model_solver_helpers.h"
 #include "ortools/sat/model.h"
 #include "ortools/sat/integer.h"
+#include "ortools/sat/sat_base.h"
+#include "ortools/sat/sat_solver.h"
 
 #undef private
 #undef protected
 
+#include "ortools/util/time_limit.h"
+#include "event_schema.h"
+#include "event_writer.h"
+#include "incumbent_stream.h"
+#include "lower_bounds.h"
+#include "model_strengthening.h"
+#include "rcpsp_instance.h"
+#include "sensitivity.h"
+#include "solver_config.h"
+#include "timeline.h"
+
 using namespace operations_research;
 using namespace sat;
 
-// Event types for logging
-enum class EventType {
-  START_VAR_ASSIGNED,
-  START_VAR_CHANGED,
-  TASK_SCHEDULED,
-  SEARCH_DECISION,
-  BACKTRACK,
-  CONFLICT
+// Writes the trace file: the events, then the summaries added during the run.
+class EventLogger {
+public:
+  explicit EventLogger(const std::string& filename)
+      : writer_(filename), start_time_(std::chrono::steady_clock::now()) {
+    writer_.WriteRaw("{\n  \"version\": \"1.0\",\n  \"events\": [\n");
+  }
+
+  ~EventLogger() { Close(); }
+
+  // Writes the summaries, closes the events array and the file. The last
+  // flush happens here, so call it before reading anything that observes
+  // flushes; later calls do nothing.
+  void Close() {
+    if (!writer_.is_open()) return;
+    writer_.WriteRaw("\n  ]");
+    for (const auto& [key, json] : summaries_) {
+      writer_.WriteRaw(",\n  \"");
+      writer_.WriteRaw(key);
+      writer_.WriteRaw("\": ");
+      writer_.WriteRaw(json);
+    }
+    writer_.WriteRaw("\n}\n");
+    writer_.Close();
+  }
+
+  // Stamps the event with the time since the logger was created and writes it.
+  template <EventKind K>
+  void Log(Event<K> event) {
+    event.timestamp = GetTimestamp();
+    writer_.Write(event);
+  }
+
+  // Bounds are flushed like incumbents, so the trace shows how far the
+  // makespan can still drop at any point of the run.
+  void LogLowerBound(int64_t bound, double wall_time) {
+    Event<EventKind::kLowerBound> event;
+    event.task_id = -1;
+    event.task_name = "Solver";
+    event.start_time = bound;
+    event.best_bound = static_cast<double>(bound);
+    event.wall_time = wall_time;
+    Log(event);
+    writer_.Flush();
+  }
+
+  // Incumbents are flushed right away so that a trace of an interrupted run
+  // still ends with the best known schedule.
+  void LogIncumbent(const Incumbent& incumbent) {
+    Event<EventKind::kIncumbent> event;
+    event.task_id = -1;
+    event.task_name = "Solver";
+    event.end_time = static_cast<int64_t>(incumbent.objective);
+    event.incumbent_index = incumbent.index;
+    event.objective = incumbent.objective;
+    event.best_bound = incumbent.best_bound;
+    event.wall_time = incumbent.wall_time;
+    event.solution = incumbent.starts;
+    Log(event);
+    writer_.Flush();
+  }
+
+  int64_t GetTimestamp() const {
+    auto now = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        now - start_time_).count();
+  }
+
+  // Reports every write of the trace file, see EventWriter::FlushObserver.
+  void ObserveFlushes(EventWriter::FlushObserver observer) {
+    writer_.set_flush_observer(std::move(observer));
+  }
+
+  // Adds a top-level JSON field written after the events array.
+  void AddSummary(const std::string& key, const std::string& json) {
+    summaries_.push_back({key, json});
+  }
+
+private:
+  EventWriter writer_;
+  std::vector<std::pair<std::string, std::string>> summaries_;
+  std::chrono::steady_clock::time_point start_time_;
+};
+
+// Proto constraint indices of the RCPSP model, recorded while it is built so
+// that bound changes can be traced back to the constraint that caused them.
+struct ConstraintCatalog {
+  // Per task: (other task, constraint index) of its precedence constraints.
+  std::vector<std::vector<std::pair<int, int>>> predecessors;
+  std::vector<std::vector<std::pair<int, int>>> successors;
+  // Per resource: index of its cumulative constraint, or -1 if unused.
+  std::vector<int> cumulative_index;
+  int makespan_index = -1;
 };
 
-// Event structure for JSON serialization
-struct Event {
-  EventType type;
-  int64_t timestamp;
-  int task_id;
-  std::string task_name;
-  int64_t value;
-  int64_t start_time;
-  int64_t end_time;
-  std::string description;
-  int decision_level;
-  int backtrack_to_level;
-  std::string node_id;
-  std::string parent_node_id;
-  std::string node_status;
-  std::vector<int> dependencies;
-  std::vector<int> successors;
+// Attributes sampled start-variable bound changes to a model constraint.
+//
+// CP-SAT does not record which propagator pushed a bound, so the attributor
+// re-derives the push from the current bounds: a precedence explains it if the
+// predecessor's earliest end (or successor's latest start) reaches the new
+// bound, a cumulative explains it if the compulsory parts of the other tasks
+// on that resource leave no room just before the new bound, and the makespan
+// objective explains upper bounds at the current makespan bound. Anything else
+// is reported as "search" (a decision or a learned-clause propagation).
+class BoundAttributor {
+public:
+  enum Kind { PRECEDENCE, CUMULATIVE, OBJECTIVE, SEARCH, NUM_KINDS };
+
+  struct Attribution {
+    Kind kind;
+    int constraint_index;
+    int resource;
+  };
+
+  BoundAttributor(const RCPSPInstance& instance, ConstraintCatalog catalog,
+                  int sample_rate)
+      : catalog_(std::move(catalog)), sample_rate_(sample_rate) {
+    for (const Task& task : instance.tasks) {
+      durations_.push_back(task.duration);
+      demands_.push_back(task.resource_demands);
+    }
+    for (const Resource& resource : instance.resources) {
+      capacities_.push_back(resource.capacity);
+    }
+  }
 
+  void SetSolverVariables(std::vector<IntegerVariable> start_vars,
+                          IntegerVariable makespan_var,
+                          IntegerTrail* integer_trail) {
+    start_vars_ = std::move(start_vars);
+    makespan_var_ = makespan_var;
+    integer_trail_ = integer_trail;
+  }
+
+  // Deterministic sampling: every sample_rate-th bound change is attributed.
+  bool ShouldSample() { return sample_rate_ > 0 && ++seen_ % sample_rate_ == 0; }
+
+  static Propagator ToPropagator(Kind kind) {
+    switch (kind) {
+      case PRECEDENCE: return Propagator::kPrecedence;
+      case CUMULATIVE: return Propagator::kCumulative;
+      case OBJECTIVE: return Propagator::kObjective;
+      default: return Propagator::kSearch;
+    }
+  }
+
+  static std::string_view KindName(Kind kind) {
+    return kPropagatorNames[static_cast<int>(ToPropagator(kind))];
+  }
+
+  // Explains the change of task `task` from [old_lb, old_ub] to its current
+  // bounds and records it in the histograms.
+  Attribution Explain(int task, int64_t old_lb, int64_t old_ub) {
+    const int64_t lb = Lb(task);
+    const int64_t ub = Ub(task);
+    Attribution attribution{SEARCH, -1, -1};
+    if (lb > old_lb) {
+      attribution = ExplainLowerBound(task, lb);
+    } else if (ub < old_ub) {
+      attribution = ExplainUpperBound(task, ub);
+    }
+    const int64_t shift = std::max<int64_t>(0, lb - old_lb) +
+                          std::max<int64_t>(0, old_ub - ub);
+    Bucket& bucket = histogram_[{attribution.kind, attribution.constraint_index}];
+    bucket.resource = attribution.resource;
+    ++bucket.count;
+    bucket.shift += shift;
+    return attribution;
+  }
+
+  void RecordConflicts(int64_t count, int explanation_size) {
+    conflicts_ += count;
+    int bucket = 1;
+    while (bucket < explanation_size) bucket *= 2;
+    explanation_sizes_[bucket] += count;
+  }
+
+  // Histograms as JSON, largest pruning first.
   std::string ToJson() const {
+    std::vector<std::pair<std::pair<int, int>, Bucket>> buckets(
+        histogram_.begin(), histogram_.end());
+    std::sort(buckets.begin(), buckets.end(), [](const auto& a, const auto& b) {
+      return a.second.shift > b.second.shift;
+    });
     std::ostringstream oss;
-    oss << "{";
-    oss << "\"id\":\"" << task_id << "_" << GetTypeString() << "_" << timestamp << "\",";
-    oss << "\"type\":\"" << GetTypeString() << "\",";
-    oss << "\"taskId\":\"" << task_id << "\",";
-    oss << "\"taskName\":\"" << task_name << "\",";
-    oss << "\"timestamp\":" << timestamp << ",";
-    oss << "\"startTime\":" << start_time << ",";
-    oss << "\"endTime\":" << end_time << ",";
-    oss << "\"decisionLevel\":" << decision_level << ",";
-    oss << "\"backtrackToLevel\":" << backtrack_to_level << ",";
-    oss << "\"nodeId\":\"" << node_id << "\",";
-    oss << "\"parentNodeId\":\"" << parent_node_id << "\",";
-    oss << "\"nodeStatus\":\"" << node_status << "\",";
-    oss << "\"description\":\"" << description << "\",";
-    oss << "\"dependencies\":[";
-    for (size_t i = 0; i < dependencies.size(); ++i) {
+    oss << "{\"sampleRate\":" << sample_rate_ << ",\"sampled\":" << seen_ / std::max(1, sample_rate_);
+    oss << ",\"constraints\":[";
+    for (size_t i = 0; i < buckets.size(); ++i) {
       if (i > 0) oss << ",";
-      oss << dependencies[i];
+      oss << "{\"propagator\":\"" << KindName(static_cast<Kind>(buckets[i].first.first))
+          << "\",\"constraintIndex\":" << buckets[i].first.second;
+      if (buckets[i].second.resource >= 0) {
+        oss << ",\"resourceId\":\"" << buckets[i].second.resource << "\"";
+      }
+      oss << ",\"count\":" << buckets[i].second.count
+          << ",\"shift\":" << buckets[i].second.shift << "}";
     }
-    oss << "],";
-    oss << "\"successors\":[";
-    for (size_t i = 0; i < successors.size(); ++i) {
-      if (i > 0) oss << ",";
-      oss << successors[i];
+    oss << "],\"conflicts\":" << conflicts_ << ",\"explanationSizes\":[";
+    bool first = true;
+    for (const auto& [size, count] : explanation_sizes_) {
+      if (!first) oss << ",";
+      oss << "{\"upTo\":" << size << ",\"count\":" << count << "}";
+      first = false;
     }
-    oss << "]";
-    oss << "}";
+    oss << "]}";
     return oss.str();
   }
 
-private:
-  std::string GetTypeString() const {
-    switch (type) {
-      case EventType::START_VAR_ASSIGNED: return "assign";
-      case EventType::START_VAR_CHANGED: return "modify";
-      case EventType::TASK_SCHEDULED: return "start";
-      case EventType::SEARCH_DECISION: return "start";
-      case EventType::BACKTRACK: return "remove";
-      case EventType::CONFLICT: return "remove";
-      default: return "unknown";
+  void PrintSummary() const {
+    std::cout << "\nBound change attribution (1 in " << sample_rate_ << " sampled):" << std::endl;
+    for (const auto& [key, bucket] : histogram_) {
+      std::cout << "  " << KindName(static_cast<Kind>(key.first));
+      if (key.second >= 0) std::cout << " #" << key.second;
+      if (bucket.resource >= 0) std::cout << " (resource " << bucket.resource << ")";
+      std::cout << ": " << bucket.count << " changes, " << bucket.shift
+                << " time units pruned" << std::endl;
     }
+    std::cout << "  conflicts: " << conflicts_ << std::endl;
   }
-};
 
-// Event logger that writes to JSON file
-class EventLogger {
-public:
-  explicit EventLogger(const std::string& filename) 
-      : filename_(filename), start_time_(std::chrono::steady_clock::now()) {
-    file_.open(filename);
-    if (file_.is_open()) {
-      file_ << "{\n";
-      file_ << "  \"version\": \"1.0\",\n";
-      file_ << "  \"events\": [\n";
-      first_event_ = true;
+private:
+  struct Bucket {
+    int resource = -1;
+    int64_t count = 0;
+    int64_t shift = 0;
+  };
+
+  int64_t Lb(int task) const { return integer_trail_->LowerBound(start_vars_[task]).value(); }
+  int64_t Ub(int task) const { return integer_trail_->UpperBound(start_vars_[task]).value(); }
+
+  Attribution ExplainLowerBound(int task, int64_t lb) const {
+    for (const auto& [pred, index] : catalog_.predecessors[task]) {
+      if (Lb(pred) + durations_[pred] >= lb) return {PRECEDENCE, index, -1};
+    }
+    // A start at lb - 1 must overload some resource.
+    for (size_t r = 0; r < capacities_.size(); ++r) {
+      if (Overloads(task, r, lb - 1)) {
+        return {CUMULATIVE, catalog_.cumulative_index[r], static_cast<int>(r)};
+      }
     }
+    return {SEARCH, -1, -1};
   }
 
-  ~EventLogger() {
-    if (file_.is_open()) {
-      file_ << "\n  ]\n";
-      file_ << "}\n";
-      file_.close();
+  Attribution ExplainUpperBound(int task, int64_t ub) const {
+    for (const auto& [succ, index] : catalog_.successors[task]) {
+      if (Ub(succ) - durations_[task] <= ub) return {PRECEDENCE, index, -1};
+    }
+    if (integer_trail_->UpperBound(makespan_var_).value() - durations_[task] <= ub) {
+      return {OBJECTIVE, catalog_.makespan_index, -1};
+    }
+    for (size_t r = 0; r < capacities_.size(); ++r) {
+      if (Overloads(task, r, ub + 1)) {
+        return {CUMULATIVE, catalog_.cumulative_index[r], static_cast<int>(r)};
+      }
     }
+    return {SEARCH, -1, -1};
   }
 
-  void LogEvent(const Event& event) {
-    if (!file_.is_open()) return;
-
-    if (!first_event_) {
-      file_ << ",\n";
-    } else {
-      first_event_ = false;
+  // True if running `task` from `start` exceeds the capacity of resource r
+  // given the compulsory parts [ub, lb + duration) of the other tasks.
+  bool Overloads(int task, size_t r, int64_t start) const {
+    const int demand = demands_[task][r];
+    if (demand == 0 || catalog_.cumulative_index[r] < 0) return false;
+    const int64_t end = start + durations_[task];
+    std::vector<std::pair<int64_t, int>> profile;
+    for (size_t other = 0; other < durations_.size(); ++other) {
+      if (static_cast<int>(other) == task || demands_[other][r] == 0) continue;
+      const int64_t from = std::max(Ub(other), start);
+      const int64_t to = std::min(Lb(other) + durations_[other], end);
+      if (from >= to) continue;
+      profile.push_back({from, demands_[other][r]});
+      profile.push_back({to, -demands_[other][r]});
     }
-
-    file_ << "    " << event.ToJson();
-    file_.flush();
-  }
-
-  void LogEvent(EventType type, int64_t timestamp, int task_id, const std::string& task_name,
-                int64_t value, int64_t start_time, int64_t end_time, const std::string& description,
-                int decision_level = 0, int backtrack_to_level = 0, const std::string& node_id = "",
-                const std::string& parent_node_id = "", const std::string& node_status = "",
-                const std::vector<int>& dependencies = {}, const std::vector<int>& successors = {}) {
-    Event event;
-    event.type = type;
-    event.timestamp = timestamp;
-    event.task_id = task_id;
-    event.task_name = task_name;
-    event.value = value;
-    event.start_time = start_time;
-    event.end_time = end_time;
-    event.description = description;
-    event.decision_level = decision_level;
-    event.backtrack_to_level = backtrack_to_level;
-    event.node_id = node_id;
-    event.parent_node_id = parent_node_id;
-    event.node_status = node_status;
-    event.dependencies = dependencies;
-    event.successors = successors;
-    LogEvent(event);
+    std::sort(profile.begin(), profile.end());
+    int load = demand;
+    for (const auto& [time, delta] : profile) {
+      load += delta;
+      if (load > capacities_[r]) return true;
+    }
+    return false;
   }
 
-  int64_t GetTimestamp() const {
-    auto now = std::chrono::steady_clock::now();
-    return std::chrono::duration_cast<std::chrono::milliseconds>(
-        now - start_time_).count();
-  }
+  ConstraintCatalog catalog_;
+  const int sample_rate_;
+  std::vector<int> durations_;
+  std::vector<std::vector<int>> demands_;
+  std::vector<int> capacities_;
+  std::vector<IntegerVariable> start_vars_;
+  IntegerVariable makespan_var_;
+  IntegerTrail* integer_trail_ = nullptr;
 
-private:
-  std::string filename_;
-  std::ofstream file_;
-  std::chrono::steady_clock::time_point start_time_;
-  bool first_event_;
+  int64_t seen_ = 0;
+  std::map<std::pair<int, int>, Bucket> histogram_;
+  int64_t conflicts_ = 0;
+  std::map<int, int64_t> explanation_sizes_;
 };
 
 // Custom propagator that watches start variables
@@ -178,20 +345,30 @@ StartVariableWatcher(const std::vector<IntegerVariable>& start_vars,
                        const std::vector<std::string>& task_names,
                        const std::map<int, int>& task_durations,
                        IntegerTrail* integer_trail,
-                       EventLogger* logger)
+                       EventLogger* logger,
+                       BoundAttributor* attributor = nullptr,
+                       SatSolver* sat_solver = nullptr,
+                       Trail* trail = nullptr,
+                       Timeline* timeline = nullptr,
+                       int timeline_sample = 1)
       : start_vars_(start_vars),
         task_ids_(task_ids),
         task_names_(task_names),
         task_durations_(task_durations),
         integer_trail_(integer_trail),
         logger_(logger),
+        attributor_(attributor),
+        sat_solver_(sat_solver),
+        trail_(trail),
+        timeline_(timeline),
+        timeline_sample_(timeline_sample),
         decision_level_(0),
         max_decision_level_(0),
-        current_node_id_(""),
+        current_node_id_(kNoNode),
         node_counter_(0) {
     CHECK(start_vars_.size() == task_ids_.size());
     CHECK(start_vars_.size() == task_names_.size());
-    node_stack_.push_back("root");
+    node_stack_.push_back(kRootNode);
   }
 
 bool Propagate() override {
@@ -200,12 +377,19 @@ bool Propagate() override {
     if (call_count <= 10) {
       std::cout << "Propagate() called, count=" << call_count << std::endl;
     }
+    // One call in timeline_sample_ is timed, the rest would swamp the profile.
+    TimelineSpan span(call_count % timeline_sample_ == 0 ? timeline_ : nullptr,
+                      "Propagate", "propagation");
+
+    if (attributor_ != nullptr) {
+      LogConflicts();
+    }
 
     // Check all start variables for changes
     for (size_t i = 0; i < start_vars_.size(); ++i) {
       IntegerVariable var = start_vars_[i];
       int task_id = task_ids_[i];
-      std::string task_name = task_names_[i];
+      const std::string& task_name = task_names_[i];
 
       // Get current bounds
       const IntegerValue lb = integer_trail_->LowerBound(var);
@@ -237,23 +421,17 @@ bool Propagate() override {
             }
 
             // Get parent after popping
-            std::string parent_id = node_stack_.empty() ? "root" : node_stack_.back();
-
-            logger_->LogEvent(
-              EventType::BACKTRACK,
-              logger_->GetTimestamp(),
-              task_id,
-              task_name,
-              it->second,
-              it->second,
-              value,
-              "Backtracked from " + std::to_string(it->second) + " to " + std::to_string(value),
-              decision_level_,
-              backtrack_to,
-              current_node_id_,
-              parent_id,
-              "pruned"
-            );
+            Event<EventKind::kBacktrack> backtrack;
+            backtrack.task_id = task_id;
+            backtrack.task_name = task_name;
+            backtrack.start_time = it->second;
+            backtrack.end_time = value;
+            backtrack.decision_level = decision_level_;
+            backtrack.backtrack_to_level = backtrack_to;
+            backtrack.node_id = current_node_id_;
+            backtrack.parent_node_id = node_stack_.empty() ? kRootNode : node_stack_.back();
+            backtrack.node_status = NodeStatus::kPruned;
+            logger_->Log(backtrack);
           }
 
           // Check if this is a new task being decided
@@ -265,46 +443,24 @@ bool Propagate() override {
           }
 
           // New assignment - create new node
-          std::string node_id = "node_" + std::to_string(node_counter_++);
-          std::string parent_id = node_stack_.empty() ? "root" : node_stack_.back();
+          const int node_id = node_counter_++;
+          const int parent_id = node_stack_.empty() ? kRootNode : node_stack_.back();
 
-          parent_map_[node_id] = parent_id;
           node_stack_.push_back(node_id);
           current_node_id_ = node_id;
 
-          int64_t end_time = value + task_durations_[task_id];
-
-          logger_->LogEvent(
-            EventType::START_VAR_ASSIGNED,
-            logger_->GetTimestamp(),
-            task_id,
-            task_name,
-            value,
-            value,
-            end_time,
-            "Start variable fixed to " + std::to_string(value),
-            decision_level_,
-            0,
-            node_id,
-            parent_id,
-            "created"
-          );
-
-          logger_->LogEvent(
-            EventType::TASK_SCHEDULED,
-            logger_->GetTimestamp(),
-            task_id,
-            task_name,
-            value,
-            value,
-            end_time,
-            "Task scheduled at time " + std::to_string(value),
-            decision_level_,
-            0,
-            node_id,
-            parent_id,
-            "created"
-          );
+          Event<EventKind::kStartAssigned> assigned;
+          assigned.task_id = task_id;
+          assigned.task_name = task_name;
+          assigned.start_time = value;
+          assigned.end_time = value + task_durations_[task_id];
+          assigned.decision_level = decision_level_;
+          assigned.node_id = node_id;
+          assigned.parent_node_id = parent_id;
+          assigned.node_status = NodeStatus::kCreated;
+          logger_->Log(assigned);
+
+          logger_->Log(Event<EventKind::kTaskScheduled>(assigned));
 
           logged_assignments_[task_id] = value;
         }
@@ -312,23 +468,27 @@ bool Propagate() override {
         // Variable not fixed, log if bounds changed
         auto it = logged_bounds_.find(task_id);
         if (it == logged_bounds_.end() || it->second.first != lb.value() || it->second.second != ub.value()) {
-          logged_bounds_[task_id] = {lb.value(), ub.value()};
+          Event<EventKind::kBoundsChanged> event;
+          event.task_id = task_id;
+          event.task_name = task_name;
+          event.start_time = lb.value();
+          event.end_time = ub.value();
+          event.decision_level = decision_level_;
+          event.node_id = current_node_id_;
+          event.parent_node_id = node_stack_.empty() ? kNoNode : node_stack_.back();
+          event.node_status = NodeStatus::kCreated;
+
+          if (attributor_ != nullptr && it != logged_bounds_.end() &&
+              attributor_->ShouldSample()) {
+            const BoundAttributor::Attribution attribution =
+                attributor_->Explain(i, it->second.first, it->second.second);
+            event.propagator = BoundAttributor::ToPropagator(attribution.kind);
+            event.constraint_index = attribution.constraint_index;
+            event.resource_id = attribution.resource;
+          }
 
-          logger_->LogEvent(
-            EventType::START_VAR_CHANGED,
-            logger_->GetTimestamp(),
-            task_id,
-            task_name,
-            lb.value(),
-            lb.value(),
-            ub.value(),
-            "Start variable bounds updated: [" + std::to_string(lb.value()) + ", " + std::to_string(ub.value()) + "]",
-            decision_level_,
-            0,
-            current_node_id_,
-            node_stack_.empty() ? "" : node_stack_.back(),
-            "created"
-          );
+          logged_bounds_[task_id] = {lb.value(), ub.value()};
+          logger_->Log(event);
         }
       }
     }
@@ -341,6 +501,30 @@ bool Propagate() override {
   }
 
 private:
+  // Emits a CONFLICT event if the SAT solver failed since the last call. The
+  // failing clause is the conflict explanation before clause learning.
+  void LogConflicts() {
+    const int64_t failures = sat_solver_->num_failures();
+    if (failures == last_num_failures_) return;
+    const int64_t new_conflicts = failures - last_num_failures_;
+    last_num_failures_ = failures;
+
+    const int explanation_size = static_cast<int>(trail_->FailingClause().size());
+    attributor_->RecordConflicts(new_conflicts, explanation_size);
+
+    Event<EventKind::kConflict> event;
+    event.task_id = -1;
+    event.task_name = "Solver";
+    event.decision_level = decision_level_;
+    event.backtrack_to_level = decision_level_;
+    event.node_id = current_node_id_;
+    event.parent_node_id = node_stack_.empty() ? kNoNode : node_stack_.back();
+    event.node_status = NodeStatus::kPruned;
+    event.conflicts = new_conflicts;
+    event.explanation_size = explanation_size;
+    logger_->Log(event);
+  }
+
   std::vector<IntegerVariable> start_vars_;
   std::vector<int> task_ids_;
   std::vector<std::string> task_names_;
@@ -348,6 +532,16 @@ private:
   IntegerTrail* integer_trail_;
   EventLogger* logger_;
 
+  // Optional attribution mode
+  BoundAttributor* attributor_;
+  SatSolver* sat_solver_;
+  Trail* trail_;
+  int64_t last_num_failures_ = 0;
+
+  // Optional wall-time profile, one sampled span per timeline_sample_ calls
+  Timeline* timeline_;
+  int timeline_sample_;
+
   // Track logged assignments to avoid duplicates
   std::map<int, int64_t> logged_assignments_;
   std::map<int, std::pair<int64_t, int64_t>> logged_bounds_;
@@ -355,32 +549,12 @@ private:
   // Search tree tracking
   int decision_level_;
   int max_decision_level_;
-  std::string current_node_id_;
+  int current_node_id_;
   int current_task_id_;
-  std::vector<std::string> node_stack_;
-  std::map<std::string, std::string> parent_map_;
+  std::vector<int> node_stack_;
   int node_counter_;
 };
 
-// RCPSP instance structure
-struct Task {
-  int id;
-  std::string name;
-  int duration;
-  std::vector<int> successors;
-  std::vector<int> resource_demands;
-};
-
-struct Resource {
-  int capacity;
-};
-
-struct RCPSPInstance {
-  std::vector<Task> tasks;
-  std::vector<Resource> resources;
-  int horizon;
-};
-
 // Forward declarations
 RCPSPInstance CreateSimpleInstance();
 RCPSPInstance CreateComplexInstance();
@@ -599,8 +773,36 @@ RCPSPInstance CreateSoftwareDevInstance() {
 
 int main(int argc, char** argv) {
   std::string instance_type = "simple";
-  if (argc > 1) {
-    instance_type = argv[1];
+  StopPolicy stop_policy;
+  StrengtheningOptions strengthening;
+  int attribution_sample_rate = 0;
+  ProbeOptions probing;
+  SensitivityOptions sensitivity;
+  TimelineOptions timeline_options;
+  SolverConfig config;
+  if (!config.LoadFromArgs(argc, argv)) return 1;
+  config.model.ApplyTo(&strengthening);
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (SolverConfig::IsFlag(arg) || stop_policy.ParseFlag(arg) ||
+        strengthening.ParseFlag(arg) || probing.ParseFlag(arg) ||
+        sensitivity.ParseFlag(arg) || timeline_options.ParseFlag(arg)) {
+      continue;
+    }
+    if (arg.rfind("--attribution=", 0) == 0) {
+      attribution_sample_rate = std::atoi(arg.c_str() + 14);
+      continue;
+    }
+    if (arg.rfind("--", 0) == 0) {
+      std::cerr << "Unknown flag: " << arg << std::endl;
+      return 1;
+    }
+    instance_type = arg;
+  }
+  std::string policy_error;
+  if (!stop_policy.Validate(&policy_error)) {
+    std::cerr << policy_error << std::endl;
+    return 1;
   }
 
   std::string output_file = "events-" + instance_type + ".json";
@@ -609,8 +811,18 @@ int main(int argc, char** argv) {
   std::cout << "Instance type: " << instance_type << std::endl;
   std::cout << "Output file: " << output_file << std::endl;
 
+  // The timeline outlives the logger, whose flushes it records.
+  Timeline timeline_storage(timeline_options.max_events);
+  Timeline* timeline = timeline_options.enabled() ? &timeline_storage : nullptr;
+
   // Create event logger
   EventLogger logger(output_file);
+  if (timeline != nullptr) {
+    logger.ObserveFlushes([timeline](size_t bytes, Timeline::Clock::time_point begin) {
+      timeline->Complete("Flush", "trace", begin, Timeline::Clock::now(),
+                         "{\"bytes\":" + std::to_string(bytes) + "}");
+    });
+  }
 
   // Create RCPSP instance
   RCPSPInstance instance;
@@ -625,7 +837,19 @@ int main(int argc, char** argv) {
   }
   std::cout << "Created RCPSP instance with " << instance.tasks.size() << " tasks" << std::endl;
 
+  // Destructive bounds are proven before the traced search; the bound
+  // constrains it and the best probe schedule is its hint.
+  ProbeResult probe;
+  if (probing.enabled()) {
+    TimelineSpan span(timeline, "Probe", "bounds");
+    probe = ProbeMakespan(instance, probing, nullptr, [&logger](int64_t bound) {
+      logger.LogLowerBound(bound, logger.GetTimestamp() / 1000.0);
+    });
+    std::cout << "Probing: " << probe.Summary() << std::endl;
+  }
+
   // Build CP-SAT model
+  const Timeline::Clock::time_point build_begin = Timeline::Clock::now();
   CpModelBuilder cp_model;
   std::vector<IntervalVar> intervals;
   std::vector<IntegerVariable> start_vars;
@@ -642,6 +866,8 @@ int main(int argc, char** argv) {
     
     IntervalVar interval = cp_model.NewIntervalVar(start, duration, end);
     intervals.push_back(interval);
+    // The best probe schedule hints the search, as in rcpsp_solver.
+    if (!probe.starts.empty()) cp_model.AddHint(start, probe.starts[i]);
     
     // Store task ID, name, and start variable
     task_ids.push_back(task.id);
@@ -662,42 +888,45 @@ int main(int argc, char** argv) {
   // Log task definitions with dependencies and resource demands
   for (int i = 0; i < instance.tasks.size(); ++i) {
     const auto& task = instance.tasks[i];
-    std::string resource_info = "Resources: [";
-    for (size_t r = 0; r < task.resource_demands.size(); ++r) {
-      if (r > 0) resource_info += ", ";
-      resource_info += std::to_string(task.resource_demands[r]);
-    }
-    resource_info += "]";
-    logger.LogEvent(
-      EventType::TASK_SCHEDULED,
-      logger.GetTimestamp(),
-      task.id,
-      task.name,
-      task.duration,
-      0,
-      task.duration,
-      "Task defined with duration " + std::to_string(task.duration) + " " + resource_info,
-      0,
-      0,
-      "",
-      "",
-      "",
-      predecessors[i],
-      task.successors
-    );
+    Event<EventKind::kTaskDefined> event;
+    event.task_id = task.id;
+    event.task_name = task.name;
+    event.end_time = task.duration;
+    event.dependencies = predecessors[i];
+    event.successors = task.successors;
+    event.demands = task.resource_demands;
+    logger.Log(event);
   }
   
   std::cout << "Built model with " << start_vars.size() << " start variables" << std::endl;
 
+  // Remember which proto constraint implements what, for attribution
+  ConstraintCatalog catalog;
+  catalog.predecessors.resize(instance.tasks.size());
+  catalog.successors.resize(instance.tasks.size());
+  catalog.cumulative_index.assign(instance.resources.size(), -1);
+
   // Add precedence constraints
   for (int i = 0; i < instance.tasks.size(); ++i) {
     for (int succ : instance.tasks[i].successors) {
+      const int index = cp_model.Proto().constraints_size();
       cp_model.AddLessOrEqual(intervals[i].EndExpr(), intervals[succ].StartExpr());
+      catalog.predecessors[succ].push_back({i, index});
+      catalog.successors[i].push_back({succ, index});
     }
   }
   
+  StrengtheningPlan plan;
+  if (strengthening.enabled) {
+    plan = AnalyzeInstance(instance, strengthening);
+    std::cout << "Strengthening: " << plan.Summary() << std::endl;
+  }
+
   // Add cumulative resource constraints
   for (int r = 0; r < instance.resources.size(); ++r) {
+    // Unary resources get a no-overlap from the strengthening pass instead
+    if (plan.IsUnary(r)) continue;
+
     std::vector<IntervalVar> resource_intervals;
     std::vector<int64_t> demands;
     
@@ -709,6 +938,7 @@ int main(int argc, char** argv) {
     }
     
     if (!resource_intervals.empty()) {
+      catalog.cumulative_index[r] = cp_model.Proto().constraints_size();
       auto cumulative = cp_model.AddCumulative(
           cp_model.NewConstant(instance.resources[r].capacity));
       for (size_t i = 0; i < resource_intervals.size(); ++i) {
@@ -723,25 +953,45 @@ int main(int argc, char** argv) {
   for (const auto& interval : intervals) {
     ends.push_back(interval.EndExpr());
   }
+  catalog.makespan_index = cp_model.Proto().constraints_size();
   cp_model.AddMaxEquality(makespan, ends);
+  if (probe.lower_bound > 0) {
+    cp_model.AddGreaterOrEqual(makespan, probe.lower_bound);
+  }
 cp_model.Minimize(makespan);
 
+  if (strengthening.enabled) {
+    const std::vector<int> unary_index =
+        ApplyStrengthening(plan, intervals, makespan, &cp_model);
+    for (size_t r = 0; r < unary_index.size(); ++r) {
+      if (unary_index[r] >= 0) catalog.cumulative_index[r] = unary_index[r];
+    }
+  }
+
   // Build the CpModelProto
   CpModelProto model_proto = cp_model.Build();
   std::cout << "Built CpModelProto with " << model_proto.variables_size() << " variables" << std::endl;
   
   // Add a search strategy to the model proto to configure search heuristics
-  // This is required for SolveLoadedCpModel to work properly
-  DecisionStrategyProto* strategy = model_proto.add_search_strategy();
-  strategy->set_variable_selection_strategy(DecisionStrategyProto::CHOOSE_FIRST);
-  strategy->set_domain_reduction_strategy(DecisionStrategyProto::SELECT_MIN_VALUE);
-  
-  // Add all start variables to the search strategy
+  // This is required for SolveLoadedCpModel to work properly, so a config
+  // without one falls back to fixing the starts in task order.
+  ModelOptions search = config.model;
+  if (!search.variable_selection.has_value()) {
+    search.variable_selection = DecisionStrategyProto::CHOOSE_FIRST;
+  }
+  std::vector<int> strategy_vars;
   for (const IntegerVariable& var : start_vars) {
-    strategy->add_variables(var.value());
+    strategy_vars.push_back(var.value());
+  }
+  search.AddSearchStrategy(strategy_vars, &model_proto);
+
+  std::cout << "Added search strategy with " << strategy_vars.size() << " variables" << std::endl;
+  if (timeline != nullptr) {
+    timeline->Complete("BuildModel", "model", build_begin, Timeline::Clock::now(),
+                       "{\"tasks\":" + std::to_string(instance.tasks.size()) +
+                           ",\"constraints\":" +
+                           std::to_string(model_proto.constraints_size()) + "}");
   }
-
-  std::cout << "Added search strategy with " << strategy->variables_size() << " variables" << std::endl;
 
   // Create Model for solver
   Model model;
@@ -749,17 +999,40 @@ cp_model.Minimize(makespan);
   // Configure solver parameters BEFORE loading the model
   SatParameters parameters;
   parameters.set_max_time_in_seconds(30.0);
-  parameters.set_num_search_workers(1);
   parameters.set_search_branching(SatParameters::PORTFOLIO_SEARCH);
+  parameters.MergeFrom(config.parameters);
+  // The watcher reads the loaded model directly on one search thread, so
+  // these stay fixed whatever the config says.
+  const SatParameters& loaded = config.parameters;
+  if ((loaded.has_num_workers() && loaded.num_workers() != 1) ||
+      (loaded.has_num_search_workers() && loaded.num_search_workers() != 1) ||
+      (loaded.has_cp_model_presolve() && loaded.cp_model_presolve()) ||
+      (loaded.has_enumerate_all_solutions() && !loaded.enumerate_all_solutions())) {
+    std::cerr << "Warning: driver solves on one worker without presolve and "
+                 "enumerates all solutions; the config's settings for these are "
+                 "ignored"
+              << std::endl;
+  }
+  parameters.clear_num_workers();
+  parameters.set_num_search_workers(1);
   parameters.set_cp_model_presolve(false);
   parameters.set_enumerate_all_solutions(true);
+  stop_policy.ApplyTo(&parameters);
 
   model.Add(NewSatParameters(parameters));
 
+  // SolveLoadedCpModel bypasses the shared time limit used by StopSearch(), so
+  // the stop policies interrupt the search through the model's own TimeLimit.
+  std::atomic<bool> stop_requested(false);
+  model.GetOrCreate<TimeLimit>()->RegisterExternalBooleanAsLimit(&stop_requested);
+
   model.GetOrCreate<SharedResponseManager>()->InitializeObjective(model_proto);
   std::cout << "Initialized objective" << std::endl;
 
-  LoadCpModel(model_proto, &model);
+  {
+    TimelineSpan span(timeline, "LoadCpModel", "solver");
+    LoadCpModel(model_proto, &model);
+  }
   CpModelMapping* mapping = model.GetOrCreate<CpModelMapping>();
   std::cout << "Loaded full model into model" << std::endl;
 
@@ -773,13 +1046,31 @@ cp_model.Minimize(makespan);
   }
   std::cout << "Converted " << solver_start_vars.size() << " variables to solver variables" << std::endl;
 
+  // Opt-in attribution of bound changes to constraints, sampled because every
+  // explanation rescans the compulsory parts of a resource.
+  std::unique_ptr<BoundAttributor> attributor;
+  if (attribution_sample_rate > 0) {
+    attributor = std::make_unique<BoundAttributor>(instance, std::move(catalog),
+                                                   attribution_sample_rate);
+    attributor->SetSolverVariables(solver_start_vars,
+                                   mapping->Integer(makespan.index()),
+                                   integer_trail);
+    std::cout << "Attributing 1 in " << attribution_sample_rate
+              << " bound changes" << std::endl;
+  }
+
   StartVariableWatcher* start_watcher = new StartVariableWatcher(
     solver_start_vars,
     task_ids,
     task_names,
     task_durations,
     integer_trail,
-    &logger
+    &logger,
+    attributor.get(),
+    model.GetOrCreate<SatSolver>(),
+    model.GetOrCreate<Trail>(),
+    timeline,
+    timeline_options.propagate_sample
   );
 
   const int propagator_id = watcher->Register(start_watcher);
@@ -795,25 +1086,52 @@ cp_model.Minimize(makespan);
   std::cout << "Registered start variable watcher with ID " << propagator_id << std::endl;
   std::cout << "Watching " << solver_start_vars.size() << " solver variables" << std::endl;
 
-  logger.LogEvent(
-    EventType::SEARCH_DECISION,
-    logger.GetTimestamp(),
-    -1,
-    "Solver",
-    0,
-    0,
-    0,
-    "Solver started"
-  );
+  Event<EventKind::kSolverStarted> solver_started;
+  solver_started.task_id = -1;
+  solver_started.task_name = "Solver";
+  logger.Log(solver_started);
+
+  // Capture every improving solution as it is found rather than only the
+  // final one, so a trace always ends with the best known schedule.
+  SharedResponseManager* response_manager = model.GetOrCreate<SharedResponseManager>();
+  IncumbentStream incumbents(stop_policy, [&stop_requested]() {
+    stop_requested = true;
+  });
+  if (probing.enabled()) incumbents.OnBound(static_cast<double>(probe.lower_bound));
+  response_manager->AddSolutionCallback(
+      [&](const CpSolverResponse& solution) {
+        std::vector<int64_t> starts;
+        for (const IntegerVariable& var : start_vars) {
+          starts.push_back(solution.solution(var.value()));
+        }
+        const Incumbent* incumbent = incumbents.OnSolution(
+            solution.objective_value(), solution.best_objective_bound(),
+            std::move(starts));
+        if (incumbent != nullptr) {
+          logger.LogIncumbent(*incumbent);
+          if (timeline != nullptr) {
+            timeline->Instant("Incumbent", "solver", incumbent->ToJsonWithoutStarts());
+          }
+        }
+      });
 
   std::cout << "Starting solver..." << std::endl;
-  SolveLoadedCpModel(model_proto, &model);
+  {
+    TimelineSpan span(timeline, "SolveLoadedCpModel", "solver");
+    SolveLoadedCpModel(model_proto, &model);
+  }
+  incumbents.Finish();
 
-  SharedResponseManager* response_manager = model.GetOrCreate<SharedResponseManager>();
   const CpSolverResponse response = response_manager->GetResponse();
+  incumbents.OnSolveFinished(response.objective_value(),
+                             response.best_objective_bound());
 
   std::cout << "Solver finished" << std::endl;
   std::cout << "Status: " << response.status() << std::endl;
+  std::cout << "Incumbents: " << incumbents.incumbents().size() << std::endl;
+  if (!incumbents.stop_reason().empty()) {
+    std::cout << "Stopped early: " << incumbents.stop_reason() << std::endl;
+  }
 
   if (response.status() == CpSolverStatus::OPTIMAL || 
       response.status() == CpSolverStatus::FEASIBLE) {
@@ -832,21 +1150,48 @@ cp_model.Minimize(makespan);
     for (size_t i = 0; i < task_ids.size(); ++i) {
       int task_id = task_ids[i];
       int64_t start = response.solution(start_vars[i].value());
-      int64_t end = start + instance.tasks[task_id].duration;
-      logger.LogEvent(
-        EventType::TASK_SCHEDULED,
-        logger.GetTimestamp(),
-        task_id,
-        task_names[i],
-        start,
-        start,
-        end,
-        "Final solution: Task scheduled at time " + std::to_string(start)
-      );
+      Event<EventKind::kFinalStart> event;
+      event.task_id = task_id;
+      event.task_name = task_names[i];
+      event.start_time = start;
+      event.end_time = start + instance.tasks[task_id].duration;
+      logger.Log(event);
     }
+
+    // The trace gets the sensitivity of the final schedule, which the Gantt
+    // view colors the bars by.
+    if (sensitivity.enabled()) {
+      TimelineSpan span(timeline, "Sensitivity", "analysis");
+      std::vector<int64_t> starts;
+      for (const IntegerVariable& var : start_vars) {
+        starts.push_back(response.solution(var.value()));
+      }
+      const SensitivityResult analysis = AnalyzeSensitivity(
+          instance, starts, response.status() == CpSolverStatus::OPTIMAL, sensitivity);
+      std::cout << "\nSensitivity: " << analysis.Summary() << std::endl;
+      std::cout << analysis.Table(instance);
+      logger.AddSummary("sensitivity", analysis.ToJson(instance));
+    }
+  }
+
+  if (attributor != nullptr) {
+    attributor->PrintSummary();
+    logger.AddSummary("attribution", attributor->ToJson());
   }
 
+  // Closed before the timeline is written, so that it has the final flush.
+  logger.Close();
   std::cout << "\nEvents logged to: " << output_file << std::endl;
 
+  if (timeline != nullptr) {
+    std::string error;
+    if (!timeline->WriteTo(timeline_options.file, &error)) {
+      std::cerr << error << std::endl;
+      return 1;
+    }
+    std::cout << "Timeline of " << timeline->size() << " spans written to "
+              << timeline_options.file << std::endl;
+  }
+
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,283 @@
+#ifndef EVENT_SCHEMA_H_
+#define EVENT_SCHEMA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// The trace event format, described once.
+//
+// RCPSP_EVENT_FIELDS lists every field an event can carry and
+// RCPSP_EVENT_KINDS every kind of event driver writes: the wire type the
+// kind is written as, the optional fields it carries and the template its
+// description is expanded from. EventWriter (event_writer.h) specializes one
+// emitter per kind from these tables at compile time, and event_schema_gen
+// turns the same tables into the TypeScript types and decoders in
+// frontend/src/eventSchema.generated.ts, so adding a field or a kind here is
+// all it takes to keep both sides in sync.
+//
+// Every event starts with "id" ("<taskId>_<type>_<timestamp>") and "type".
+// Required fields follow on every event, then the description, then the
+// optional fields the kind lists that are set.
+
+enum class FieldType {
+  kInt,        // integer; an optional one is unset while negative
+  kDouble,
+  kIdString,   // integer written as a JSON string; unset as for kInt
+  kString,     // unset while empty
+  kNode,       // search tree node number, see kNoNode
+  kNodeStatus,
+  kPropagator,
+  kIntList,
+  kInt64List,
+};
+
+enum class FieldPresence { kRequired, kOptional };
+
+// Doubles and lists are always written when a kind lists them.
+constexpr bool HasUnsetValue(FieldType type) {
+  return type != FieldType::kDouble && type != FieldType::kIntList &&
+         type != FieldType::kInt64List;
+}
+
+// X(Name, member, json key, FieldType, FieldPresence)
+#define RCPSP_EVENT_FIELDS(X)                                          \
+  X(TaskId, task_id, "taskId", kIdString, kRequired)                   \
+  X(TaskName, task_name, "taskName", kString, kRequired)               \
+  X(Timestamp, timestamp, "timestamp", kInt, kRequired)                \
+  X(StartTime, start_time, "startTime", kInt, kRequired)               \
+  X(EndTime, end_time, "endTime", kInt, kRequired)                     \
+  X(DecisionLevel, decision_level, "decisionLevel", kInt, kRequired)   \
+  X(BacktrackToLevel, backtrack_to_level, "backtrackToLevel", kInt,    \
+    kRequired)                                                         \
+  X(NodeId, node_id, "nodeId", kNode, kRequired)                       \
+  X(ParentNodeId, parent_node_id, "parentNodeId", kNode, kRequired)    \
+  X(NodeStatus, node_status, "nodeStatus", kNodeStatus, kRequired)     \
+  X(Dependencies, dependencies, "dependencies", kIntList, kRequired)   \
+  X(Successors, successors, "successors", kIntList, kRequired)         \
+  X(Demands, demands, "demands", kIntList, kOptional)                  \
+  X(Propagator, propagator, "propagator", kPropagator, kOptional)      \
+  X(ConstraintIndex, constraint_index, "constraintIndex", kInt,        \
+    kOptional)                                                         \
+  X(ResourceId, resource_id, "resourceId", kIdString, kOptional)       \
+  X(Conflicts, conflicts, "conflicts", kInt, kOptional)                \
+  X(ExplanationSize, explanation_size, "explanationSize", kInt,        \
+    kOptional)                                                         \
+  X(IncumbentIndex, incumbent_index, "incumbentIndex", kInt, kOptional) \
+  X(Objective, objective, "objective", kDouble, kOptional)             \
+  X(BestBound, best_bound, "bestBound", kDouble, kOptional)            \
+  X(WallTime, wall_time, "wallTime", kDouble, kOptional)               \
+  X(Solution, solution, "solution", kInt64List, kOptional)
+
+// X(Name, wire type, optional fields, description). `{key}` in a description
+// is replaced by the value of that field; lists are joined with ", ".
+#define RCPSP_EVENT_KINDS(X)                                                 \
+  X(TaskDefined, "start", FieldMask(EventField::kDemands),                   \
+    "Task defined with duration {endTime} Resources: [{demands}]")           \
+  X(SolverStarted, "start", FieldMask(), "Solver started")                   \
+  X(StartAssigned, "assign", FieldMask(), "Start variable fixed to {startTime}") \
+  X(TaskScheduled, "start", FieldMask(), "Task scheduled at time {startTime}") \
+  X(BoundsChanged, "modify",                                                 \
+    FieldMask(EventField::kPropagator, EventField::kConstraintIndex,         \
+              EventField::kResourceId),                                      \
+    "Start variable bounds updated: [{startTime}, {endTime}]")               \
+  X(Backtrack, "remove", FieldMask(),                                        \
+    "Backtracked from {startTime} to {endTime}")                             \
+  X(Conflict, "conflict",                                                    \
+    FieldMask(EventField::kConflicts, EventField::kExplanationSize),         \
+    "{conflicts} conflict(s), explanation of {explanationSize} literals")    \
+  X(Incumbent, "incumbent",                                                  \
+    FieldMask(EventField::kIncumbentIndex, EventField::kObjective,           \
+              EventField::kBestBound, EventField::kWallTime,                 \
+              EventField::kSolution),                                        \
+    "Incumbent {incumbentIndex}: makespan {endTime}")                        \
+  X(LowerBound, "bound",                                                     \
+    FieldMask(EventField::kBestBound, EventField::kWallTime),                \
+    "Makespan proven to be at least {startTime}")                            \
+  X(FinalStart, "start", FieldMask(),                                        \
+    "Final solution: Task scheduled at time {startTime}")
+
+// Value sets of the enumerated field types, X(Name, wire value). The first
+// value is the unset one; it is only written by required fields.
+#define RCPSP_NODE_STATUSES(X) \
+  X(kNone, "")                 \
+  X(kCreated, "created")       \
+  X(kPruned, "pruned")
+
+#define RCPSP_PROPAGATORS(X)     \
+  X(kNone, "")                   \
+  X(kPrecedence, "precedence")   \
+  X(kCumulative, "cumulative")   \
+  X(kObjective, "objective")     \
+  X(kSearch, "search")
+
+#define RCPSP_SCHEMA_ENUMERATOR(name, value) name,
+#define RCPSP_SCHEMA_VALUE(name, value) value,
+
+enum class NodeStatus { RCPSP_NODE_STATUSES(RCPSP_SCHEMA_ENUMERATOR) };
+inline constexpr std::string_view kNodeStatusNames[] = {
+    RCPSP_NODE_STATUSES(RCPSP_SCHEMA_VALUE)};
+
+enum class Propagator { RCPSP_PROPAGATORS(RCPSP_SCHEMA_ENUMERATOR) };
+inline constexpr std::string_view kPropagatorNames[] = {
+    RCPSP_PROPAGATORS(RCPSP_SCHEMA_VALUE)};
+
+#undef RCPSP_SCHEMA_ENUMERATOR
+#undef RCPSP_SCHEMA_VALUE
+
+// Search tree nodes are numbered; these two are written as "" and "root",
+// node n >= 0 as "node_<n>".
+constexpr int kNoNode = -2;
+constexpr int kRootNode = -1;
+
+// Non-owning view of a list field; the list must outlive the write.
+template <typename T>
+struct ListView {
+  const T* data = nullptr;
+  size_t size = 0;
+
+  constexpr ListView() = default;
+  ListView(const std::vector<T>& values)  // NOLINT: implicit by design
+      : data(values.data()), size(values.size()) {}
+};
+
+template <FieldType T> struct FieldTraits;
+template <> struct FieldTraits<FieldType::kInt> { using Value = int64_t; };
+template <> struct FieldTraits<FieldType::kDouble> { using Value = double; };
+template <> struct FieldTraits<FieldType::kIdString> { using Value = int64_t; };
+template <> struct FieldTraits<FieldType::kString> { using Value = std::string_view; };
+template <> struct FieldTraits<FieldType::kNode> { using Value = int; };
+template <> struct FieldTraits<FieldType::kNodeStatus> { using Value = NodeStatus; };
+template <> struct FieldTraits<FieldType::kPropagator> { using Value = Propagator; };
+template <> struct FieldTraits<FieldType::kIntList> { using Value = ListView<int>; };
+template <> struct FieldTraits<FieldType::kInt64List> { using Value = ListView<int64_t>; };
+
+template <FieldType T, FieldPresence P>
+constexpr typename FieldTraits<T>::Value FieldDefault() {
+  if constexpr (T == FieldType::kInt || T == FieldType::kIdString) {
+    return P == FieldPresence::kOptional ? -1 : 0;
+  } else if constexpr (T == FieldType::kNode) {
+    return kNoNode;
+  } else {
+    return {};
+  }
+}
+
+enum class EventField {
+#define RCPSP_FIELD_ENUMERATOR(Name, member, key, type, presence) k##Name,
+  RCPSP_EVENT_FIELDS(RCPSP_FIELD_ENUMERATOR)
+#undef RCPSP_FIELD_ENUMERATOR
+};
+
+struct FieldInfo {
+  std::string_view key;
+  FieldType type;
+  FieldPresence presence;
+};
+
+inline constexpr FieldInfo kEventFields[] = {
+#define RCPSP_FIELD_INFO(Name, member, key, type, presence) \
+  {key, FieldType::type, FieldPresence::presence},
+    RCPSP_EVENT_FIELDS(RCPSP_FIELD_INFO)
+#undef RCPSP_FIELD_INFO
+};
+inline constexpr int kNumEventFields =
+    static_cast<int>(sizeof(kEventFields) / sizeof(kEventFields[0]));
+
+template <typename... Fields>
+constexpr uint64_t FieldMask(Fields... fields) {
+  return (uint64_t{0} | ... | (uint64_t{1} << static_cast<int>(fields)));
+}
+
+// The fields of an event. Every kind uses the same layout, but only writes
+// the required fields and the optional ones it lists.
+struct EventFields {
+#define RCPSP_FIELD_MEMBER(Name, member, key, type, presence) \
+  FieldTraits<FieldType::type>::Value member =                \
+      FieldDefault<FieldType::type, FieldPresence::presence>();
+  RCPSP_EVENT_FIELDS(RCPSP_FIELD_MEMBER)
+#undef RCPSP_FIELD_MEMBER
+};
+
+enum class EventKind {
+#define RCPSP_KIND_ENUMERATOR(Name, wire_type, fields, description) k##Name,
+  RCPSP_EVENT_KINDS(RCPSP_KIND_ENUMERATOR)
+#undef RCPSP_KIND_ENUMERATOR
+};
+
+struct EventKindInfo {
+  std::string_view name;
+  std::string_view wire_type;
+  uint64_t optional_fields;
+  std::string_view description;
+};
+
+inline constexpr EventKindInfo kEventKinds[] = {
+#define RCPSP_KIND_INFO(Name, wire_type, fields, description) \
+  {#Name, wire_type, fields, description},
+    RCPSP_EVENT_KINDS(RCPSP_KIND_INFO)
+#undef RCPSP_KIND_INFO
+};
+
+constexpr const EventKindInfo& KindInfo(EventKind kind) {
+  return kEventKinds[static_cast<int>(kind)];
+}
+
+// One record type per kind, so the kind is part of the type and picks the
+// emitter at compile time.
+template <EventKind K>
+struct Event : EventFields {
+  static constexpr EventKind kKind = K;
+
+  Event() = default;
+  // Copies the fields of an event of another kind.
+  explicit Event(const EventFields& fields) : EventFields(fields) {}
+};
+
+// Returns the index of the field with the given JSON key, or -1.
+constexpr int FindField(std::string_view key) {
+  for (int i = 0; i < kNumEventFields; ++i) {
+    if (kEventFields[i].key == key) return i;
+  }
+  return -1;
+}
+
+// A description template split into literal text and field references.
+struct DescriptionTemplate {
+  static constexpr int kMaxSegments = 8;
+  struct Segment {
+    std::string_view literal;
+    int field = -1;  // written after the literal, -1 for none
+  };
+  Segment segments[kMaxSegments] = {};
+  int size = 0;
+  bool valid = true;
+};
+
+constexpr DescriptionTemplate ParseDescription(std::string_view text) {
+  DescriptionTemplate parsed;
+  size_t pos = 0;
+  while (pos <= text.size() && parsed.valid) {
+    if (parsed.size == DescriptionTemplate::kMaxSegments) {
+      parsed.valid = false;
+      break;
+    }
+    DescriptionTemplate::Segment& segment = parsed.segments[parsed.size++];
+    const size_t open = text.find('{', pos);
+    if (open == std::string_view::npos) {
+      segment.literal = text.substr(pos);
+      break;
+    }
+    const size_t close = text.find('}', open);
+    segment.literal = text.substr(pos, open - pos);
+    segment.field = close == std::string_view::npos
+                        ? -1
+                        : FindField(text.substr(open + 1, close - open - 1));
+    parsed.valid = segment.field >= 0;
+    pos = close + 1;
+  }
+  return parsed;
+}
+
+#endif  // EVENT_SCHEMA_H_
@@ -0,0 +1,368 @@
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "event_schema.h"
+
+// Generates the TypeScript side of the trace event schema.
+//
+//   event_schema_gen --output=frontend/src/eventSchema.generated.ts
+//   event_schema_gen --check=frontend/src/eventSchema.generated.ts
+//
+// One interface per wire type, the TaskEvent union of them and decoders that
+// validate a parsed trace against event_schema.h. --check exits with 1 if the
+// given file is not what would be generated, so a stale copy can fail a build.
+
+namespace {
+
+constexpr char kHeader[] =
+    "// Generated by event_schema_gen from event_schema.h; do not edit.\n"
+    "// After changing the schema, regenerate with\n"
+    "//   event_schema_gen --output=frontend/src/eventSchema.generated.ts\n";
+
+// TypeScript side of an enumerated field type.
+struct EnumType {
+  FieldType type;
+  const char* name;
+  const char* values_constant;
+  const std::string_view* values;
+  size_t num_values;
+};
+
+const EnumType kEnumTypes[] = {
+    {FieldType::kNodeStatus, "NodeStatus", "NODE_STATUSES", kNodeStatusNames,
+     sizeof(kNodeStatusNames) / sizeof(kNodeStatusNames[0])},
+    {FieldType::kPropagator, "Propagator", "PROPAGATORS", kPropagatorNames,
+     sizeof(kPropagatorNames) / sizeof(kPropagatorNames[0])},
+};
+
+const EnumType* FindEnum(FieldType type) {
+  for (const EnumType& enum_type : kEnumTypes) {
+    if (enum_type.type == type) return &enum_type;
+  }
+  return nullptr;
+}
+
+std::string Quote(std::string_view text) {
+  return "\"" + std::string(text) + "\"";
+}
+
+std::string TypeName(FieldType type) {
+  switch (type) {
+    case FieldType::kInt:
+    case FieldType::kDouble:
+      return "number";
+    case FieldType::kIdString:
+    case FieldType::kString:
+    case FieldType::kNode:
+      return "string";
+    case FieldType::kIntList:
+    case FieldType::kInt64List:
+      return "number[]";
+    default:
+      return FindEnum(type)->name;
+  }
+}
+
+// Name of the decoder helper for a field type.
+std::string ReaderName(FieldType type) {
+  switch (type) {
+    case FieldType::kInt:
+      return "readInt";
+    case FieldType::kDouble:
+      return "readDouble";
+    case FieldType::kIdString:
+      return "readId";
+    case FieldType::kString:
+    case FieldType::kNode:
+      return "readString";
+    case FieldType::kIntList:
+    case FieldType::kInt64List:
+      return "readIntList";
+    default:
+      return "readEnum";
+  }
+}
+
+std::string ReadExpression(const FieldInfo& field) {
+  std::string expression = ReaderName(field.type) + "(o, " + Quote(field.key);
+  if (const EnumType* enum_type = FindEnum(field.type)) {
+    expression += std::string(", ") + enum_type->values_constant;
+  }
+  return expression + ")";
+}
+
+bool IsRequired(const FieldInfo& field) {
+  return field.presence == FieldPresence::kRequired;
+}
+
+// Wire types in order of first use, with the optional fields of all their
+// kinds and the ones every kind writes unconditionally.
+struct WireType {
+  std::string_view name;
+  uint64_t optional_fields = 0;
+  uint64_t always_written = ~uint64_t{0};
+};
+
+std::vector<WireType> CollectWireTypes() {
+  std::vector<WireType> wire_types;
+  for (const EventKindInfo& kind : kEventKinds) {
+    WireType* wire_type = nullptr;
+    for (WireType& existing : wire_types) {
+      if (existing.name == kind.wire_type) wire_type = &existing;
+    }
+    if (wire_type == nullptr) {
+      wire_types.push_back({kind.wire_type});
+      wire_type = &wire_types.back();
+    }
+    uint64_t written = 0;
+    for (int f = 0; f < kNumEventFields; ++f) {
+      if ((kind.optional_fields >> f & 1) && !HasUnsetValue(kEventFields[f].type)) {
+        written |= uint64_t{1} << f;
+      }
+    }
+    wire_type->optional_fields |= kind.optional_fields;
+    wire_type->always_written &= written;
+  }
+  return wire_types;
+}
+
+std::string InterfaceName(std::string_view wire_type) {
+  std::string name(wire_type);
+  name[0] = static_cast<char>(std::toupper(name[0]));
+  return name + "Event";
+}
+
+std::string Generate() {
+  const std::vector<WireType> wire_types = CollectWireTypes();
+  std::vector<bool> used(static_cast<int>(FieldType::kInt64List) + 1, false);
+  std::vector<bool> required_type(used.size(), false);
+  for (const FieldInfo& field : kEventFields) {
+    used[static_cast<int>(field.type)] = true;
+    if (IsRequired(field)) required_type[static_cast<int>(field.type)] = true;
+  }
+  auto uses = [&](FieldType type) { return used[static_cast<int>(type)]; };
+
+  std::ostringstream ts;
+  ts << kHeader << "\n";
+
+  ts << "export type EventType =";
+  for (const WireType& wire_type : wire_types) ts << "\n  | " << Quote(wire_type.name);
+  ts << ";\n";
+  for (const EnumType& enum_type : kEnumTypes) {
+    if (!uses(enum_type.type)) continue;
+    // The unset value is only ever written by required fields.
+    const size_t first = required_type[static_cast<int>(enum_type.type)] ? 0 : 1;
+    ts << "\nexport type " << enum_type.name << " =";
+    for (size_t v = first; v < enum_type.num_values; ++v) {
+      ts << "\n  | " << Quote(enum_type.values[v]);
+    }
+    ts << ";\n";
+    ts << "const " << enum_type.values_constant << ": readonly " << enum_type.name
+       << "[] = [";
+    for (size_t v = first; v < enum_type.num_values; ++v) {
+      ts << (v > first ? ", " : "") << Quote(enum_type.values[v]);
+    }
+    ts << "];\n";
+  }
+
+  ts << "\n// Fields of every event.\n";
+  ts << "export interface EventFields {\n";
+  ts << "  id: string;\n";
+  for (const FieldInfo& field : kEventFields) {
+    if (IsRequired(field)) ts << "  " << field.key << ": " << TypeName(field.type) << ";\n";
+  }
+  ts << "  description: string;\n";
+  ts << "}\n";
+
+  for (const WireType& wire_type : wire_types) {
+    ts << "\nexport interface " << InterfaceName(wire_type.name)
+       << " extends EventFields {\n";
+    ts << "  type: " << Quote(wire_type.name) << ";\n";
+    for (int f = 0; f < kNumEventFields; ++f) {
+      if (!(wire_type.optional_fields >> f & 1)) continue;
+      const bool always = wire_type.always_written >> f & 1;
+      ts << "  " << kEventFields[f].key << (always ? ": " : "?: ")
+         << TypeName(kEventFields[f].type) << ";\n";
+    }
+    ts << "}\n";
+  }
+  ts << "\nexport type TaskEvent =";
+  for (const WireType& wire_type : wire_types) {
+    ts << "\n  | " << InterfaceName(wire_type.name);
+  }
+  ts << ";\n";
+
+  ts << "\nexport class EventDecodeError extends Error {}\n";
+  ts << "\ntype JsonObject = Record<string, unknown>;\n";
+  ts << "\nfunction invalid(key: string, expected: string): EventDecodeError {\n"
+        "  return new EventDecodeError(`\"${key}\" is not ${expected}`);\n"
+        "}\n";
+  if (uses(FieldType::kInt)) {
+    ts << "\nfunction readInt(o: JsonObject, key: string): number {\n"
+          "  const value = o[key];\n"
+          "  if (typeof value !== \"number\" || !Number.isInteger(value)) {\n"
+          "    throw invalid(key, \"an integer\");\n"
+          "  }\n"
+          "  return value;\n"
+          "}\n";
+  }
+  if (uses(FieldType::kDouble)) {
+    ts << "\n// The writer turns NaN and infinities into null.\n"
+          "function readDouble(o: JsonObject, key: string): number {\n"
+          "  const value = o[key];\n"
+          "  if (value === null) return NaN;\n"
+          "  if (typeof value !== \"number\") throw invalid(key, \"a number\");\n"
+          "  return value;\n"
+          "}\n";
+  }
+  if (uses(FieldType::kIdString)) {
+    ts << "\nfunction readId(o: JsonObject, key: string): string {\n"
+          "  const value = o[key];\n"
+          "  if (typeof value === \"string\") return value;\n"
+          "  if (typeof value === \"number\" && Number.isInteger(value)) {\n"
+          "    return String(value);\n"
+          "  }\n"
+          "  throw invalid(key, \"an id\");\n"
+          "}\n";
+  }
+  // Always needed for "id" and "description".
+  ts << "\nfunction readString(o: JsonObject, key: string): string {\n"
+        "  const value = o[key];\n"
+        "  if (typeof value !== \"string\") throw invalid(key, \"a string\");\n"
+        "  return value;\n"
+        "}\n";
+  if (uses(FieldType::kIntList) || uses(FieldType::kInt64List)) {
+    ts << "\nfunction readIntList(o: JsonObject, key: string): number[] {\n"
+          "  const value = o[key];\n"
+          "  if (\n"
+          "    !Array.isArray(value) ||\n"
+          "    !value.every((item) => typeof item === \"number\" && Number.isInteger(item))\n"
+          "  ) {\n"
+          "    throw invalid(key, \"a list of integers\");\n"
+          "  }\n"
+          "  return value as number[];\n"
+          "}\n";
+  }
+  if (uses(FieldType::kNodeStatus) || uses(FieldType::kPropagator)) {
+    ts << "\nfunction readEnum<T extends string>(\n"
+          "  o: JsonObject,\n"
+          "  key: string,\n"
+          "  values: readonly T[],\n"
+          "): T {\n"
+          "  const value = o[key];\n"
+          "  if (typeof value !== \"string\" || !(values as readonly string[]).includes(value)) {\n"
+          "    throw invalid(key, `one of ${JSON.stringify(values)}`);\n"
+          "  }\n"
+          "  return value as T;\n"
+          "}\n";
+  }
+
+  ts << "\nfunction decodeFields(o: JsonObject): EventFields {\n";
+  ts << "  return {\n";
+  ts << "    id: readString(o, \"id\"),\n";
+  for (const FieldInfo& field : kEventFields) {
+    if (IsRequired(field)) {
+      ts << "    " << field.key << ": " << ReadExpression(field) << ",\n";
+    }
+  }
+  ts << "    description: readString(o, \"description\"),\n";
+  ts << "  };\n";
+  ts << "}\n";
+
+  ts << "\nexport function decodeTaskEvent(raw: unknown): TaskEvent {\n"
+        "  if (typeof raw !== \"object\" || raw === null || Array.isArray(raw)) {\n"
+        "    throw new EventDecodeError(\"event is not an object\");\n"
+        "  }\n"
+        "  const o = raw as JsonObject;\n"
+        "  const fields = decodeFields(o);\n"
+        "  switch (o.type) {\n";
+  for (const WireType& wire_type : wire_types) {
+    ts << "    case " << Quote(wire_type.name) << ":\n";
+    if (wire_type.optional_fields == 0) {
+      ts << "      return { ...fields, type: " << Quote(wire_type.name) << " };\n";
+      continue;
+    }
+    ts << "      return {\n";
+    ts << "        ...fields,\n";
+    ts << "        type: " << Quote(wire_type.name) << ",\n";
+    for (int f = 0; f < kNumEventFields; ++f) {
+      if (!(wire_type.optional_fields >> f & 1)) continue;
+      const FieldInfo& field = kEventFields[f];
+      ts << "        " << field.key << ": ";
+      if (!(wire_type.always_written >> f & 1)) {
+        ts << "o." << field.key << " === undefined ? undefined : ";
+      }
+      ts << ReadExpression(field) << ",\n";
+    }
+    ts << "      };\n";
+  }
+  ts << "    default:\n"
+        "      throw new EventDecodeError(`unknown event type ${JSON.stringify(o.type)}`);\n"
+        "  }\n"
+        "}\n";
+
+  ts << "\n// Decodes the events array of a trace, naming the first bad event.\n"
+        "export function decodeTaskEvents(raw: unknown): TaskEvent[] {\n"
+        "  if (!Array.isArray(raw)) {\n"
+        "    throw new EventDecodeError(\"events is not an array\");\n"
+        "  }\n"
+        "  return raw.map((event, index) => {\n"
+        "    try {\n"
+        "      return decodeTaskEvent(event);\n"
+        "    } catch (error) {\n"
+        "      const message = error instanceof Error ? error.message : String(error);\n"
+        "      throw new EventDecodeError(`event ${index}: ${message}`);\n"
+        "    }\n"
+        "  });\n"
+        "}\n";
+  return ts.str();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string output;
+  std::string check;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg.rfind("--output=", 0) == 0) {
+      output = arg.substr(9);
+    } else if (arg.rfind("--check=", 0) == 0) {
+      check = arg.substr(8);
+    } else {
+      std::cerr << "Usage: event_schema_gen [--output=file.ts | --check=file.ts]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  const std::string generated = Generate();
+  if (!check.empty()) {
+    std::ifstream in(check);
+    std::stringstream existing;
+    existing << in.rdbuf();
+    if (!in.is_open() || existing.str() != generated) {
+      std::cerr << check << " is out of date; regenerate it with --output="
+                << check << std::endl;
+      return 1;
+    }
+    return 0;
+  }
+  if (output.empty()) {
+    std::cout << generated;
+    return 0;
+  }
+  std::ofstream out(output);
+  if (!out.is_open()) {
+    std::cerr << "Cannot write " << output << std::endl;
+    return 1;
+  }
+  out << generated;
+  return 0;
+}
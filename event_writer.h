@@ -0,0 +1,248 @@
+#ifndef EVENT_WRITER_H_
+#define EVENT_WRITER_H_
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "event_schema.h"
+
+// Writes trace events as JSON into a reusable buffer that is handed to the
+// file when it fills up or on Flush(). Write<K>() is instantiated per event
+// kind, so each kind only carries code for the fields event_schema.h gives
+// it, and fields are formatted straight into the buffer: writing an event
+// does not allocate.
+class EventWriter {
+ public:
+  static constexpr size_t kBufferSize = 1 << 16;
+
+  explicit EventWriter(const std::string& filename)
+      : file_(std::fopen(filename.c_str(), "wb")), buffer_(kBufferSize) {}
+
+  ~EventWriter() { Close(); }
+
+  EventWriter(const EventWriter&) = delete;
+  EventWriter& operator=(const EventWriter&) = delete;
+
+  bool is_open() const { return file_ != nullptr; }
+
+  // Called after each flush with the number of bytes and the time the flush
+  // began, e.g. to put the cost of writing the trace on a timeline.
+  using FlushObserver =
+      std::function<void(size_t bytes, std::chrono::steady_clock::time_point begin)>;
+  void set_flush_observer(FlushObserver observer) { flush_observer_ = std::move(observer); }
+
+  // Appends JSON text as is, e.g. the enclosing object of the events.
+  void WriteRaw(std::string_view text) { Append(text.data(), text.size()); }
+
+  // Appends one event of the events array, separated from the previous one.
+  template <EventKind K>
+  void Write(const Event<K>& event) {
+    static constexpr EventKindInfo kKind = KindInfo(K);
+    static constexpr DescriptionTemplate kDescription =
+        ParseDescription(kKind.description);
+    static_assert(kDescription.valid,
+                  "event description refers to an unknown field");
+    if (file_ == nullptr) return;
+
+    Append(first_event_ ? "    {\"id\":\"" : ",\n    {\"id\":\"");
+    first_event_ = false;
+    WriteInt(event.task_id);
+    Put('_');
+    Append(kKind.wire_type);
+    Put('_');
+    WriteInt(event.timestamp);
+    Append("\",\"type\":\"");
+    Append(kKind.wire_type);
+    Put('"');
+
+#define RCPSP_WRITE_REQUIRED(Name, member, key, type, presence)       \
+  if constexpr (FieldPresence::presence == FieldPresence::kRequired) { \
+    WriteKey(key);                                                     \
+    WriteValue<FieldType::type, true>(event.member);                   \
+  }
+    RCPSP_EVENT_FIELDS(RCPSP_WRITE_REQUIRED)
+#undef RCPSP_WRITE_REQUIRED
+
+    WriteKey("description");
+    Put('"');
+    for (int s = 0; s < kDescription.size; ++s) {
+      WriteEscaped(kDescription.segments[s].literal);
+      if (kDescription.segments[s].field >= 0) {
+        WriteFieldText(kDescription.segments[s].field, event);
+      }
+    }
+    Put('"');
+
+#define RCPSP_WRITE_OPTIONAL(Name, member, key, type, presence)        \
+  if constexpr (FieldPresence::presence == FieldPresence::kOptional && \
+                (kKind.optional_fields & FieldMask(EventField::k##Name)) != 0) { \
+    if (IsSet<FieldType::type>(event.member)) {                         \
+      WriteKey(key);                                                    \
+      WriteValue<FieldType::type, true>(event.member);                  \
+    }                                                                   \
+  }
+    RCPSP_EVENT_FIELDS(RCPSP_WRITE_OPTIONAL)
+#undef RCPSP_WRITE_OPTIONAL
+
+    Put('}');
+  }
+
+  // Hands the buffered text to the file.
+  void Flush() {
+    if (file_ != nullptr) {
+      std::chrono::steady_clock::time_point begin;
+      if (flush_observer_) begin = std::chrono::steady_clock::now();
+      std::fwrite(buffer_.data(), 1, size_, file_);
+      std::fflush(file_);
+      if (flush_observer_) flush_observer_(size_, begin);
+    }
+    size_ = 0;
+  }
+
+  void Close() {
+    if (file_ == nullptr) return;
+    Flush();
+    std::fclose(file_);
+    file_ = nullptr;
+  }
+
+ private:
+  template <FieldType T>
+  static bool IsSet(const typename FieldTraits<T>::Value& value) {
+    if constexpr (T == FieldType::kInt || T == FieldType::kIdString) {
+      return value >= 0;
+    } else if constexpr (T == FieldType::kString) {
+      return !value.empty();
+    } else if constexpr (T == FieldType::kNode) {
+      return value != kNoNode;
+    } else if constexpr (T == FieldType::kNodeStatus) {
+      return value != NodeStatus::kNone;
+    } else if constexpr (T == FieldType::kPropagator) {
+      return value != Propagator::kNone;
+    } else {
+      static_assert(!HasUnsetValue(T));
+      return true;
+    }
+  }
+
+  // Writes a field value as JSON, or as description text when !kJson.
+  template <FieldType T, bool kJson>
+  void WriteValue(const typename FieldTraits<T>::Value& value) {
+    if constexpr (T == FieldType::kInt) {
+      WriteInt(value);
+    } else if constexpr (T == FieldType::kDouble) {
+      WriteDouble(value);
+    } else if constexpr (T == FieldType::kIdString) {
+      if (kJson) Put('"');
+      WriteInt(value);
+      if (kJson) Put('"');
+    } else if constexpr (T == FieldType::kIntList || T == FieldType::kInt64List) {
+      if (kJson) Put('[');
+      for (size_t i = 0; i < value.size; ++i) {
+        if (i > 0) Append(kJson ? "," : ", ");
+        WriteInt(value.data[i]);
+      }
+      if (kJson) Put(']');
+    } else {
+      if (kJson) Put('"');
+      if constexpr (T == FieldType::kString) {
+        WriteEscaped(value);
+      } else if constexpr (T == FieldType::kNode) {
+        if (value == kRootNode) {
+          Append("root");
+        } else if (value >= 0) {
+          Append("node_");
+          WriteInt(value);
+        }
+      } else if constexpr (T == FieldType::kNodeStatus) {
+        Append(kNodeStatusNames[static_cast<int>(value)]);
+      } else {
+        Append(kPropagatorNames[static_cast<int>(value)]);
+      }
+      if (kJson) Put('"');
+    }
+  }
+
+  void WriteFieldText(int field, const EventFields& event) {
+    switch (static_cast<EventField>(field)) {
+#define RCPSP_WRITE_TEXT(Name, member, key, type, presence) \
+  case EventField::k##Name:                                 \
+    WriteValue<FieldType::type, false>(event.member);       \
+    break;
+      RCPSP_EVENT_FIELDS(RCPSP_WRITE_TEXT)
+#undef RCPSP_WRITE_TEXT
+    }
+  }
+
+  void WriteKey(std::string_view key) {
+    Append(",\"");
+    Append(key);
+    Append("\":");
+  }
+
+  void WriteInt(int64_t value) {
+    char digits[24];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    Append(digits, result.ptr - digits);
+  }
+
+  // JSON has no NaN or infinity.
+  void WriteDouble(double value) {
+    if (!std::isfinite(value)) {
+      Append("null");
+      return;
+    }
+    char digits[32];
+    const int length = std::snprintf(digits, sizeof(digits), "%.15g", value);
+    Append(digits, length);
+  }
+
+  void WriteEscaped(std::string_view text) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    for (const char c : text) {
+      if (c == '"' || c == '\\') {
+        Put('\\');
+        Put(c);
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        const char escape[] = {'\\', 'u', '0', '0', kHex[(c >> 4) & 0xf], kHex[c & 0xf]};
+        Append(escape, sizeof(escape));
+      } else {
+        Put(c);
+      }
+    }
+  }
+
+  void Put(char c) {
+    if (size_ == buffer_.size()) Flush();
+    buffer_[size_++] = c;
+  }
+
+  void Append(std::string_view text) { Append(text.data(), text.size()); }
+
+  void Append(const char* data, size_t length) {
+    while (length > 0) {
+      if (size_ == buffer_.size()) Flush();
+      const size_t chunk = std::min(length, buffer_.size() - size_);
+      std::copy(data, data + chunk, buffer_.data() + size_);
+      size_ += chunk;
+      data += chunk;
+      length -= chunk;
+    }
+  }
+
+  std::FILE* file_;
+  std::vector<char> buffer_;
+  size_t size_ = 0;
+  bool first_event_ = true;
+  FlushObserver flush_observer_;
+};
+
+#endif  // EVENT_WRITER_H_
@@ -1,5 +1,11 @@
 import React, { useState, useEffect, useRef } from "react";
-import type { EventFile, InstanceMetadata, InstancesConfig } from "./types";
+import type {
+  InstanceMetadata,
+  InstancesConfig,
+  RiskSummary,
+  SensitivitySummary,
+} from "./types";
+import { decodeTaskEvents } from "./eventSchema.generated";
 import { useTimelineStore } from "./store";
 import { TimeSlider } from "./TimeSlider";
 import { SearchTree } from "./SearchTree";
@@ -12,7 +18,7 @@ import "./App.css";
 export const FileLoader: React.FC<{ instanceFile: string }> = ({
   instanceFile,
 }) => {
-  const { loadEvents } = useTimelineStore();
+  const { loadEvents, setSensitivity, setRisk } = useTimelineStore();
   const [error, setError] = useState<string | null>(null);
   const [loading, setLoading] = useState(true);
   const hasLoaded = useRef(false);
@@ -23,19 +29,24 @@ export const FileLoader: React.FC<{ instanceFile: string }> = ({
 
     fetch(instanceFile)
       .then((res) => res.json())
-      .then((data: EventFile) => {
-        if (!data.events || !Array.isArray(data.events)) {
-          throw new Error("Invalid event file format");
-        }
-        loadEvents(data.events);
-        setError(null);
-        setLoading(false);
-      })
+      .then(
+        (data: {
+          events?: unknown;
+          risk?: RiskSummary;
+          sensitivity?: SensitivitySummary;
+        }) => {
+          loadEvents(decodeTaskEvents(data.events));
+          setSensitivity(data.sensitivity ?? null);
+          setRisk(data.risk ?? null);
+          setError(null);
+          setLoading(false);
+        },
+      )
       .catch((err) => {
         setError(err instanceof Error ? err.message : "Failed to load events");
         setLoading(false);
       });
-  }, [instanceFile, loadEvents]);
+  }, [instanceFile, loadEvents, setSensitivity, setRisk]);
 
   if (loading) {
     return (
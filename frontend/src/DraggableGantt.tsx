@@ -1,134 +1,64 @@
-import React, { useRef, useState } from "react";
+import React, { useCallback, useMemo } from "react";
 import { useTimelineStore } from "./store";
-import { DependencyArrows } from "./DependencyArrows";
+import { GanttCanvas } from "./GanttCanvas";
 
 export const DraggableGantt: React.FC = () => {
   const {
     getProblemDefinition,
+    getGanttRows,
     userSchedule,
     setUserSchedule,
     constraintViolations,
   } = useTimelineStore();
   const problem = getProblemDefinition();
-  const [draggedTask, setDraggedTask] = useState<string | null>(null);
-  const [dragOffset, setDragOffset] = useState(0);
-  const containerRef = useRef<HTMLDivElement>(null);
-
-  const hasResourceViolation = (taskId: string) => {
-    return constraintViolations.some(
-      (v) =>
-        v.type === "resource" &&
-        (v.taskId === taskId || v.relatedTasks?.includes(taskId)),
-    );
-  };
-
-  const handleDragStart = (e: React.DragEvent, taskId: string) => {
-    const timing = userSchedule.get(taskId);
-    if (!timing) return;
-
-    setDraggedTask(taskId);
-    const rect = (e.target as HTMLElement).getBoundingClientRect();
-    setDragOffset(e.clientX - rect.left);
-    e.dataTransfer.effectAllowed = "move";
-    e.dataTransfer.setData("text/plain", taskId);
-  };
-
-  const handleDragOver = (e: React.DragEvent) => {
-    e.preventDefault();
-    e.dataTransfer.dropEffect = "move";
-  };
-
-  const handleDrop = (e: React.DragEvent) => {
-    e.preventDefault();
-    if (!draggedTask) return;
-
-    const target = e.target as HTMLElement;
-    const timelineRow = target.closest(".timeline-row") as HTMLElement;
-    if (!timelineRow) return;
-
-    const timelineRect = timelineRow.getBoundingClientRect();
-    const unitWidth = 40;
-
-    const x = e.clientX - timelineRect.left - dragOffset;
-    const newStart = Math.max(0, Math.round(x / unitWidth));
-
-    const task = problem.tasks.find((t) => t.id === draggedTask);
-    if (!task) return;
-
-    const newEnd = newStart + task.duration;
-
-    setUserSchedule(draggedTask, newStart, newEnd);
-    setDraggedTask(null);
-  };
-
-  const unitWidth = 40;
-  const rowHeight = 40;
-  const taskNameWidth = 150;
+  // Rows follow problem.tasks, so a row is also the task's index there.
+  const rows = getGanttRows();
+
+  // Tasks the user has not placed yet sit at time 0.
+  const bars = useMemo(() => {
+    const starts = new Float64Array(problem.tasks.length);
+    const ends = new Float64Array(problem.tasks.length);
+    problem.tasks.forEach((task, row) => {
+      const timing = userSchedule.get(task.id);
+      starts[row] = timing?.start ?? 0;
+      ends[row] = timing?.end ?? task.duration;
+    });
+    return { starts, ends };
+  }, [problem, userSchedule]);
+
+  const flagged = useMemo(() => {
+    const rowsWithViolations = new Uint8Array(rows.ids.length);
+    const flag = (taskId: string) => {
+      const row = rows.rowOf.get(taskId);
+      if (row !== undefined) rowsWithViolations[row] = 1;
+    };
+    constraintViolations.forEach((v) => {
+      if (v.type !== "resource") return;
+      flag(v.taskId);
+      v.relatedTasks?.forEach(flag);
+    });
+    return rowsWithViolations;
+  }, [rows, constraintViolations]);
+
+  const handleTaskMove = useCallback(
+    (taskId: string, start: number) => {
+      const row = rows.rowOf.get(taskId);
+      if (row === undefined) return;
+      setUserSchedule(taskId, start, start + problem.tasks[row].duration);
+    },
+    [rows, problem, setUserSchedule],
+  );
 
   return (
     <div className="draggable-gantt">
-      <div className="gantt-header">
-        <div className="task-header">Task</div>
-        <div className="timeline-header">
-          {Array.from({ length: problem.timeHorizon + 1 }, (_, i) => (
-            <div key={i} className="time-unit" style={{ width: unitWidth }}>
-              {i}
-            </div>
-          ))}
-        </div>
-      </div>
-      <div
-        className="gantt-body"
-        ref={containerRef}
-        onDragOver={handleDragOver}
-        onDrop={handleDrop}
-        style={{ position: "relative" }}
-      >
-        <DependencyArrows
-          tasks={problem.tasks}
-          userSchedule={userSchedule}
-          unitWidth={unitWidth}
-          rowHeight={rowHeight}
-          taskNameWidth={taskNameWidth}
-        />
-        {problem.tasks.map((task) => {
-          const timing = userSchedule.get(task.id);
-          const start = timing?.start ?? 0;
-          const end = timing?.end ?? task.duration;
-          const duration = end - start;
-          const isResourceConstrained = hasResourceViolation(task.id);
-
-          console.log(
-            `Task ${task.name}: start=${start}, end=${end}, duration=${duration}, barWidth=${duration * unitWidth}px`,
-          );
-
-          return (
-            <div
-              key={task.id}
-              className="gantt-row"
-              style={{ height: rowHeight }}
-            >
-              <div className="task-name">{task.name}</div>
-              <div className="timeline-row">
-                <div
-                  className={`task-bar ${isResourceConstrained ? "resource-violation" : ""}`}
-                  draggable
-                  onDragStart={(e) => handleDragStart(e, task.id)}
-                  style={{
-                    left: start * unitWidth,
-                    width: (end - start) * unitWidth,
-                    top: 5,
-                    height: rowHeight - 10,
-                  }}
-                  title={`${task.name}: ${start}-${end} (duration: ${end - start})`}
-                >
-                  {task.name}
-                </div>
-              </div>
-            </div>
-          );
-        })}
-      </div>
+      <GanttCanvas
+        rows={rows}
+        bars={bars}
+        timeHorizon={problem.timeHorizon}
+        flagged={flagged}
+        showArrows
+        onTaskMove={handleTaskMove}
+      />
     </div>
   );
 };
@@ -0,0 +1,265 @@
+import React, { useEffect, useLayoutEffect, useRef } from "react";
+import type { BarState } from "./timelineIndex";
+import {
+  GANTT_LAYOUT,
+  drawGantt,
+  hitTest,
+  timeAt,
+  type GanttRows,
+  type RiskBands,
+  type Viewport,
+} from "./ganttRenderer";
+
+interface GanttCanvasProps {
+  rows: GanttRows;
+  bars: BarState;
+  timeHorizon: number;
+  flagged?: Uint8Array;
+  criticality?: Float32Array;
+  riskBands?: RiskBands;
+  showArrows?: boolean;
+  // Makes bars draggable; called with the new start when one is dropped.
+  onTaskMove?: (taskId: string, start: number) => void;
+}
+
+type Drag =
+  | { kind: "bar"; row: number; grab: number; start: number; duration: number }
+  | { kind: "pan"; x: number; y: number; time0: number; scrollTop: number };
+
+const MAX_HEIGHT = 400;
+const MAX_UNIT_WIDTH = 40;
+const MIN_UNIT_WIDTH = 1e-4;
+
+// Gantt chart drawn on one canvas. The view (zoom, time offset, row scroll)
+// lives in refs, so zooming and panning never re-render React, and every
+// change, new bars included, only schedules one redraw for the next frame.
+export const GanttCanvas: React.FC<GanttCanvasProps> = (props) => {
+  const containerRef = useRef<HTMLDivElement>(null);
+  const canvasRef = useRef<HTMLCanvasElement>(null);
+  const propsRef = useRef(props);
+  const viewRef = useRef<Viewport>({
+    time0: 0,
+    unitWidth: MAX_UNIT_WIDTH,
+    scrollTop: 0,
+    width: 0,
+    height: 0,
+  });
+  const needsFitRef = useRef(true);
+  const dragRef = useRef<Drag | null>(null);
+  const frameRef = useRef(0);
+
+  const chartHeight = Math.min(
+    MAX_HEIGHT,
+    GANTT_LAYOUT.headerHeight + props.rows.ids.length * GANTT_LAYOUT.rowHeight,
+  );
+
+  const clampView = () => {
+    const view = viewRef.current;
+    const rowsHeight = propsRef.current.rows.ids.length * GANTT_LAYOUT.rowHeight;
+    const maxScroll = Math.max(
+      0,
+      rowsHeight - (view.height - GANTT_LAYOUT.headerHeight),
+    );
+    view.scrollTop = Math.min(Math.max(0, view.scrollTop), maxScroll);
+    const visibleTime = (view.width - GANTT_LAYOUT.nameWidth) / view.unitWidth;
+    view.time0 = Math.min(
+      Math.max(-visibleTime / 2, view.time0),
+      Math.max(0, propsRef.current.timeHorizon - visibleTime / 2),
+    );
+  };
+
+  const draw = () => {
+    frameRef.current = 0;
+    const canvas = canvasRef.current;
+    const ctx = canvas?.getContext("2d");
+    if (!canvas || !ctx) return;
+    const view = viewRef.current;
+    if (view.width === 0) return;
+    const {
+      rows,
+      bars,
+      timeHorizon,
+      flagged,
+      criticality,
+      riskBands,
+      showArrows,
+    } = propsRef.current;
+    if (needsFitRef.current) {
+      needsFitRef.current = false;
+      view.time0 = 0;
+      view.scrollTop = 0;
+      view.unitWidth = Math.min(
+        MAX_UNIT_WIDTH,
+        (view.width - GANTT_LAYOUT.nameWidth - 8) / Math.max(1, timeHorizon),
+      );
+    }
+    const dpr = window.devicePixelRatio || 1;
+    ctx.setTransform(dpr, 0, 0, dpr, 0, 0);
+    const drag = dragRef.current;
+    drawGantt(ctx, rows, bars, view, {
+      flagged,
+      criticality,
+      riskBands,
+      showArrows: showArrows ?? false,
+      ghost:
+        drag?.kind === "bar"
+          ? { row: drag.row, start: drag.start, end: drag.start + drag.duration }
+          : undefined,
+    });
+  };
+
+  const requestDraw = () => {
+    if (frameRef.current === 0) {
+      frameRef.current = requestAnimationFrame(draw);
+    }
+  };
+
+  // The canvas backing store follows the element size and pixel ratio.
+  useEffect(() => {
+    const container = containerRef.current;
+    const canvas = canvasRef.current;
+    if (!container || !canvas) return;
+    const observer = new ResizeObserver(() => {
+      const dpr = window.devicePixelRatio || 1;
+      const width = container.clientWidth;
+      const height = container.clientHeight;
+      viewRef.current.width = width;
+      viewRef.current.height = height;
+      canvas.width = Math.round(width * dpr);
+      canvas.height = Math.round(height * dpr);
+      clampView();
+      draw();
+    });
+    observer.observe(container);
+    return () => {
+      observer.disconnect();
+      cancelAnimationFrame(frameRef.current);
+      frameRef.current = 0;
+    };
+  }, []);
+
+  useEffect(() => {
+    needsFitRef.current = true;
+    requestDraw();
+  }, [props.rows, props.timeHorizon]);
+
+  useLayoutEffect(() => {
+    propsRef.current = props;
+  });
+
+  useEffect(requestDraw);
+
+  // React registers wheel listeners as passive, so zooming needs its own.
+  useEffect(() => {
+    const canvas = canvasRef.current;
+    if (!canvas) return;
+    const onWheel = (event: WheelEvent) => {
+      event.preventDefault();
+      const view = viewRef.current;
+      const x = event.offsetX;
+      if (event.ctrlKey || event.metaKey) {
+        const anchor = timeAt(view, Math.max(x, GANTT_LAYOUT.nameWidth));
+        const zoom = Math.exp(-event.deltaY * 0.002);
+        view.unitWidth = Math.min(
+          MAX_UNIT_WIDTH * 4,
+          Math.max(MIN_UNIT_WIDTH, view.unitWidth * zoom),
+        );
+        view.time0 =
+          anchor -
+          (Math.max(x, GANTT_LAYOUT.nameWidth) - GANTT_LAYOUT.nameWidth) /
+            view.unitWidth;
+      } else if (event.shiftKey || Math.abs(event.deltaX) > Math.abs(event.deltaY)) {
+        const delta = event.shiftKey ? event.deltaY : event.deltaX;
+        view.time0 += delta / view.unitWidth;
+      } else {
+        view.scrollTop += event.deltaY;
+      }
+      clampView();
+      requestDraw();
+    };
+    canvas.addEventListener("wheel", onWheel, { passive: false });
+    return () => canvas.removeEventListener("wheel", onWheel);
+  }, []);
+
+  const handlePointerDown = (e: React.PointerEvent<HTMLCanvasElement>) => {
+    const { rows, bars, onTaskMove } = propsRef.current;
+    const view = viewRef.current;
+    const x = e.nativeEvent.offsetX;
+    const y = e.nativeEvent.offsetY;
+    const row = onTaskMove ? hitTest(rows, bars, view, x, y) : -1;
+    if (row >= 0) {
+      dragRef.current = {
+        kind: "bar",
+        row,
+        grab: timeAt(view, x) - bars.starts[row],
+        start: bars.starts[row],
+        duration: bars.ends[row] - bars.starts[row],
+      };
+    } else {
+      dragRef.current = {
+        kind: "pan",
+        x,
+        y,
+        time0: view.time0,
+        scrollTop: view.scrollTop,
+      };
+    }
+    e.currentTarget.setPointerCapture(e.pointerId);
+  };
+
+  const handlePointerMove = (e: React.PointerEvent<HTMLCanvasElement>) => {
+    const { rows, bars, onTaskMove } = propsRef.current;
+    const view = viewRef.current;
+    const x = e.nativeEvent.offsetX;
+    const y = e.nativeEvent.offsetY;
+    const drag = dragRef.current;
+    if (!drag) {
+      const row = hitTest(rows, bars, view, x, y);
+      const canvas = e.currentTarget;
+      canvas.style.cursor = row >= 0 && onTaskMove ? "grab" : "default";
+      if (row < 0) {
+        canvas.title = "";
+      } else {
+        const start = bars.starts[row];
+        const end = bars.ends[row];
+        canvas.title = `${rows.names[row]}: ${start}-${end} (duration: ${end - start})`;
+      }
+      return;
+    }
+    if (drag.kind === "bar") {
+      drag.start = Math.max(0, Math.round(timeAt(view, x) - drag.grab));
+    } else {
+      view.time0 = drag.time0 - (x - drag.x) / view.unitWidth;
+      view.scrollTop = drag.scrollTop - (y - drag.y);
+      clampView();
+    }
+    requestDraw();
+  };
+
+  const handlePointerUp = (e: React.PointerEvent<HTMLCanvasElement>) => {
+    const drag = dragRef.current;
+    dragRef.current = null;
+    e.currentTarget.releasePointerCapture(e.pointerId);
+    const { rows, bars, onTaskMove } = propsRef.current;
+    if (drag?.kind === "bar" && onTaskMove && drag.start !== bars.starts[drag.row]) {
+      onTaskMove(rows.ids[drag.row], drag.start);
+    }
+    requestDraw();
+  };
+
+  return (
+    <div
+      ref={containerRef}
+      className="gantt-canvas"
+      style={{ height: chartHeight }}
+    >
+      <canvas
+        ref={canvasRef}
+        onPointerDown={handlePointerDown}
+        onPointerMove={handlePointerMove}
+        onPointerUp={handlePointerUp}
+        onPointerCancel={handlePointerUp}
+      />
+    </div>
+  );
+};
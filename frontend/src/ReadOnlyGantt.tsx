@@ -1,64 +1,54 @@
 import React from "react";
 import { useTimelineStore } from "./store";
+import { GanttCanvas } from "./GanttCanvas";
 
-export const ReadOnlyGantt: React.FC = () => {
-  const { getProblemDefinition, getTasksAtTime, currentTime } =
-    useTimelineStore();
+// The bars the solver holds at the current point of the trace, shaded by
+// criticality when the trace has a sensitivity analysis and drawn over their
+// finish-time bands when it has a risk profile from rcpsp_simulate.
+export const SolverStateGantt: React.FC = () => {
+  const {
+    getProblemDefinition,
+    getGanttRows,
+    getBarsAtTime,
+    getCriticality,
+    getRiskBands,
+    sensitivity,
+    risk,
+    currentTime,
+  } = useTimelineStore();
   const problem = getProblemDefinition();
-  const tasks = getTasksAtTime(currentTime);
-  const taskMap = new Map(tasks.map((t) => [t.id, t]));
 
-  const unitWidth = 40;
-  const rowHeight = 40;
+  return (
+    <div className="draggable-gantt">
+      <GanttCanvas
+        rows={getGanttRows()}
+        bars={getBarsAtTime(currentTime)}
+        criticality={getCriticality()}
+        riskBands={getRiskBands()}
+        timeHorizon={problem.timeHorizon}
+      />
+      {sensitivity && (
+        <p className="gantt-legend">
+          Darker bars move the makespan more when their duration changes by
+          &plusmn;{sensitivity.delta}.
+        </p>
+      )}
+      {risk && (
+        <p className="gantt-legend">
+          Shaded bands span the 10th to 90th percentile finish over{" "}
+          {risk.replays} replays ({risk.distribution}), and the line marks the
+          median. On time with probability{" "}
+          {(risk.onTimeProbability * 100).toFixed(1)}%.
+        </p>
+      )}
+    </div>
+  );
+};
 
+export const ReadOnlyGantt: React.FC = () => {
   return (
     <div className="gantt-chart">
-      <div className="draggable-gantt">
-        <div className="gantt-header">
-          <div className="task-header">Task</div>
-          <div className="timeline-header">
-            {Array.from({ length: problem.timeHorizon + 1 }, (_, i) => (
-              <div key={i} className="time-unit" style={{ width: unitWidth }}>
-                {i}
-              </div>
-            ))}
-          </div>
-        </div>
-        <div className="gantt-body" style={{ position: "relative" }}>
-          {problem.tasks.map((task) => {
-            const currentTask = taskMap.get(task.id);
-
-            return (
-              <div
-                key={task.id}
-                className="gantt-row"
-                style={{ height: rowHeight }}
-              >
-                <div className="task-name">{task.name}</div>
-                <div className="timeline-row">
-                  {currentTask && (
-                    <div
-                      className="task-bar"
-                      style={{
-                        left: currentTask.startTime * unitWidth,
-                        width:
-                          (currentTask.endTime - currentTask.startTime) *
-                          unitWidth,
-                        top: 5,
-                        height: rowHeight - 10,
-                        cursor: "default",
-                      }}
-                      title={`${task.name}: ${currentTask.startTime}-${currentTask.endTime} (duration: ${currentTask.endTime - currentTask.startTime})`}
-                    >
-                      {task.name}
-                    </div>
-                  )}
-                </div>
-              </div>
-            );
-          })}
-        </div>
-      </div>
+      <SolverStateGantt />
     </div>
   );
 };
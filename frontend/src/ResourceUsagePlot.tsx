@@ -1,16 +1,17 @@
 import React, { useRef, useEffect } from "react";
+import type { ResourceProfile } from "./resourceProfile";
 
 interface ResourceUsagePlotProps {
   resource: { id: string; capacity: number };
-  schedule: Map<string, { start: number; end: number }>;
-  tasks: Array<{ id: string; name: string; resourceDemands: number[] }>;
+  profile: ResourceProfile;
   timeHorizon: number;
 }
 
+// Draws one column per pixel from the min and max usage under it, so the
+// cost does not depend on the horizon and no peak falls between pixels.
 export const ResourceUsagePlot: React.FC<ResourceUsagePlotProps> = ({
   resource,
-  schedule,
-  tasks,
+  profile,
   timeHorizon,
 }) => {
   const canvasRef = useRef<HTMLCanvasElement>(null);
@@ -30,50 +31,51 @@ export const ResourceUsagePlot: React.FC<ResourceUsagePlotProps> = ({
     const padding = 30;
     const plotWidth = width - padding * 2;
     const plotHeight = height - padding * 2;
-
-    const xScale = plotWidth / timeHorizon;
-    const yScale = plotHeight / resource.capacity;
-
-    const usage = new Array(timeHorizon + 1).fill(0);
-
-    schedule.forEach((timing, taskId) => {
-      const task = tasks.find((t) => t.id === taskId);
-      if (!task) return;
-
-      const demand = task.resourceDemands[parseInt(resource.id)] || 0;
-      if (demand === 0) return;
-
-      for (let t = timing.start; t < timing.end; t++) {
-        usage[t] += demand;
+    const baseline = height - padding;
+
+    const yScale = plotHeight / Math.max(resource.capacity, profile.peak, 1);
+    const capacityY = baseline - resource.capacity * yScale;
+
+    const minUsage = new Float64Array(plotWidth);
+    const maxUsage = new Float64Array(plotWidth);
+    profile.columns(0, Math.max(1, timeHorizon), plotWidth, minUsage, maxUsage);
+
+    // Light where usage varies within a column, solid below its minimum.
+    const band = (usage: Float64Array) => {
+      ctx.beginPath();
+      ctx.moveTo(padding, baseline);
+      for (let c = 0; c < plotWidth; c++) {
+        const y = baseline - usage[c] * yScale;
+        ctx.lineTo(padding + c, y);
+        ctx.lineTo(padding + c + 1, y);
       }
-    });
+      ctx.lineTo(padding + plotWidth, baseline);
+      ctx.closePath();
+    };
 
     ctx.fillStyle = "rgba(59, 130, 246, 0.3)";
     ctx.strokeStyle = "rgba(59, 130, 246, 1)";
     ctx.lineWidth = 2;
-
-    ctx.beginPath();
-    ctx.moveTo(padding, height - padding);
-
-    for (let t = 0; t <= timeHorizon; t++) {
-      const x = padding + t * xScale;
-      const y = height - padding - usage[t] * yScale;
-      ctx.lineTo(x, y);
-    }
-
-    ctx.lineTo(padding + plotWidth, height - padding);
-    ctx.closePath();
+    band(maxUsage);
     ctx.fill();
     ctx.stroke();
+    band(minUsage);
+    ctx.fill();
+
+    ctx.fillStyle = "rgba(239, 68, 68, 0.6)";
+    for (let c = 0; c < plotWidth; c++) {
+      if (maxUsage[c] > resource.capacity) {
+        const y = baseline - maxUsage[c] * yScale;
+        ctx.fillRect(padding + c, y, 1, capacityY - y);
+      }
+    }
 
     ctx.strokeStyle = "rgba(239, 68, 68, 0.5)";
+    ctx.lineWidth = 2;
     ctx.setLineDash([5, 5]);
     ctx.beginPath();
-    ctx.moveTo(padding, height - padding - resource.capacity * yScale);
-    ctx.lineTo(
-      padding + plotWidth,
-      height - padding - resource.capacity * yScale,
-    );
+    ctx.moveTo(padding, capacityY);
+    ctx.lineTo(padding + plotWidth, capacityY);
     ctx.stroke();
     ctx.setLineDash([]);
 
@@ -87,21 +89,13 @@ export const ResourceUsagePlot: React.FC<ResourceUsagePlotProps> = ({
     );
 
     ctx.textAlign = "right";
-    ctx.fillText(
-      resource.capacity.toString(),
-      padding - 5,
-      height - padding - resource.capacity * yScale + 4,
-    );
-    ctx.fillText("0", padding - 5, height - padding + 4);
+    ctx.fillText(resource.capacity.toString(), padding - 5, capacityY + 4);
+    ctx.fillText("0", padding - 5, baseline + 4);
 
     ctx.textAlign = "center";
-    ctx.fillText("0", padding, height - padding + 15);
-    ctx.fillText(
-      timeHorizon.toString(),
-      width - padding,
-      height - padding + 15,
-    );
-  }, [resource, schedule, tasks, timeHorizon]);
+    ctx.fillText("0", padding, baseline + 15);
+    ctx.fillText(timeHorizon.toString(), width - padding, baseline + 15);
+  }, [resource, profile, timeHorizon]);
 
   return (
     <div className="resource-usage-plot">
@@ -1,21 +1,35 @@
-import React from "react";
+import React, { useMemo } from "react";
 import { useTimelineStore } from "./store";
 import { ResourceUsagePlot } from "./ResourceUsagePlot";
+import { ResourceProfile } from "./resourceProfile";
 
 export const ResourceUsagePlots: React.FC = () => {
   const { getProblemDefinition, getCurrentSchedule } = useTimelineStore();
   const problem = getProblemDefinition();
   const schedule = getCurrentSchedule();
 
+  const profiles = useMemo(() => {
+    const tasksById = new Map(problem.tasks.map((task) => [task.id, task]));
+    return problem.resources.map((resource) => {
+      const index = parseInt(resource.id);
+      const intervals: Array<{ start: number; end: number; demand: number }> =
+        [];
+      schedule.forEach((timing, taskId) => {
+        const demand = tasksById.get(taskId)?.resourceDemands[index] || 0;
+        intervals.push({ start: timing.start, end: timing.end, demand });
+      });
+      return new ResourceProfile(intervals);
+    });
+  }, [problem, schedule]);
+
   return (
     <div className="resource-usage-plots">
       <h3>Resource Usage</h3>
-      {problem.resources.map((resource) => (
+      {problem.resources.map((resource, i) => (
         <ResourceUsagePlot
           key={resource.id}
           resource={resource}
-          schedule={schedule}
-          tasks={problem.tasks}
+          profile={profiles[i]}
           timeHorizon={problem.timeHorizon}
         />
       ))}
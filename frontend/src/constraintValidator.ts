@@ -8,20 +8,23 @@ export interface ConstraintViolation {
   relatedTasks?: string[];
 }
 
+type TasksById = Map<string, ProblemDefinition["tasks"][number]>;
+
 export function validateSchedule(
   schedule: Map<string, { start: number; end: number }>,
   problem: ProblemDefinition,
 ): ConstraintViolation[] {
   const violations: ConstraintViolation[] = [];
+  const tasksById = new Map(problem.tasks.map((task) => [task.id, task]));
 
   // 1. Check precedence constraints
-  violations.push(...validatePrecedence(schedule, problem));
+  violations.push(...validatePrecedence(schedule, problem, tasksById));
 
   // 2. Check resource constraints
-  violations.push(...validateResources(schedule, problem));
+  violations.push(...validateResources(schedule, problem, tasksById));
 
   // 3. Check for overlaps (same task scheduled twice)
-  violations.push(...validateOverlaps(schedule, problem));
+  violations.push(...validateOverlaps(schedule, tasksById));
 
   return violations;
 }
@@ -29,6 +32,7 @@ export function validateSchedule(
 function validatePrecedence(
   schedule: Map<string, { start: number; end: number }>,
   problem: ProblemDefinition,
+  tasksById: TasksById,
 ): ConstraintViolation[] {
   const violations: ConstraintViolation[] = [];
 
@@ -45,7 +49,7 @@ function validatePrecedence(
         violations.push({
           type: "precedence",
           taskId: task.id,
-          message: `Task "${task.name}" starts at ${taskTiming.start} but dependency "${problem.tasks.find((t) => t.id === depId)?.name}" ends at ${depTiming.end}`,
+          message: `Task "${task.name}" starts at ${taskTiming.start} but dependency "${tasksById.get(depId)?.name}" ends at ${depTiming.end}`,
           severity: "error",
           relatedTasks: [depId],
         });
@@ -59,6 +63,7 @@ function validatePrecedence(
 function validateResources(
   schedule: Map<string, { start: number; end: number }>,
   problem: ProblemDefinition,
+  tasksById: TasksById,
 ): ConstraintViolation[] {
   const violations: ConstraintViolation[] = [];
 
@@ -68,7 +73,7 @@ function validateResources(
     const tasksUsingResource: Map<number, string[]> = new Map();
 
     schedule.forEach((timing, taskId) => {
-      const task = problem.tasks.find((t) => t.id === taskId);
+      const task = tasksById.get(taskId);
       if (!task) return;
 
       const demand = task.resourceDemands[parseInt(resource.id)] || 0;
@@ -103,7 +108,7 @@ function validateResources(
 
 function validateOverlaps(
   schedule: Map<string, { start: number; end: number }>,
-  problem: ProblemDefinition,
+  tasksById: TasksById,
 ): ConstraintViolation[] {
   const violations: ConstraintViolation[] = [];
 
@@ -113,7 +118,7 @@ function validateOverlaps(
       violations.push({
         type: "overlap",
         taskId,
-        message: `Task "${problem.tasks.find((t) => t.id === taskId)?.name}" has invalid timing: start (${timing.start}) >= end (${timing.end})`,
+        message: `Task "${tasksById.get(taskId)?.name}" has invalid timing: start (${timing.start}) >= end (${timing.end})`,
         severity: "error",
       });
     }
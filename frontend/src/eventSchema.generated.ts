@@ -0,0 +1,243 @@
+// Generated by event_schema_gen from event_schema.h; do not edit.
+// After changing the schema, regenerate with
+//   event_schema_gen --output=frontend/src/eventSchema.generated.ts
+
+export type EventType =
+  | "start"
+  | "assign"
+  | "modify"
+  | "remove"
+  | "conflict"
+  | "incumbent"
+  | "bound";
+
+export type NodeStatus =
+  | ""
+  | "created"
+  | "pruned";
+const NODE_STATUSES: readonly NodeStatus[] = ["", "created", "pruned"];
+
+export type Propagator =
+  | "precedence"
+  | "cumulative"
+  | "objective"
+  | "search";
+const PROPAGATORS: readonly Propagator[] = ["precedence", "cumulative", "objective", "search"];
+
+// Fields of every event.
+export interface EventFields {
+  id: string;
+  taskId: string;
+  taskName: string;
+  timestamp: number;
+  startTime: number;
+  endTime: number;
+  decisionLevel: number;
+  backtrackToLevel: number;
+  nodeId: string;
+  parentNodeId: string;
+  nodeStatus: NodeStatus;
+  dependencies: number[];
+  successors: number[];
+  description: string;
+}
+
+export interface StartEvent extends EventFields {
+  type: "start";
+  demands?: number[];
+}
+
+export interface AssignEvent extends EventFields {
+  type: "assign";
+}
+
+export interface ModifyEvent extends EventFields {
+  type: "modify";
+  propagator?: Propagator;
+  constraintIndex?: number;
+  resourceId?: string;
+}
+
+export interface RemoveEvent extends EventFields {
+  type: "remove";
+}
+
+export interface ConflictEvent extends EventFields {
+  type: "conflict";
+  conflicts?: number;
+  explanationSize?: number;
+}
+
+export interface IncumbentEvent extends EventFields {
+  type: "incumbent";
+  incumbentIndex?: number;
+  objective: number;
+  bestBound: number;
+  wallTime: number;
+  solution: number[];
+}
+
+export interface BoundEvent extends EventFields {
+  type: "bound";
+  bestBound: number;
+  wallTime: number;
+}
+
+export type TaskEvent =
+  | StartEvent
+  | AssignEvent
+  | ModifyEvent
+  | RemoveEvent
+  | ConflictEvent
+  | IncumbentEvent
+  | BoundEvent;
+
+export class EventDecodeError extends Error {}
+
+type JsonObject = Record<string, unknown>;
+
+function invalid(key: string, expected: string): EventDecodeError {
+  return new EventDecodeError(`"${key}" is not ${expected}`);
+}
+
+function readInt(o: JsonObject, key: string): number {
+  const value = o[key];
+  if (typeof value !== "number" || !Number.isInteger(value)) {
+    throw invalid(key, "an integer");
+  }
+  return value;
+}
+
+// The writer turns NaN and infinities into null.
+function readDouble(o: JsonObject, key: string): number {
+  const value = o[key];
+  if (value === null) return NaN;
+  if (typeof value !== "number") throw invalid(key, "a number");
+  return value;
+}
+
+function readId(o: JsonObject, key: string): string {
+  const value = o[key];
+  if (typeof value === "string") return value;
+  if (typeof value === "number" && Number.isInteger(value)) {
+    return String(value);
+  }
+  throw invalid(key, "an id");
+}
+
+function readString(o: JsonObject, key: string): string {
+  const value = o[key];
+  if (typeof value !== "string") throw invalid(key, "a string");
+  return value;
+}
+
+function readIntList(o: JsonObject, key: string): number[] {
+  const value = o[key];
+  if (
+    !Array.isArray(value) ||
+    !value.every((item) => typeof item === "number" && Number.isInteger(item))
+  ) {
+    throw invalid(key, "a list of integers");
+  }
+  return value as number[];
+}
+
+function readEnum<T extends string>(
+  o: JsonObject,
+  key: string,
+  values: readonly T[],
+): T {
+  const value = o[key];
+  if (typeof value !== "string" || !(values as readonly string[]).includes(value)) {
+    throw invalid(key, `one of ${JSON.stringify(values)}`);
+  }
+  return value as T;
+}
+
+function decodeFields(o: JsonObject): EventFields {
+  return {
+    id: readString(o, "id"),
+    taskId: readId(o, "taskId"),
+    taskName: readString(o, "taskName"),
+    timestamp: readInt(o, "timestamp"),
+    startTime: readInt(o, "startTime"),
+    endTime: readInt(o, "endTime"),
+    decisionLevel: readInt(o, "decisionLevel"),
+    backtrackToLevel: readInt(o, "backtrackToLevel"),
+    nodeId: readString(o, "nodeId"),
+    parentNodeId: readString(o, "parentNodeId"),
+    nodeStatus: readEnum(o, "nodeStatus", NODE_STATUSES),
+    dependencies: readIntList(o, "dependencies"),
+    successors: readIntList(o, "successors"),
+    description: readString(o, "description"),
+  };
+}
+
+export function decodeTaskEvent(raw: unknown): TaskEvent {
+  if (typeof raw !== "object" || raw === null || Array.isArray(raw)) {
+    throw new EventDecodeError("event is not an object");
+  }
+  const o = raw as JsonObject;
+  const fields = decodeFields(o);
+  switch (o.type) {
+    case "start":
+      return {
+        ...fields,
+        type: "start",
+        demands: o.demands === undefined ? undefined : readIntList(o, "demands"),
+      };
+    case "assign":
+      return { ...fields, type: "assign" };
+    case "modify":
+      return {
+        ...fields,
+        type: "modify",
+        propagator: o.propagator === undefined ? undefined : readEnum(o, "propagator", PROPAGATORS),
+        constraintIndex: o.constraintIndex === undefined ? undefined : readInt(o, "constraintIndex"),
+        resourceId: o.resourceId === undefined ? undefined : readId(o, "resourceId"),
+      };
+    case "remove":
+      return { ...fields, type: "remove" };
+    case "conflict":
+      return {
+        ...fields,
+        type: "conflict",
+        conflicts: o.conflicts === undefined ? undefined : readInt(o, "conflicts"),
+        explanationSize: o.explanationSize === undefined ? undefined : readInt(o, "explanationSize"),
+      };
+    case "incumbent":
+      return {
+        ...fields,
+        type: "incumbent",
+        incumbentIndex: o.incumbentIndex === undefined ? undefined : readInt(o, "incumbentIndex"),
+        objective: readDouble(o, "objective"),
+        bestBound: readDouble(o, "bestBound"),
+        wallTime: readDouble(o, "wallTime"),
+        solution: readIntList(o, "solution"),
+      };
+    case "bound":
+      return {
+        ...fields,
+        type: "bound",
+        bestBound: readDouble(o, "bestBound"),
+        wallTime: readDouble(o, "wallTime"),
+      };
+    default:
+      throw new EventDecodeError(`unknown event type ${JSON.stringify(o.type)}`);
+  }
+}
+
+// Decodes the events array of a trace, naming the first bad event.
+export function decodeTaskEvents(raw: unknown): TaskEvent[] {
+  if (!Array.isArray(raw)) {
+    throw new EventDecodeError("events is not an array");
+  }
+  return raw.map((event, index) => {
+    try {
+      return decodeTaskEvent(event);
+    } catch (error) {
+      const message = error instanceof Error ? error.message : String(error);
+      throw new EventDecodeError(`event ${index}: ${message}`);
+    }
+  });
+}
@@ -0,0 +1,412 @@
+import type { BarState } from "./timelineIndex";
+
+// Gantt rows and precedence edges in flat arrays, built once per instance.
+export interface GanttRows {
+  ids: string[];
+  names: string[];
+  rowOf: Map<string, number>;
+  // Edge e runs from the end of row edgeFrom[e] to the start of edgeTo[e].
+  edgeFrom: Int32Array;
+  edgeTo: Int32Array;
+}
+
+export function buildGanttRows(
+  tasks: Array<{ id: string; name: string; dependencies: string[] }>,
+): GanttRows {
+  const rowOf = new Map<string, number>();
+  tasks.forEach((task, row) => rowOf.set(task.id, row));
+  const from: number[] = [];
+  const to: number[] = [];
+  tasks.forEach((task, row) => {
+    for (const dependency of task.dependencies) {
+      const predecessor = rowOf.get(dependency);
+      if (predecessor === undefined) continue;
+      from.push(predecessor);
+      to.push(row);
+    }
+  });
+  return {
+    ids: tasks.map((task) => task.id),
+    names: tasks.map((task) => task.name),
+    rowOf,
+    edgeFrom: Int32Array.from(from),
+    edgeTo: Int32Array.from(to),
+  };
+}
+
+// The visible window, in CSS pixels: time0 is the time at the left edge of
+// the timeline and scrollTop the row offset in pixels.
+export interface Viewport {
+  time0: number;
+  unitWidth: number;
+  scrollTop: number;
+  width: number;
+  height: number;
+}
+
+// Finish-time percentiles per row from rcpsp_simulate; NaN for rows the
+// simulation does not cover.
+export interface RiskBands {
+  finishP10: Float32Array;
+  finishP50: Float32Array;
+  finishP90: Float32Array;
+}
+
+export const GANTT_LAYOUT = {
+  rowHeight: 28,
+  nameWidth: 150,
+  headerHeight: 24,
+};
+
+export interface GanttDrawOptions {
+  // Rows drawn in the violation color.
+  flagged?: Uint8Array;
+  // Criticality in [0, 1] per row from a sensitivity analysis; bars are
+  // shaded by it, and NaN rows keep the plain bar color.
+  criticality?: Float32Array;
+  // Drawn behind the bars from the 10th to the 90th percentile finish, with
+  // a line at the median.
+  riskBands?: RiskBands;
+  showArrows: boolean;
+  // A bar being dragged, drawn over the chart.
+  ghost?: { row: number; start: number; end: number };
+}
+
+// Bar colors for criticality up to 1/4, 1/2, 3/4 and 1.
+const CRITICALITY_COLORS = ["#fcc419", "#fd7e14", "#e8590c", "#c92a2a"];
+
+const COLORS = {
+  bar: "#667eea",
+  flagged: "#d32f2f",
+  ghost: "rgba(118, 75, 162, 0.5)",
+  riskBand: "rgba(250, 82, 82, 0.18)",
+  riskMedian: "#c92a2a",
+  satisfied: "#4caf50",
+  violated: "#f44336",
+  grid: "#f0f0f0",
+  border: "#e0e0e0",
+  header: "#f5f5f5",
+  text: "#333",
+  mutedText: "#666",
+};
+
+// Edges are drawn as curves with arrowheads while few are visible, and as
+// plain segments beyond that.
+const DETAILED_EDGE_LIMIT = 400;
+const MIN_TICK_SPACING = 48;
+const MIN_LABEL_WIDTH = 36;
+
+export function timeAt(viewport: Viewport, x: number): number {
+  return viewport.time0 + (x - GANTT_LAYOUT.nameWidth) / viewport.unitWidth;
+}
+
+export function xAt(viewport: Viewport, time: number): number {
+  return GANTT_LAYOUT.nameWidth + (time - viewport.time0) * viewport.unitWidth;
+}
+
+// Row under a y coordinate, or -1 over the header.
+export function rowAt(viewport: Viewport, y: number): number {
+  if (y < GANTT_LAYOUT.headerHeight) return -1;
+  return Math.floor(
+    (y - GANTT_LAYOUT.headerHeight + viewport.scrollTop) /
+      GANTT_LAYOUT.rowHeight,
+  );
+}
+
+function yAt(viewport: Viewport, row: number): number {
+  return (
+    GANTT_LAYOUT.headerHeight +
+    row * GANTT_LAYOUT.rowHeight -
+    viewport.scrollTop
+  );
+}
+
+// Rows at least partly inside the viewport, as [first, last).
+export function visibleRows(
+  viewport: Viewport,
+  numRows: number,
+): [number, number] {
+  const first = Math.max(
+    0,
+    Math.floor(viewport.scrollTop / GANTT_LAYOUT.rowHeight),
+  );
+  const last = Math.min(
+    numRows,
+    Math.ceil(
+      (viewport.scrollTop + viewport.height - GANTT_LAYOUT.headerHeight) /
+        GANTT_LAYOUT.rowHeight,
+    ),
+  );
+  return [first, Math.max(first, last)];
+}
+
+// Row of the bar under (x, y), or -1.
+export function hitTest(
+  rows: GanttRows,
+  bars: BarState,
+  viewport: Viewport,
+  x: number,
+  y: number,
+): number {
+  if (x < GANTT_LAYOUT.nameWidth) return -1;
+  const row = rowAt(viewport, y);
+  if (row < 0 || row >= rows.ids.length) return -1;
+  const start = bars.starts[row];
+  if (Number.isNaN(start)) return -1;
+  const x0 = xAt(viewport, start);
+  const x1 = Math.max(x0 + 1, xAt(viewport, bars.ends[row]));
+  return x >= x0 - 2 && x <= x1 + 2 ? row : -1;
+}
+
+// Draws the rows in view: only visible rows are touched, bars and edges are
+// batched into one path per color, and edges outside the window are culled
+// before any geometry is computed for them.
+export function drawGantt(
+  ctx: CanvasRenderingContext2D,
+  rows: GanttRows,
+  bars: BarState,
+  viewport: Viewport,
+  options: GanttDrawOptions,
+): void {
+  const { rowHeight, nameWidth, headerHeight } = GANTT_LAYOUT;
+  const { width, height } = viewport;
+  const [firstRow, lastRow] = visibleRows(viewport, rows.ids.length);
+  const timeEnd = timeAt(viewport, width);
+
+  ctx.clearRect(0, 0, width, height);
+  ctx.fillStyle = "white";
+  ctx.fillRect(0, 0, width, height);
+
+  // Time grid.
+  const tick = tickStep(viewport.unitWidth);
+  const firstTick = Math.ceil(viewport.time0 / tick) * tick;
+  ctx.beginPath();
+  for (let t = firstTick; t <= timeEnd; t += tick) {
+    const x = Math.round(xAt(viewport, t)) + 0.5;
+    ctx.moveTo(x, headerHeight);
+    ctx.lineTo(x, height);
+  }
+  ctx.strokeStyle = COLORS.grid;
+  ctx.lineWidth = 1;
+  ctx.stroke();
+
+  // Row separators.
+  ctx.beginPath();
+  for (let row = firstRow; row < lastRow; row++) {
+    const y = Math.round(yAt(viewport, row + 1)) - 0.5;
+    ctx.moveTo(0, y);
+    ctx.lineTo(width, y);
+  }
+  ctx.strokeStyle = COLORS.border;
+  ctx.stroke();
+
+  // Bars, clipped to the timeline.
+  ctx.save();
+  ctx.beginPath();
+  ctx.rect(nameWidth, headerHeight, width - nameWidth, height - headerHeight);
+  ctx.clip();
+
+  const riskMedians = new Path2D();
+  if (options.riskBands) {
+    const { finishP10, finishP50, finishP90 } = options.riskBands;
+    const riskBands = new Path2D();
+    for (let row = firstRow; row < lastRow; row++) {
+      const p10 = finishP10[row];
+      const p90 = finishP90[row];
+      if (Number.isNaN(p10) || p90 < viewport.time0 || p10 > timeEnd) continue;
+      const y = yAt(viewport, row) + 2;
+      const x0 = xAt(viewport, p10);
+      riskBands.rect(x0, y, Math.max(1, xAt(viewport, p90) - x0), rowHeight - 4);
+      const median = Math.round(xAt(viewport, finishP50[row])) + 0.5;
+      riskMedians.moveTo(median, y);
+      riskMedians.lineTo(median, y + rowHeight - 4);
+    }
+    ctx.fillStyle = COLORS.riskBand;
+    ctx.fill(riskBands);
+  }
+
+  if (options.showArrows) drawEdges(ctx, rows, bars, viewport, firstRow, lastRow);
+
+  const barPath = new Path2D();
+  const flaggedPath = new Path2D();
+  const criticalityPaths = CRITICALITY_COLORS.map(() => new Path2D());
+  const { criticality } = options;
+  for (let row = firstRow; row < lastRow; row++) {
+    const start = bars.starts[row];
+    if (Number.isNaN(start) || bars.ends[row] < viewport.time0 || start > timeEnd) {
+      continue;
+    }
+    const x0 = Math.max(nameWidth - 1, xAt(viewport, start));
+    const x1 = Math.min(width + 1, xAt(viewport, bars.ends[row]));
+    let path = barPath;
+    if (options.flagged?.[row]) {
+      path = flaggedPath;
+    } else if (criticality && criticality[row] > 0) {
+      const level = Math.min(
+        CRITICALITY_COLORS.length - 1,
+        Math.ceil(criticality[row] * CRITICALITY_COLORS.length) - 1,
+      );
+      path = criticalityPaths[level];
+    }
+    path.rect(x0, yAt(viewport, row) + 4, Math.max(1, x1 - x0), rowHeight - 8);
+  }
+  ctx.fillStyle = COLORS.bar;
+  ctx.fill(barPath);
+  criticalityPaths.forEach((criticalityPath, level) => {
+    ctx.fillStyle = CRITICALITY_COLORS[level];
+    ctx.fill(criticalityPath);
+  });
+  ctx.fillStyle = COLORS.flagged;
+  ctx.fill(flaggedPath);
+  // Medians go over the bars, which would hide those inside them.
+  ctx.strokeStyle = COLORS.riskMedian;
+  ctx.lineWidth = 2;
+  ctx.stroke(riskMedians);
+  ctx.lineWidth = 1;
+
+  if (options.ghost) {
+    const { row, start, end } = options.ghost;
+    const x0 = xAt(viewport, start);
+    ctx.fillStyle = COLORS.ghost;
+    ctx.fillRect(
+      x0,
+      yAt(viewport, row) + 4,
+      Math.max(1, xAt(viewport, end) - x0),
+      rowHeight - 8,
+    );
+  }
+
+  // Labels on bars wide enough to hold them.
+  ctx.font = "11px sans-serif";
+  ctx.textAlign = "center";
+  ctx.textBaseline = "middle";
+  ctx.fillStyle = "white";
+  for (let row = firstRow; row < lastRow; row++) {
+    const start = bars.starts[row];
+    if (Number.isNaN(start)) continue;
+    const x0 = Math.max(nameWidth, xAt(viewport, start));
+    const x1 = Math.min(width, xAt(viewport, bars.ends[row]));
+    if (x1 - x0 < MIN_LABEL_WIDTH) continue;
+    const name = rows.names[row];
+    if (ctx.measureText(name).width > x1 - x0 - 8) continue;
+    ctx.fillText(name, (x0 + x1) / 2, yAt(viewport, row) + rowHeight / 2);
+  }
+  ctx.restore();
+
+  // Task names.
+  ctx.fillStyle = "white";
+  ctx.fillRect(0, headerHeight, nameWidth, height - headerHeight);
+  ctx.save();
+  ctx.beginPath();
+  ctx.rect(0, headerHeight, nameWidth - 4, height - headerHeight);
+  ctx.clip();
+  ctx.font = "13px sans-serif";
+  ctx.textAlign = "left";
+  ctx.fillStyle = COLORS.text;
+  for (let row = firstRow; row < lastRow; row++) {
+    ctx.fillText(rows.names[row], 12, yAt(viewport, row) + rowHeight / 2);
+  }
+  ctx.restore();
+
+  // Header with time labels.
+  ctx.fillStyle = COLORS.header;
+  ctx.fillRect(0, 0, width, headerHeight);
+  ctx.fillStyle = COLORS.text;
+  ctx.font = "600 12px sans-serif";
+  ctx.textAlign = "left";
+  ctx.fillText("Task", 12, headerHeight / 2);
+  ctx.fillStyle = COLORS.mutedText;
+  ctx.font = "12px sans-serif";
+  ctx.textAlign = "center";
+  for (let t = Math.max(firstTick, 0); t <= timeEnd; t += tick) {
+    const x = xAt(viewport, t);
+    if (x < nameWidth + 8) continue;
+    ctx.fillText(String(t), x, headerHeight / 2);
+  }
+
+  ctx.beginPath();
+  ctx.moveTo(0, headerHeight - 0.5);
+  ctx.lineTo(width, headerHeight - 0.5);
+  ctx.moveTo(nameWidth - 0.5, 0);
+  ctx.lineTo(nameWidth - 0.5, height);
+  ctx.strokeStyle = COLORS.border;
+  ctx.stroke();
+}
+
+function drawEdges(
+  ctx: CanvasRenderingContext2D,
+  rows: GanttRows,
+  bars: BarState,
+  viewport: Viewport,
+  firstRow: number,
+  lastRow: number,
+): void {
+  const { rowHeight } = GANTT_LAYOUT;
+  const timeEnd = timeAt(viewport, viewport.width);
+  const visible: number[] = [];
+  for (let e = 0; e < rows.edgeFrom.length; e++) {
+    const from = rows.edgeFrom[e];
+    const to = rows.edgeTo[e];
+    // Cull on rows first: an edge is visible if it spans a visible row.
+    if (Math.max(from, to) < firstRow || Math.min(from, to) >= lastRow) continue;
+    const t0 = bars.ends[from];
+    const t1 = bars.starts[to];
+    if (Number.isNaN(t0) || Number.isNaN(t1)) continue;
+    if (Math.max(t0, t1) < viewport.time0 || Math.min(t0, t1) > timeEnd) continue;
+    visible.push(e);
+  }
+
+  const detailed = visible.length <= DETAILED_EDGE_LIMIT;
+  const satisfied = new Path2D();
+  const violated = new Path2D();
+  const satisfiedHeads = new Path2D();
+  const violatedHeads = new Path2D();
+  for (const e of visible) {
+    const from = rows.edgeFrom[e];
+    const to = rows.edgeTo[e];
+    const ok = bars.ends[from] <= bars.starts[to];
+    const path = ok ? satisfied : violated;
+    const x0 = xAt(viewport, bars.ends[from]);
+    const y0 = yAt(viewport, from) + rowHeight / 2;
+    const x1 = xAt(viewport, bars.starts[to]);
+    const y1 = yAt(viewport, to) + rowHeight / 2;
+    path.moveTo(x0, y0);
+    if (!detailed) {
+      path.lineTo(x1, y1);
+      continue;
+    }
+    const bend = Math.max(20, Math.abs(x1 - x0) / 2);
+    path.bezierCurveTo(x0 + bend, y0, x1 - bend, y1, x1 - 6, y1);
+    const heads = ok ? satisfiedHeads : violatedHeads;
+    heads.moveTo(x1, y1);
+    heads.lineTo(x1 - 7, y1 - 4);
+    heads.lineTo(x1 - 7, y1 + 4);
+    heads.closePath();
+  }
+
+  ctx.lineWidth = detailed ? 2 : 1;
+  ctx.globalAlpha = detailed ? 0.7 : 0.4;
+  ctx.strokeStyle = COLORS.satisfied;
+  ctx.stroke(satisfied);
+  ctx.strokeStyle = COLORS.violated;
+  ctx.stroke(violated);
+  ctx.globalAlpha = 0.9;
+  ctx.fillStyle = COLORS.satisfied;
+  ctx.fill(satisfiedHeads);
+  ctx.fillStyle = COLORS.violated;
+  ctx.fill(violatedHeads);
+  ctx.globalAlpha = 1;
+  ctx.lineWidth = 1;
+}
+
+// The smallest 1, 2 or 5 times a power of ten that keeps labels apart.
+function tickStep(unitWidth: number): number {
+  const minStep = MIN_TICK_SPACING / unitWidth;
+  let magnitude = 10 ** Math.floor(Math.log10(Math.max(minStep, 1)));
+  for (;;) {
+    for (const factor of [1, 2, 5]) {
+      if (factor * magnitude >= minStep) return factor * magnitude;
+    }
+    magnitude *= 10;
+  }
+}
@@ -61,9 +61,6 @@ export function extractProblemDefinition(
         const durationMatch = event.description.match(/duration (\d+)/);
         if (durationMatch) {
           task.duration = parseInt(durationMatch[1], 10);
-          console.log(
-            `Task definition: ${task.name} (${task.id}), duration=${task.duration}`,
-          );
         }
 
         // Extract dependencies
@@ -82,7 +79,15 @@ export function extractProblemDefinition(
       const taskId = event.taskId;
       if (!taskId) return;
 
-      // Extract resource demands from description
+      if (event.type === "start" && event.demands) {
+        const task = tasks.get(taskId);
+        if (task) {
+          task.resourceDemands = event.demands;
+        }
+        return;
+      }
+
+      // Older traces only carry the demands in the description
       // Format: "Task defined with duration X Resources: [d0, d1, d2, ...]"
       const resourceMatch = event.description.match(/Resources: \[(.*?)\]/);
       if (resourceMatch) {
@@ -147,85 +152,72 @@ export function extractProblemDefinition(
 export function extractOptimalSchedule(
   events: TaskEvent[],
 ): Map<string, { start: number; end: number }> {
-  // Get all task IDs
-  const taskIds = Array.from(
-    new Set(
-      events
-        .filter((e) => e.taskId && e.taskName !== "Solver")
-        .map((e) => e.taskId),
-    ),
-  );
-
+  const taskIds = new Set<string>();
   const schedule = new Map<string, { start: number; end: number }>();
 
-  // First, try to find "Final solution" events
-  taskIds.forEach((taskId) => {
-    const finalSolutionEvents = events.filter(
-      (e) =>
-        e.taskId === taskId &&
-        e.type === "start" &&
-        e.description?.includes("Final solution"),
-    );
-
-    if (finalSolutionEvents.length > 0) {
-      const event = finalSolutionEvents[finalSolutionEvents.length - 1];
-      if (event.startTime !== undefined && event.endTime !== undefined) {
-        schedule.set(taskId, {
-          start: event.startTime,
-          end: event.endTime,
-        });
-      }
+  // First, take the last "Final solution" event of each task
+  events.forEach((e) => {
+    if (!e.taskId || e.taskName === "Solver") return;
+    taskIds.add(e.taskId);
+    if (e.type === "start" && e.description?.includes("Final solution")) {
+      schedule.set(e.taskId, { start: e.startTime, end: e.endTime });
     }
   });
 
   // If we found all tasks in final solution, return it
-  if (schedule.size === taskIds.length) {
+  if (schedule.size === taskIds.size) {
     return schedule;
   }
 
-  // Otherwise, fall back to the original logic
-  const timestamps = Array.from(new Set(events.map((e) => e.timestamp))).sort(
-    (a, b) => a - b,
-  );
-
+  // Otherwise, replay the scheduling events in timestamp order and keep the
+  // complete schedule with the smallest makespan seen after any timestamp.
+  // The makespan of the partial schedule is maintained with a count of the
+  // tasks ending at each time, so the whole sweep stays near linear.
+  const order = events
+    .map((_, i) => i)
+    .sort((a, b) => events[a].timestamp - events[b].timestamp);
+  const current = new Map<string, { start: number; end: number }>();
+  const endCounts = new Map<number, number>();
+  let makespan = -Infinity;
   let bestSchedule: Map<string, { start: number; end: number }> = new Map();
   let bestMakespan = Infinity;
 
-  for (const timestamp of timestamps) {
-    const currentSchedule = new Map<string, { start: number; end: number }>();
-
-    const eventsUpToTimestamp = events.filter((e) => e.timestamp <= timestamp);
-
-    taskIds.forEach((taskId) => {
-      const taskEvents = eventsUpToTimestamp.filter(
-        (e) =>
-          e.taskId === taskId &&
-          e.type === "start" &&
-          !e.description?.startsWith("Task defined"),
-      );
-
-      if (taskEvents.length > 0) {
-        const latestEvent = taskEvents[taskEvents.length - 1];
-        if (
-          latestEvent.startTime !== undefined &&
-          latestEvent.endTime !== undefined
-        ) {
-          currentSchedule.set(taskId, {
-            start: latestEvent.startTime,
-            end: latestEvent.endTime,
-          });
+  order.forEach((index, k) => {
+    const e = events[index];
+    if (
+      taskIds.has(e.taskId) &&
+      e.type === "start" &&
+      !e.description?.startsWith("Task defined")
+    ) {
+      const previous = current.get(e.taskId);
+      if (previous) {
+        const count = endCounts.get(previous.end)! - 1;
+        if (count === 0) {
+          endCounts.delete(previous.end);
+        } else {
+          endCounts.set(previous.end, count);
         }
       }
-    });
-
-    if (currentSchedule.size === taskIds.length) {
-      const makespan = calculateMakespan(currentSchedule);
-      if (makespan < bestMakespan) {
-        bestMakespan = makespan;
-        bestSchedule = new Map(currentSchedule);
+      current.set(e.taskId, { start: e.startTime, end: e.endTime });
+      endCounts.set(e.endTime, (endCounts.get(e.endTime) ?? 0) + 1);
+      if (e.endTime >= makespan) {
+        makespan = e.endTime;
+      } else if (previous && previous.end === makespan && !endCounts.has(makespan)) {
+        makespan = Math.max(...endCounts.keys());
       }
     }
-  }
+
+    const lastAtTimestamp =
+      k + 1 === order.length || events[order[k + 1]].timestamp !== e.timestamp;
+    if (
+      lastAtTimestamp &&
+      current.size === taskIds.size &&
+      makespan < bestMakespan
+    ) {
+      bestMakespan = makespan;
+      bestSchedule = new Map(current);
+    }
+  });
 
   return bestSchedule;
 }
@@ -0,0 +1,173 @@
+import { upperBound } from "./timelineIndex";
+
+// Usage of one resource over time as a step function, with a min/max
+// pyramid so that any zoom level can be drawn with one pass over the pixel
+// columns instead of one over the time units.
+
+// Buckets of the finest pyramid level; coarser levels halve the count.
+const MAX_BASE_BUCKETS = 1 << 16;
+// Below this many breakpoints in view, columns are computed exactly.
+const EXACT_SCAN_LIMIT = 4096;
+
+export class ResourceProfile {
+  // Usage is values[i] on [times[i], times[i + 1]) and 0 before times[0]
+  // and from the last breakpoint on.
+  readonly times: Float64Array;
+  readonly values: Float64Array;
+  readonly peak: number;
+  private readonly horizon: number;
+  private readonly bucketWidth: number;
+  // levels[k] holds the min and max of each bucket of width
+  // bucketWidth * 2^k, over [0, horizon).
+  private readonly minLevels: Float64Array[] = [];
+  private readonly maxLevels: Float64Array[] = [];
+
+  constructor(intervals: Array<{ start: number; end: number; demand: number }>) {
+    const deltas = new Map<number, number>();
+    for (const { start, end, demand } of intervals) {
+      if (demand === 0 || !(end > start)) continue;
+      deltas.set(start, (deltas.get(start) ?? 0) + demand);
+      deltas.set(end, (deltas.get(end) ?? 0) - demand);
+    }
+    const points = Array.from(deltas.keys()).sort((a, b) => a - b);
+    this.times = new Float64Array(points.length);
+    this.values = new Float64Array(points.length);
+    let usage = 0;
+    let peak = 0;
+    points.forEach((time, i) => {
+      usage += deltas.get(time)!;
+      this.times[i] = time;
+      this.values[i] = usage;
+      peak = Math.max(peak, usage);
+    });
+    this.peak = peak;
+
+    this.horizon = points.length > 0 ? points[points.length - 1] : 0;
+    this.bucketWidth = Math.max(1, Math.ceil(this.horizon / MAX_BASE_BUCKETS));
+    this.buildPyramid();
+  }
+
+  // Usage at `time`.
+  valueAt(time: number): number {
+    const i = upperBound(this.times, time) - 1;
+    return i >= 0 ? this.values[i] : 0;
+  }
+
+  // Fills the min and max usage over each of `count` equal columns of
+  // [t0, t1).
+  columns(
+    t0: number,
+    t1: number,
+    count: number,
+    outMin: Float64Array,
+    outMax: Float64Array,
+  ): void {
+    const width = (t1 - t0) / count;
+    const first = upperBound(this.times, t0);
+    const last = upperBound(this.times, t1);
+    if (last - first <= EXACT_SCAN_LIMIT || width < this.bucketWidth) {
+      this.exactColumns(t0, width, count, first, outMin, outMax);
+      return;
+    }
+    // The coarsest level whose buckets still fit in a column.
+    let level = 0;
+    while (
+      level + 1 < this.maxLevels.length &&
+      this.bucketWidth * 2 ** (level + 1) <= width
+    ) {
+      level++;
+    }
+    const bucket = this.bucketWidth * 2 ** level;
+    const mins = this.minLevels[level];
+    const maxs = this.maxLevels[level];
+    for (let c = 0; c < count; c++) {
+      const from = t0 + c * width;
+      const to = from + width;
+      if (to <= 0 || from >= this.horizon) {
+        outMin[c] = 0;
+        outMax[c] = 0;
+        continue;
+      }
+      const b0 = Math.max(0, Math.floor(from / bucket));
+      const b1 = Math.min(maxs.length, Math.ceil(to / bucket));
+      let lo = Infinity;
+      let hi = -Infinity;
+      for (let b = b0; b < b1; b++) {
+        lo = Math.min(lo, mins[b]);
+        hi = Math.max(hi, maxs[b]);
+      }
+      // Columns reaching past the horizon also see the idle tail.
+      if (to > this.horizon || from < 0) lo = Math.min(lo, 0);
+      outMin[c] = lo === Infinity ? 0 : lo;
+      outMax[c] = hi === -Infinity ? 0 : hi;
+    }
+  }
+
+  private exactColumns(
+    t0: number,
+    width: number,
+    count: number,
+    first: number,
+    outMin: Float64Array,
+    outMax: Float64Array,
+  ): void {
+    let i = first;
+    let usage = first > 0 ? this.values[first - 1] : 0;
+    for (let c = 0; c < count; c++) {
+      const to = t0 + (c + 1) * width;
+      let lo = usage;
+      let hi = usage;
+      while (i < this.times.length && this.times[i] < to) {
+        usage = this.values[i++];
+        lo = Math.min(lo, usage);
+        hi = Math.max(hi, usage);
+      }
+      outMin[c] = lo;
+      outMax[c] = hi;
+    }
+  }
+
+  private buildPyramid(): void {
+    const buckets = Math.max(1, Math.ceil(this.horizon / this.bucketWidth));
+    const mins = new Float64Array(buckets).fill(Infinity);
+    const maxs = new Float64Array(buckets).fill(-Infinity);
+    // Each step [times[i], times[i + 1]) covers a run of buckets.
+    for (let i = 0; i + 1 < this.times.length; i++) {
+      const b0 = Math.floor(this.times[i] / this.bucketWidth);
+      const b1 = Math.ceil(this.times[i + 1] / this.bucketWidth);
+      const value = this.values[i];
+      for (let b = Math.max(0, b0); b < Math.min(buckets, b1); b++) {
+        if (value < mins[b]) mins[b] = value;
+        if (value > maxs[b]) maxs[b] = value;
+      }
+    }
+    // Buckets that no step reaches lie before the first breakpoint.
+    for (let b = 0; b < buckets; b++) {
+      if (mins[b] === Infinity) {
+        mins[b] = 0;
+        maxs[b] = 0;
+      }
+    }
+    // So does part of the bucket holding the first breakpoint.
+    if (this.times.length > 0 && this.times[0] > 0) {
+      const idle = Math.ceil(this.times[0] / this.bucketWidth);
+      for (let b = 0; b < Math.min(buckets, idle); b++) mins[b] = 0;
+    }
+    this.minLevels.push(mins);
+    this.maxLevels.push(maxs);
+    while (this.maxLevels[this.maxLevels.length - 1].length > 1) {
+      const prevMin = this.minLevels[this.minLevels.length - 1];
+      const prevMax = this.maxLevels[this.maxLevels.length - 1];
+      const size = Math.ceil(prevMax.length / 2);
+      const nextMin = new Float64Array(size);
+      const nextMax = new Float64Array(size);
+      for (let b = 0; b < size; b++) {
+        const right = Math.min(2 * b + 1, prevMax.length - 1);
+        nextMin[b] = Math.min(prevMin[2 * b], prevMin[right]);
+        nextMax[b] = Math.max(prevMax[2 * b], prevMax[right]);
+      }
+      this.minLevels.push(nextMin);
+      this.maxLevels.push(nextMax);
+    }
+  }
+}
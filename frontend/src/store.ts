@@ -9,13 +9,28 @@ import type {
   GameState,
   ConstraintViolation,
   InstanceMetadata,
+  RiskSummary,
+  SensitivitySummary,
 } from "./types";
-import { extractProblemDefinition } from "./problemExtractor";
+import {
+  extractProblemDefinition,
+  type ProblemDefinition,
+} from "./problemExtractor";
+import {
+  buildGanttRows,
+  type GanttRows,
+  type RiskBands,
+} from "./ganttRenderer";
+import { TimelineIndex, type BarState } from "./timelineIndex";
 import { validateSchedule as validateScheduleConstraints } from "./constraintValidator";
 
 interface TimelineStore extends TimelineState, GameState {
   currentInstance: InstanceMetadata | null;
+  sensitivity: SensitivitySummary | null;
+  risk: RiskSummary | null;
   loadEvents: (events: TaskEvent[]) => void;
+  setSensitivity: (sensitivity: SensitivitySummary | null) => void;
+  setRisk: (risk: RiskSummary | null) => void;
   setCurrentInstance: (instance: InstanceMetadata) => void;
   switchInstance: (instance: InstanceMetadata) => void;
   setCurrentTime: (time: number) => void;
@@ -23,6 +38,10 @@ interface TimelineStore extends TimelineState, GameState {
   setPlaybackSpeed: (speed: number) => void;
   reset: () => void;
   getTasksAtTime: (time: number) => Task[];
+  getGanttRows: () => GanttRows;
+  getBarsAtTime: (time: number) => BarState;
+  getCriticality: () => Float32Array | undefined;
+  getRiskBands: () => RiskBands | undefined;
   getSearchTreeAtTime: (time: number) => SearchTreeState;
   setViewMode: (mode: ViewMode) => void;
   getLatestEventAtTime: (time: number) => TaskEvent | null;
@@ -30,7 +49,7 @@ interface TimelineStore extends TimelineState, GameState {
   setUserSchedule: (taskId: string, start: number, end: number) => void;
   validateSchedule: () => ConstraintViolation[];
   resetGame: (mode: "clear" | "revert") => void;
-  getProblemDefinition: () => ReturnType<typeof extractProblemDefinition>;
+  getProblemDefinition: () => ProblemDefinition;
   getCurrentSchedule: () => Map<string, { start: number; end: number }>;
   getCurrentCost: () => number;
   isScheduleValid: () => boolean;
@@ -53,6 +72,88 @@ const initialState: TimelineState = {
   lastValidSchedule: new Map(),
 };
 
+// Everything derived from the loaded events alone. It is rebuilt once per
+// trace, so scrubbing and redraws only pay for lookups.
+interface TraceData {
+  events: TaskEvent[];
+  problem: ProblemDefinition;
+  rows: GanttRows;
+  timeline: TimelineIndex;
+}
+
+let traceData: TraceData | null = null;
+
+function getTraceData(events: TaskEvent[]): TraceData {
+  if (traceData === null || traceData.events !== events) {
+    const problem = extractProblemDefinition(events);
+    const rows = buildGanttRows(problem.tasks);
+    traceData = {
+      events,
+      problem,
+      rows,
+      timeline: new TimelineIndex(events, rows.rowOf, rows.ids.length),
+    };
+  }
+  return traceData;
+}
+
+// Criticality per Gantt row, NaN for tasks the analysis does not cover.
+let criticalityCache: {
+  rows: GanttRows;
+  sensitivity: SensitivitySummary;
+  values: Float32Array;
+} | null = null;
+
+function criticalityByRow(
+  rows: GanttRows,
+  sensitivity: SensitivitySummary,
+): Float32Array {
+  if (
+    criticalityCache === null ||
+    criticalityCache.rows !== rows ||
+    criticalityCache.sensitivity !== sensitivity
+  ) {
+    const values = new Float32Array(rows.ids.length).fill(NaN);
+    for (const task of sensitivity.tasks) {
+      const row = rows.rowOf.get(String(task.taskId));
+      if (row !== undefined) values[row] = task.criticality;
+    }
+    criticalityCache = { rows, sensitivity, values };
+  }
+  return criticalityCache.values;
+}
+
+// Finish percentiles per Gantt row, NaN for tasks the simulation does not
+// cover.
+let riskBandsCache: {
+  rows: GanttRows;
+  risk: RiskSummary;
+  bands: RiskBands;
+} | null = null;
+
+function riskBandsByRow(rows: GanttRows, risk: RiskSummary): RiskBands {
+  if (
+    riskBandsCache === null ||
+    riskBandsCache.rows !== rows ||
+    riskBandsCache.risk !== risk
+  ) {
+    const bands: RiskBands = {
+      finishP10: new Float32Array(rows.ids.length).fill(NaN),
+      finishP50: new Float32Array(rows.ids.length).fill(NaN),
+      finishP90: new Float32Array(rows.ids.length).fill(NaN),
+    };
+    for (const task of risk.tasks) {
+      const row = rows.rowOf.get(String(task.taskId));
+      if (row === undefined) continue;
+      bands.finishP10[row] = task.finishP10;
+      bands.finishP50[row] = task.finishP50;
+      bands.finishP90[row] = task.finishP90;
+    }
+    riskBandsCache = { rows, risk, bands };
+  }
+  return riskBandsCache.bands;
+}
+
 function calculateTreePositions(
   nodes: Map<string, SearchNode>,
   rootId: string,
@@ -113,11 +214,16 @@ function calculateTreePositions(
 export const useTimelineStore = create<TimelineStore>((set, get) => ({
   ...initialState,
   currentInstance: null,
+  sensitivity: null,
+  risk: null,
 
   loadEvents: (events) => {
-    const timestamps = events.map((e) => e.timestamp);
-    const minTime = Math.min(...timestamps);
-    const maxTime = Math.max(...timestamps);
+    let minTime = Infinity;
+    let maxTime = -Infinity;
+    for (const event of events) {
+      minTime = Math.min(minTime, event.timestamp);
+      maxTime = Math.max(maxTime, event.timestamp);
+    }
 
     set({
       events,
@@ -127,6 +233,10 @@ export const useTimelineStore = create<TimelineStore>((set, get) => ({
     });
   },
 
+  setSensitivity: (sensitivity) => set({ sensitivity }),
+
+  setRisk: (risk) => set({ risk }),
+
   setCurrentInstance: (instance) => {
     set({ currentInstance: instance });
   },
@@ -134,6 +244,8 @@ export const useTimelineStore = create<TimelineStore>((set, get) => ({
   switchInstance: (instance) => {
     set({
       currentInstance: instance,
+      sensitivity: null,
+      risk: null,
       events: [],
       tasks: [],
       currentTime: 0,
@@ -155,68 +267,58 @@ export const useTimelineStore = create<TimelineStore>((set, get) => ({
 
   setPlaybackSpeed: (speed) => set({ playbackSpeed: speed }),
 
-  reset: () => set({ ...initialState, currentInstance: null }),
+  reset: () =>
+    set({
+      ...initialState,
+      currentInstance: null,
+      sensitivity: null,
+      risk: null,
+    }),
 
   setViewMode: (mode) => set({ viewMode: mode }),
 
   getTasksAtTime: (time) => {
-    const { events } = get();
-    const taskMap = new Map<string, Task>();
-
-    const filteredEvents = events.filter((event) => event.timestamp <= time);
-
-    filteredEvents.forEach((event) => {
-      switch (event.type) {
-        case "assign":
-          taskMap.set(event.taskId, {
-            id: event.taskId,
-            name: event.taskName || event.taskId,
-            start: new Date(event.startTime || 0),
-            end: new Date(event.endTime || 0),
-            startTime: event.startTime || 0,
-            endTime: event.endTime || 0,
-            progress: 0,
-            resourceId: event.resourceId,
-          });
-          break;
-        case "remove":
-          taskMap.delete(event.taskId);
-          break;
-        case "start":
-          const startTask = taskMap.get(event.taskId);
-          if (startTask && event.startTime !== undefined) {
-            startTask.start = new Date(event.startTime);
-            startTask.startTime = event.startTime;
-            if (event.endTime !== undefined) {
-              startTask.end = new Date(event.endTime);
-              startTask.endTime = event.endTime;
-            }
-          }
-          break;
-        case "complete":
-          const completeTask = taskMap.get(event.taskId);
-          if (completeTask && event.endTime !== undefined) {
-            completeTask.end = new Date(event.endTime);
-            completeTask.endTime = event.endTime;
-            completeTask.progress = 100;
-          }
-          break;
-        case "modify":
-          const modifyTask = taskMap.get(event.taskId);
-          if (modifyTask && event.newValue) {
-            Object.assign(modifyTask, event.newValue);
-          }
-          break;
-      }
+    const { rows, timeline } = getTraceData(get().events);
+    const bars = timeline.barsAt(time);
+    const tasks: Task[] = [];
+    rows.ids.forEach((id, row) => {
+      const startTime = bars.starts[row];
+      if (Number.isNaN(startTime)) return;
+      const endTime = bars.ends[row];
+      tasks.push({
+        id,
+        name: rows.names[row] || id,
+        start: new Date(startTime),
+        end: new Date(endTime),
+        startTime,
+        endTime,
+        progress: 0,
+      });
     });
 
-    return Array.from(taskMap.values()).sort((a, b) => {
+    return tasks.sort((a, b) => {
       const aId = parseInt(a.id);
       const bId = parseInt(b.id);
       return aId - bId;
     });
   },
 
+  getGanttRows: () => getTraceData(get().events).rows,
+
+  getBarsAtTime: (time) => getTraceData(get().events).timeline.barsAt(time),
+
+  getCriticality: () => {
+    const { events, sensitivity } = get();
+    if (sensitivity === null) return undefined;
+    return criticalityByRow(getTraceData(events).rows, sensitivity);
+  },
+
+  getRiskBands: () => {
+    const { events, risk } = get();
+    if (risk === null) return undefined;
+    return riskBandsByRow(getTraceData(events).rows, risk);
+  },
+
   getSearchTreeAtTime: (time) => {
     const { events } = get();
     const nodes = new Map<string, SearchNode>();
@@ -298,10 +400,8 @@ export const useTimelineStore = create<TimelineStore>((set, get) => ({
 
   getLatestEventAtTime: (time) => {
     const { events } = get();
-    const eventsAtTime = events.filter((e) => e.timestamp === time);
-    return eventsAtTime.length > 0
-      ? eventsAtTime[eventsAtTime.length - 1]
-      : null;
+    const index = getTraceData(events).timeline.latestEventAt(time);
+    return index >= 0 ? events[index] : null;
   },
 
   setGameMode: (enabled) => {
@@ -333,18 +433,7 @@ export const useTimelineStore = create<TimelineStore>((set, get) => ({
   validateSchedule: () => {
     const state = get();
     const problem = state.getProblemDefinition();
-    console.log("=== VALIDATION DEBUG ===");
-    console.log(
-      "Problem tasks:",
-      problem.tasks.map((t) => ({
-        id: t.id,
-        name: t.name,
-        deps: t.dependencies,
-      })),
-    );
-    console.log("User schedule:", Object.fromEntries(state.userSchedule));
     const violations = validateScheduleConstraints(state.userSchedule, problem);
-    console.log("Violations found:", violations);
     const isValid = violations.length === 0;
     set({ constraintViolations: violations });
 
@@ -375,10 +464,7 @@ export const useTimelineStore = create<TimelineStore>((set, get) => ({
     }
   },
 
-  getProblemDefinition: () => {
-    const state = get();
-    return extractProblemDefinition(state.events);
-  },
+  getProblemDefinition: () => getTraceData(get().events).problem,
 
   getCurrentSchedule: () => {
     const state = get();
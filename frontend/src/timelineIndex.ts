@@ -0,0 +1,146 @@
+import type { TaskEvent } from "./types";
+
+// Task bars at a solver step, indexed by Gantt row. NaN while a task has no
+// bar at that step.
+export interface BarState {
+  starts: Float64Array;
+  ends: Float64Array;
+}
+
+const NO_EFFECT = 0;
+const ASSIGN = 1;
+const REMOVE = 2;
+const MOVE = 3;
+
+// Checkpoints of all bars are kept every `interval` events, so a lookup
+// replays at most one interval instead of the whole trace. The interval
+// grows with the trace so that checkpoints stay within about 32 MB.
+const MIN_CHECKPOINT_INTERVAL = 1024;
+const CHECKPOINT_BUDGET_BYTES = 32 * 1024 * 1024;
+
+// Replays the bar changes of a trace ("assign" places a bar, "remove" drops
+// it, "start" moves a placed bar) for fast scrubbing.
+export class TimelineIndex {
+  private readonly numRows: number;
+  // Position in the event list of each event, in timestamp order.
+  private readonly order: Int32Array;
+  private readonly timestamps: Float64Array;
+  private readonly rows: Int32Array;
+  private readonly effects: Uint8Array;
+  private readonly starts: Float64Array;
+  private readonly ends: Float64Array;
+  private readonly interval: number;
+  private readonly checkpoints: BarState[] = [];
+
+  constructor(events: TaskEvent[], rowOf: Map<string, number>, numRows: number) {
+    this.numRows = numRows;
+    // Traces are written in timestamp order; the stable sort only guards
+    // hand-edited files.
+    const order = events.map((_, i) => i);
+    order.sort((a, b) => events[a].timestamp - events[b].timestamp);
+    this.order = Int32Array.from(order);
+
+    const n = events.length;
+    this.timestamps = new Float64Array(n);
+    this.rows = new Int32Array(n);
+    this.effects = new Uint8Array(n);
+    this.starts = new Float64Array(n);
+    this.ends = new Float64Array(n);
+    order.forEach((eventIndex, i) => {
+      const event = events[eventIndex];
+      this.timestamps[i] = event.timestamp;
+      this.rows[i] = rowOf.get(event.taskId) ?? -1;
+      this.starts[i] = event.startTime;
+      this.ends[i] = event.endTime;
+      this.effects[i] =
+        event.type === "assign"
+          ? ASSIGN
+          : event.type === "remove"
+            ? REMOVE
+            : event.type === "start"
+              ? MOVE
+              : NO_EFFECT;
+    });
+
+    this.interval = Math.max(
+      MIN_CHECKPOINT_INTERVAL,
+      Math.ceil((n * numRows * 16) / CHECKPOINT_BUDGET_BYTES),
+    );
+    const state = this.emptyState();
+    this.checkpoints.push(copyState(state));
+    for (let i = 0; i < n; i++) {
+      this.apply(state, i);
+      if ((i + 1) % this.interval === 0) this.checkpoints.push(copyState(state));
+    }
+  }
+
+  // Bars after every event with a timestamp up to `time`.
+  barsAt(time: number): BarState {
+    const count = upperBound(this.timestamps, time);
+    const checkpoint = Math.min(
+      Math.floor(count / this.interval),
+      this.checkpoints.length - 1,
+    );
+    const state = copyState(this.checkpoints[checkpoint]);
+    for (let i = checkpoint * this.interval; i < count; i++) {
+      this.apply(state, i);
+    }
+    return state;
+  }
+
+  // Position in the event list of the last event stamped exactly `time`,
+  // or -1.
+  latestEventAt(time: number): number {
+    const count = upperBound(this.timestamps, time);
+    return count > 0 && this.timestamps[count - 1] === time
+      ? this.order[count - 1]
+      : -1;
+  }
+
+  private emptyState(): BarState {
+    return {
+      starts: new Float64Array(this.numRows).fill(NaN),
+      ends: new Float64Array(this.numRows).fill(NaN),
+    };
+  }
+
+  private apply(state: BarState, i: number): void {
+    const row = this.rows[i];
+    if (row < 0) return;
+    switch (this.effects[i]) {
+      case ASSIGN:
+        state.starts[row] = this.starts[i];
+        state.ends[row] = this.ends[i];
+        break;
+      case REMOVE:
+        state.starts[row] = NaN;
+        state.ends[row] = NaN;
+        break;
+      case MOVE:
+        if (!Number.isNaN(state.starts[row])) {
+          state.starts[row] = this.starts[i];
+          state.ends[row] = this.ends[i];
+        }
+        break;
+    }
+  }
+}
+
+function copyState(state: BarState): BarState {
+  return { starts: state.starts.slice(), ends: state.ends.slice() };
+}
+
+// Number of values <= `value` in a sorted array.
+export function upperBound(values: Float64Array, value: number): number {
+  let lo = 0;
+  let hi = values.length;
+  while (lo < hi) {
+    const mid = (lo + hi) >>> 1;
+    if (values[mid] <= value) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
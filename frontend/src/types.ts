@@ -1,25 +1,12 @@
-export type EventType = "assign" | "remove" | "start" | "complete" | "modify";
+import type { TaskEvent } from "./eventSchema.generated";
 
-export interface TaskEvent {
-  id: string;
-  type: EventType;
-  taskId: string;
-  taskName?: string;
-  timestamp: number;
-  startTime?: number;
-  endTime?: number;
-  resourceId?: string;
-  previousValue?: any;
-  newValue?: any;
-  decisionLevel?: number;
-  backtrackToLevel?: number;
-  nodeId?: string;
-  parentNodeId?: string;
-  nodeStatus?: "created" | "pruned" | "solution";
-  description?: string;
-  dependencies?: number[];
-  successors?: number[];
-}
+// Trace events are described by event_schema.h; see eventSchema.generated.ts.
+export type {
+  EventType,
+  NodeStatus,
+  Propagator,
+  TaskEvent,
+} from "./eventSchema.generated";
 
 export interface Task {
   id: string;
@@ -89,9 +76,75 @@ export interface GameState {
   lastValidSchedule: Map<string, { start: number; end: number }>;
 }
 
+// Written by rcpsp_simulate next to the events of the simulated schedule.
+// Times are in schedule units; finish percentiles give the risk band of
+// each task.
+export interface RiskSummary {
+  replays: number;
+  distribution: string;
+  nominalMakespan: number;
+  onTimeProbability: number;
+  makespan: {
+    mean: number;
+    std: number;
+    min: number;
+    max: number;
+    p5: number;
+    p10: number;
+    p25: number;
+    p50: number;
+    p75: number;
+    p90: number;
+    p95: number;
+    p99: number;
+  };
+  tasks: Array<{
+    taskId: number;
+    taskName: string;
+    criticality: number;
+    meanFinish: number;
+    finishP10: number;
+    finishP50: number;
+    finishP90: number;
+  }>;
+}
+
+// Written by `--sensitivity=K`: the makespan change for every change of a
+// task duration or resource capacity by +k and -k, ranked by size. A null
+// makespan means the changed instance is infeasible. Criticality is the
+// share of k by which a task's duration moves the makespan.
+export interface SensitivitySummary {
+  delta: number;
+  baseMakespan: number;
+  baseOptimal: boolean;
+  screened: number;
+  solved: number;
+  wallTime: number;
+  changes: Array<{
+    kind: "duration" | "capacity";
+    taskId?: number;
+    resourceId?: number;
+    change: number;
+    makespan: number | null;
+    delta: number | null;
+    method: "float" | "peak" | "bound" | "solved" | "infeasible";
+    exact: boolean;
+  }>;
+  tasks: Array<{
+    taskId: number;
+    taskName: string;
+    float: number;
+    increase: number;
+    decrease: number;
+    criticality: number;
+  }>;
+}
+
 export interface EventFile {
   version: string;
   events: TaskEvent[];
+  risk?: RiskSummary;
+  sensitivity?: SensitivitySummary;
   metadata?: {
     projectName?: string;
     totalTasks?: number;
@@ -0,0 +1,285 @@
+#ifndef INCUMBENT_STREAM_H_
+#define INCUMBENT_STREAM_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ortools/sat/sat_parameters.pb.h"
+
+// Stop policies shared by driver and rcpsp_solver. Every field is "off" by
+// default so the solver keeps its usual behaviour unless a flag is given.
+struct StopPolicy {
+  double time_limit_seconds = 0.0;   // 0: keep the binary's default limit
+  double relative_gap = 0.0;         // stop once (obj - bound) / obj <= gap
+  double stall_seconds = 0.0;        // stop after N seconds without improvement
+  int64_t target_makespan = -1;      // stop as soon as makespan <= target
+  std::string invalid_flag;          // last flag with a bad value, see Validate
+
+  // Parses one "--name=value" command line argument. Returns false if the
+  // argument is not a stop policy flag so callers can handle it themselves.
+  // A value that is not a non-negative number is remembered for Validate().
+  bool ParseFlag(const std::string& arg) {
+    const size_t eq = arg.find('=');
+    if (arg.rfind("--", 0) != 0 || eq == std::string::npos) return false;
+    const std::string name = arg.substr(2, eq - 2);
+    const char* value = arg.c_str() + eq + 1;
+    char* end = nullptr;
+    bool valid = false;
+    if (name == "target") {
+      target_makespan = std::strtoll(value, &end, 10);
+      valid = target_makespan >= 0;
+    } else {
+      const double number = std::strtod(value, &end);
+      valid = number >= 0.0 && std::isfinite(number);
+      if (name == "time_limit") {
+        time_limit_seconds = number;
+      } else if (name == "gap") {
+        relative_gap = number;
+      } else if (name == "stall") {
+        stall_seconds = number;
+      } else {
+        return false;
+      }
+    }
+    if (!valid || end == value || *end != '\0') invalid_flag = arg;
+    return true;
+  }
+
+  // Fails on the last flag whose value did not parse or was negative, rather
+  // than quietly turning its policy off.
+  bool Validate(std::string* error) const {
+    if (invalid_flag.empty()) return true;
+    *error = invalid_flag + ": expected a non-negative number";
+    return false;
+  }
+
+  // The time and gap limits are native CP-SAT parameters; the stall and target
+  // policies are enforced by IncumbentStream.
+  void ApplyTo(operations_research::sat::SatParameters* parameters) const {
+    if (time_limit_seconds > 0.0) {
+      parameters->set_max_time_in_seconds(time_limit_seconds);
+    }
+    if (relative_gap > 0.0) {
+      parameters->set_relative_gap_limit(relative_gap);
+    }
+  }
+};
+
+// One improving solution as seen by the solution observer.
+struct Incumbent {
+  int index;
+  double objective;
+  double best_bound;
+  double gap;
+  double wall_time;  // seconds since the stream was created
+  std::vector<int64_t> starts;
+
+  std::string ToJson() const {
+    std::ostringstream oss;
+    oss << "{\"type\":\"incumbent\",";
+    oss << "\"index\":" << index << ",";
+    oss << "\"objective\":" << objective << ",";
+    oss << "\"bestBound\":" << best_bound << ",";
+    oss << "\"gap\":" << gap << ",";
+    oss << "\"wallTime\":" << wall_time << ",";
+    oss << "\"starts\":[";
+    for (size_t i = 0; i < starts.size(); ++i) {
+      if (i > 0) oss << ",";
+      oss << starts[i];
+    }
+    oss << "]}";
+    return oss.str();
+  }
+
+  // The same without the schedule, for annotating timelines.
+  std::string ToJsonWithoutStarts() const {
+    std::ostringstream oss;
+    oss << "{\"index\":" << index << ",\"objective\":" << objective
+        << ",\"bestBound\":" << best_bound << ",\"gap\":" << gap << "}";
+    return oss.str();
+  }
+};
+
+// A proven lower bound on the objective, from outside the solve that finds
+// the incumbents (e.g. makespan probing).
+struct BoundUpdate {
+  double bound;
+  double wall_time;  // seconds since the stream was created
+
+  std::string ToJson() const {
+    std::ostringstream oss;
+    oss << "{\"type\":\"bound\",";
+    oss << "\"bestBound\":" << bound << ",";
+    oss << "\"wallTime\":" << wall_time << "}";
+    return oss.str();
+  }
+};
+
+// Collects improving solutions, prints them as JSON lines and decides when the
+// search is good enough. Solution callbacks may come from several workers, and
+// the stall policy runs on its own watchdog thread, so all state is guarded.
+class IncumbentStream {
+ public:
+  IncumbentStream(const StopPolicy& policy, std::function<void()> stop_search)
+      : policy_(policy),
+        stop_search_(std::move(stop_search)),
+        start_time_(std::chrono::steady_clock::now()),
+        last_improvement_(start_time_) {
+    if (policy_.stall_seconds > 0.0) {
+      watchdog_ = std::thread([this]() { WatchForStall(); });
+    }
+  }
+
+  ~IncumbentStream() { Finish(); }
+
+  // Whether incumbents and bounds are printed as they arrive; on by default.
+  // Batch runs turn it off and report one line per instance instead.
+  void set_echo(bool echo) { echo_ = echo; }
+
+  // Records a solution if it improves on the best one. Returns the recorded
+  // incumbent (valid until the next call), or nullptr when the solution is not
+  // an improvement.
+  const Incumbent* OnSolution(double objective, double best_bound,
+                              std::vector<int64_t> starts = {}) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!incumbents_.empty() && objective >= incumbents_.back().objective) {
+      return nullptr;
+    }
+    Incumbent incumbent;
+    incumbent.index = static_cast<int>(incumbents_.size()) + 1;
+    incumbent.objective = objective;
+    incumbent.best_bound = std::max(best_bound, known_bound_);
+    incumbent.gap = RelativeGap(objective, incumbent.best_bound);
+    incumbent.wall_time = ElapsedSeconds();
+    incumbent.starts = std::move(starts);
+    incumbents_.push_back(std::move(incumbent));
+    last_improvement_ = std::chrono::steady_clock::now();
+
+    const Incumbent& recorded = incumbents_.back();
+    if (echo_) std::cout << recorded.ToJson() << std::endl;
+
+    if (policy_.target_makespan >= 0 &&
+        recorded.objective <= static_cast<double>(policy_.target_makespan)) {
+      RequestStop("target");
+    } else if (policy_.relative_gap > 0.0 &&
+               recorded.gap <= policy_.relative_gap) {
+      RequestStop("gap");
+    }
+    stall_cv_.notify_all();
+    return &recorded;
+  }
+
+  // Records a proven lower bound. Later incumbents report at least this
+  // bound, and the gap policy may stop the search right away. Returns false
+  // if it does not improve on the best known bound.
+  bool OnBound(double bound) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (bound <= known_bound_) return false;
+    known_bound_ = bound;
+    bounds_.push_back({bound, ElapsedSeconds()});
+    if (echo_) std::cout << bounds_.back().ToJson() << std::endl;
+    if (!incumbents_.empty() && policy_.relative_gap > 0.0 &&
+        RelativeGap(incumbents_.back().objective, bound) <= policy_.relative_gap) {
+      RequestStop("gap");
+    }
+    return true;
+  }
+
+  // Stops the watchdog. Called once the solve returned.
+  void Finish() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      finished_ = true;
+    }
+    stall_cv_.notify_all();
+    if (watchdog_.joinable()) watchdog_.join();
+  }
+
+  // Records the final status so that a gap limit reached inside CP-SAT is
+  // reported like the policies enforced here.
+  void OnSolveFinished(double objective, double best_bound) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stop_reason_.empty() && policy_.relative_gap > 0.0 &&
+        RelativeGap(objective, std::max(best_bound, known_bound_)) <=
+            policy_.relative_gap) {
+      stop_reason_ = "gap";
+    }
+  }
+
+  // Only safe to read once the solve returned.
+  const std::vector<Incumbent>& incumbents() const { return incumbents_; }
+  const std::vector<BoundUpdate>& bounds() const { return bounds_; }
+
+  // "target", "gap", "stall", or empty when the solver stopped on its own.
+  std::string stop_reason() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stop_reason_;
+  }
+
+  double ElapsedSeconds() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start_time_)
+        .count();
+  }
+
+  static double RelativeGap(double objective, double best_bound) {
+    const double denominator = std::max(1.0, std::abs(objective));
+    return std::abs(objective - best_bound) / denominator;
+  }
+
+ private:
+  void RequestStop(const std::string& reason) {
+    if (!stop_reason_.empty()) return;
+    stop_reason_ = reason;
+    if (stop_search_) stop_search_();
+  }
+
+  void WatchForStall() {
+    const auto stall =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(policy_.stall_seconds));
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!finished_ && stop_reason_.empty()) {
+      // The stall clock only starts with the first incumbent; before that the
+      // time limit is the only thing that can end the search.
+      if (incumbents_.empty()) {
+        stall_cv_.wait(lock);
+        continue;
+      }
+      const auto deadline = last_improvement_ + stall;
+      if (stall_cv_.wait_until(lock, deadline) == std::cv_status::timeout &&
+          std::chrono::steady_clock::now() >= last_improvement_ + stall) {
+        RequestStop("stall");
+      }
+    }
+  }
+
+  const StopPolicy policy_;
+  const std::function<void()> stop_search_;
+  const std::chrono::steady_clock::time_point start_time_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable stall_cv_;
+  std::chrono::steady_clock::time_point last_improvement_;
+  std::vector<Incumbent> incumbents_;
+  std::vector<BoundUpdate> bounds_;
+  double known_bound_ = -std::numeric_limits<double>::infinity();
+  std::string stop_reason_;
+  bool finished_ = false;
+  bool echo_ = true;
+  std::thread watchdog_;
+};
+
+#endif  // INCUMBENT_STREAM_H_
@@ -0,0 +1,234 @@
+#ifndef INSTANCE_GENERATOR_H_
+#define INSTANCE_GENERATOR_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "rcpsp_instance.h"
+
+// ProGen-style synthetic RCPSP instances for scaling studies.
+//
+// The classic ProGen parameters are kept: network complexity (arcs per task),
+// resource factor (share of resources a task uses) and resource strength
+// (where each capacity lies between the largest single demand and the peak
+// demand of the earliest-start schedule). Unlike ProGen, arcs are drawn from a
+// sliding window over a fixed topological order and redundant arcs are not
+// removed, so generation stays linear in the size of the instance and a
+// million-task instance takes about a second.
+
+struct GeneratorParams {
+  int num_tasks = 30;
+  int num_resources = 4;
+  double network_complexity = 1.5;
+  double resource_factor = 0.5;
+  double resource_strength = 0.3;
+  int min_duration = 1;
+  int max_duration = 10;
+  int max_demand = 10;
+  // Predecessors are drawn from the previous `window` tasks; 0 uses sqrt(n).
+  int window = 0;
+  uint64_t seed = 1;
+
+  // Parses one "--name=value" generator flag. Returns false for any other
+  // argument.
+  bool ParseFlag(const std::string& arg) {
+    const size_t eq = arg.find('=');
+    if (arg.rfind("--", 0) != 0 || eq == std::string::npos) return false;
+    const std::string name = arg.substr(2, eq - 2);
+    const char* value = arg.c_str() + eq + 1;
+    if (name == "tasks") {
+      num_tasks = std::atoi(value);
+    } else if (name == "resources") {
+      num_resources = std::atoi(value);
+    } else if (name == "nc") {
+      network_complexity = std::atof(value);
+    } else if (name == "rf") {
+      resource_factor = std::atof(value);
+    } else if (name == "rs") {
+      resource_strength = std::atof(value);
+    } else if (name == "min_duration") {
+      min_duration = std::atoi(value);
+    } else if (name == "max_duration") {
+      max_duration = std::atoi(value);
+    } else if (name == "max_demand") {
+      max_demand = std::atoi(value);
+    } else if (name == "window") {
+      window = std::atoi(value);
+    } else if (name == "seed") {
+      seed = std::strtoull(value, nullptr, 10);
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  // Checks the parameters before GenerateInstance(), which assumes them. On
+  // failure, names the first bad one in `error`.
+  bool Validate(std::string* error) const {
+    if (num_tasks <= 0) {
+      *error = "--tasks must be positive";
+    } else if (num_resources < 0) {
+      *error = "--resources must not be negative";
+    } else if (!(network_complexity >= 0.0)) {
+      *error = "--nc must not be negative";
+    } else if (!(resource_factor >= 0.0 && resource_factor <= 1.0)) {
+      *error = "--rf must lie in [0, 1]";
+    } else if (!(resource_strength >= 0.0 && resource_strength <= 1.0)) {
+      *error = "--rs must lie in [0, 1]";
+    } else if (min_duration < 0) {
+      *error = "--min_duration must not be negative";
+    } else if (max_duration < min_duration) {
+      *error = "--max_duration must not be below --min_duration";
+    } else if (max_demand <= 0) {
+      *error = "--max_demand must be positive";
+    } else if (window < 0) {
+      *error = "--window must not be negative";
+    } else {
+      return true;
+    }
+    return false;
+  }
+};
+
+// SplitMix64: tiny, fast and identical on every platform, unlike the
+// distributions of <random>, so a seed always yields the same instance.
+class SplitMix64 {
+ public:
+  explicit SplitMix64(uint64_t seed) : state_(seed) {}
+
+  uint64_t Next() {
+    uint64_t z = (state_ += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+
+  // Uniform integer in [lo, hi].
+  int64_t Uniform(int64_t lo, int64_t hi) {
+    const uint64_t range = static_cast<uint64_t>(hi - lo) + 1;
+    return lo + static_cast<int64_t>(Next() % range);
+  }
+
+  // Uniform double in [0, 1).
+  double UniformDouble() { return (Next() >> 11) * (1.0 / 9007199254740992.0); }
+
+ private:
+  uint64_t state_;
+};
+
+// `params` must pass Validate().
+inline RCPSPInstance GenerateInstance(const GeneratorParams& params) {
+  SplitMix64 rng(params.seed);
+  const int n = std::max(1, params.num_tasks);
+  const int num_resources = std::max(0, params.num_resources);
+  const int window = params.window > 0
+                         ? params.window
+                         : std::max(2, static_cast<int>(std::sqrt(static_cast<double>(n))));
+
+  RCPSPInstance instance;
+  instance.tasks.resize(n);
+  instance.resources.resize(num_resources);
+  instance.horizon = 0;
+  for (int i = 0; i < n; ++i) {
+    Task& task = instance.tasks[i];
+    task.id = i;
+    task.name = "Task " + std::to_string(i);
+    task.duration = static_cast<int>(rng.Uniform(params.min_duration, params.max_duration));
+    instance.horizon += task.duration;
+  }
+
+  // Precedence network over the order 0..n-1. Arcs always point forward, so
+  // the network is acyclic by construction; a hash set rejects duplicates.
+  std::unordered_set<uint64_t> arcs;
+  arcs.reserve(static_cast<size_t>(params.network_complexity * n) + n);
+  auto add_arc = [&](int from, int to) {
+    if (from == to || !arcs.insert(static_cast<uint64_t>(from) * n + to).second) {
+      return false;
+    }
+    instance.tasks[from].successors.push_back(to);
+    return true;
+  };
+  // The first `window` tasks start the project; every other task gets one
+  // predecessor from the window before it...
+  for (int i = window; i < n; ++i) {
+    add_arc(static_cast<int>(rng.Uniform(i - window, i - 1)), i);
+  }
+  // ...and every task without a successor outside the last window gets one
+  // from the window after it.
+  for (int i = 0; i + window < n; ++i) {
+    if (instance.tasks[i].successors.empty()) {
+      add_arc(i, static_cast<int>(rng.Uniform(i + 1, i + window)));
+    }
+  }
+  // Extra random arcs until the requested network complexity is reached. The
+  // attempt budget keeps dense requests on short windows from spinning.
+  const int64_t target_arcs = static_cast<int64_t>(params.network_complexity * n);
+  for (int64_t attempts = 0;
+       static_cast<int64_t>(arcs.size()) < target_arcs && attempts < 4 * target_arcs && n > 1;
+       ++attempts) {
+    const int from = static_cast<int>(rng.Uniform(0, n - 2));
+    const int to = static_cast<int>(rng.Uniform(from + 1, std::min(n - 1, from + window)));
+    add_arc(from, to);
+  }
+
+  // Resource demands: each task uses each resource with probability RF and
+  // at least one resource whenever RF > 0.
+  for (Task& task : instance.tasks) {
+    task.resource_demands.assign(num_resources, 0);
+    if (num_resources == 0 || params.resource_factor <= 0.0) continue;
+    bool uses_any = false;
+    for (int r = 0; r < num_resources; ++r) {
+      if (rng.UniformDouble() < params.resource_factor) {
+        task.resource_demands[r] = static_cast<int>(rng.Uniform(1, params.max_demand));
+        uses_any = true;
+      }
+    }
+    if (!uses_any) {
+      task.resource_demands[rng.Uniform(0, num_resources - 1)] =
+          static_cast<int>(rng.Uniform(1, params.max_demand));
+    }
+  }
+
+  // Resource strength. Earliest starts follow the index order; the peak
+  // usage of that schedule comes from a difference array over its length,
+  // which keeps the whole generator linear.
+  std::vector<int64_t> earliest_start(n, 0);
+  int64_t length = 0;
+  for (int i = 0; i < n; ++i) {
+    const int64_t end = earliest_start[i] + instance.tasks[i].duration;
+    length = std::max(length, end);
+    for (int succ : instance.tasks[i].successors) {
+      earliest_start[succ] = std::max(earliest_start[succ], end);
+    }
+  }
+  std::vector<int64_t> usage(length + 1);
+  for (int r = 0; r < num_resources; ++r) {
+    std::fill(usage.begin(), usage.end(), 0);
+    int64_t largest_demand = 0;
+    for (int i = 0; i < n; ++i) {
+      const int demand = instance.tasks[i].resource_demands[r];
+      if (demand == 0 || instance.tasks[i].duration == 0) continue;
+      largest_demand = std::max<int64_t>(largest_demand, demand);
+      usage[earliest_start[i]] += demand;
+      usage[earliest_start[i] + instance.tasks[i].duration] -= demand;
+    }
+    int64_t peak = 0;
+    int64_t running = 0;
+    for (int64_t t = 0; t <= length; ++t) {
+      running += usage[t];
+      peak = std::max(peak, running);
+    }
+    instance.resources[r].capacity = static_cast<int>(
+        largest_demand +
+        std::llround(params.resource_strength * static_cast<double>(peak - largest_demand)));
+  }
+
+  return instance;
+}
+
+#endif  // INSTANCE_GENERATOR_H_
@@ -0,0 +1,30 @@
+#ifndef JSON_ESCAPE_H_
+#define JSON_ESCAPE_H_
+
+#include <string>
+#include <string_view>
+
+// `text` as the contents of a JSON string: quotes and backslashes are escaped
+// and control characters written as \u00XX, the same as EventWriter writes
+// strings into the trace. Task, project and instance names come from input
+// files and paths, so anything written between quotes goes through this.
+inline std::string JsonEscaped(std::string_view text) {
+  static constexpr char kHex[] = "0123456789abcdef";
+  std::string escaped;
+  escaped.reserve(text.size());
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+      escaped += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      escaped += "\\u00";
+      escaped += kHex[(c >> 4) & 0xf];
+      escaped += kHex[c & 0xf];
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+#endif  // JSON_ESCAPE_H_
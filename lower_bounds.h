@@ -0,0 +1,325 @@
+#ifndef LOWER_BOUNDS_H_
+#define LOWER_BOUNDS_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "incumbent_stream.h"
+#include "makespan_bounds.h"
+#include "model_strengthening.h"
+#include "ortools/sat/cp_model.h"
+#include "ortools/sat/cp_model_solver.h"
+#include "ortools/sat/sat_parameters.pb.h"
+#include "parallel_for.h"
+#include "rcpsp_instance.h"
+#include "schedule_network.h"
+
+// Destructive lower bounds for the makespan.
+//
+// A probe asks whether any schedule ends by a deadline T. The deadline gives
+// every task a time window: it starts no earlier than its longest path from
+// the sources and no later than T minus its longest path to the sinks. An
+// empty window or compulsory parts that overload a resource refute T at once;
+// otherwise a feasibility-only CP-SAT solve with a short time limit finds a
+// schedule, proves that none exists, or gives up. Refuting T proves that the
+// makespan is at least T + 1.
+//
+// Probes run in rounds, one per thread, spread evenly over the open range
+// [lower bound, best makespan - 1]. A refutation raises the lower bound, a
+// schedule lowers the best makespan, and a probe that gives up caps the next
+// round's range below its deadline, since larger deadlines are only harder
+// to refute. A round that proves nothing doubles the probe time limit.
+
+struct ProbeOptions {
+  double time_limit = 0.0;  // for all probing; 0: no probing
+  double probe_time_limit = 0.5;
+  int num_threads = 0;  // 0: one per hardware thread
+
+  bool enabled() const { return time_limit > 0.0; }
+
+  // Parses "--probe=S", "--probe_time_limit=S" and "--probe_threads=N".
+  // Returns false for any other argument.
+  bool ParseFlag(const std::string& arg) {
+    const size_t eq = arg.find('=');
+    if (arg.rfind("--", 0) != 0 || eq == std::string::npos) return false;
+    const std::string name = arg.substr(2, eq - 2);
+    const char* value = arg.c_str() + eq + 1;
+    if (name == "probe") {
+      time_limit = std::atof(value);
+    } else if (name == "probe_time_limit") {
+      probe_time_limit = std::atof(value);
+    } else if (name == "probe_threads") {
+      num_threads = std::atoi(value);
+    } else {
+      return false;
+    }
+    return true;
+  }
+};
+
+struct ProbeResult {
+  int64_t lower_bound = 0;
+  int64_t upper_bound = 0;  // makespan of `starts`
+  std::vector<int64_t> starts;
+  int rounds = 0;
+  int probes = 0;
+  int refuted_by_windows = 0;
+  int refuted_by_solver = 0;
+  int feasible = 0;
+  int unknown = 0;
+  // A task demands more than a capacity, so no deadline was probed and
+  // neither bound was computed.
+  bool infeasible = false;
+
+  bool optimal() const { return lower_bound >= upper_bound; }
+
+  std::string Summary() const {
+    if (infeasible) return "no schedule exists, a task demands more than a capacity";
+    std::ostringstream oss;
+    oss << "makespan in [" << lower_bound << ", " << upper_bound << "] after "
+        << probes << " probes in " << rounds << " rounds (" << refuted_by_windows
+        << " refuted by time windows, " << refuted_by_solver << " by CP-SAT, "
+        << feasible << " feasible, " << unknown << " unknown)";
+    return oss.str();
+  }
+
+  std::string ToJson() const {
+    std::ostringstream oss;
+    oss << "{\"lowerBound\": " << lower_bound << ", \"upperBound\": " << upper_bound
+        << ", \"rounds\": " << rounds << ", \"probes\": " << probes
+        << ", \"refutedByWindows\": " << refuted_by_windows
+        << ", \"refutedBySolver\": " << refuted_by_solver
+        << ", \"feasible\": " << feasible << ", \"unknown\": " << unknown
+        << ", \"infeasible\": " << (infeasible ? "true" : "false") << "}";
+    return oss.str();
+  }
+};
+
+namespace probing_internal {
+
+enum class ProbeOutcome { kRefutedByWindows, kRefutedBySolver, kFeasible, kUnknown };
+
+// Whether the compulsory parts of the tasks under the deadline, the part of
+// a task's window it occupies wherever it starts, overload a resource.
+inline bool CompulsoryPartsOverload(const RCPSPInstance& instance,
+                                    const std::vector<int64_t>& heads,
+                                    const std::vector<int64_t>& tails,
+                                    int64_t deadline) {
+  std::vector<std::pair<int64_t, int>> events;
+  for (size_t r = 0; r < instance.resources.size(); ++r) {
+    events.clear();
+    for (size_t i = 0; i < instance.tasks.size(); ++i) {
+      const int demand = instance.tasks[i].resource_demands[r];
+      const int64_t latest_start = deadline - tails[i];
+      const int64_t earliest_end = heads[i] + instance.tasks[i].duration;
+      if (demand == 0 || latest_start >= earliest_end) continue;
+      events.push_back({latest_start, demand});
+      events.push_back({earliest_end, -demand});
+    }
+    // Releases sort before acquisitions at the same time.
+    std::sort(events.begin(), events.end());
+    int64_t usage = 0;
+    for (const auto& event : events) {
+      usage += event.second;
+      if (usage > instance.resources[r].capacity) return true;
+    }
+  }
+  return false;
+}
+
+// Tests one deadline. On kFeasible, *starts holds a schedule that ends by it.
+inline ProbeOutcome Probe(const RCPSPInstance& instance, const StrengtheningPlan& plan,
+                          const std::vector<int64_t>& heads,
+                          const std::vector<int64_t>& tails, int64_t deadline,
+                          double time_limit, std::vector<int64_t>* starts) {
+  using namespace operations_research;
+  using namespace operations_research::sat;
+  const int n = static_cast<int>(instance.tasks.size());
+  for (int i = 0; i < n; ++i) {
+    if (heads[i] + tails[i] > deadline) return ProbeOutcome::kRefutedByWindows;
+  }
+  if (CompulsoryPartsOverload(instance, heads, tails, deadline)) {
+    return ProbeOutcome::kRefutedByWindows;
+  }
+
+  CpModelBuilder model;
+  std::vector<IntVar> start_vars;
+  std::vector<IntervalVar> intervals;
+  std::vector<LinearExpr> ends;
+  for (int i = 0; i < n; ++i) {
+    const IntVar start = model.NewIntVar(Domain(heads[i], deadline - tails[i]));
+    start_vars.push_back(start);
+    intervals.push_back(model.NewFixedSizeIntervalVar(start, instance.tasks[i].duration));
+    ends.push_back(intervals.back().EndExpr());
+  }
+  for (int i = 0; i < n; ++i) {
+    for (int succ : instance.tasks[i].successors) {
+      model.AddLessOrEqual(intervals[i].EndExpr(), intervals[succ].StartExpr());
+    }
+  }
+  for (size_t r = 0; r < instance.resources.size(); ++r) {
+    if (plan.IsUnary(static_cast<int>(r))) continue;
+    CumulativeConstraint cumulative = model.AddCumulative(instance.resources[r].capacity);
+    for (int i = 0; i < n; ++i) {
+      const int demand = instance.tasks[i].resource_demands[r];
+      if (demand > 0) cumulative.AddDemand(intervals[i], demand);
+    }
+  }
+  // No objective: the first schedule answers the probe.
+  const IntVar makespan = model.NewIntVar(Domain(0, deadline));
+  model.AddMaxEquality(makespan, ends);
+  ApplyStrengthening(plan, intervals, makespan, &model);
+
+  SatParameters parameters;
+  parameters.set_max_time_in_seconds(time_limit);
+  parameters.set_num_workers(1);
+  const CpSolverResponse response = SolveWithParameters(model.Build(), parameters);
+  if (response.status() == CpSolverStatus::INFEASIBLE) {
+    return ProbeOutcome::kRefutedBySolver;
+  }
+  if (response.status() != CpSolverStatus::OPTIMAL &&
+      response.status() != CpSolverStatus::FEASIBLE) {
+    return ProbeOutcome::kUnknown;
+  }
+  starts->clear();
+  for (const IntVar& start : start_vars) {
+    starts->push_back(SolutionIntegerValue(response, start));
+  }
+  return ProbeOutcome::kFeasible;
+}
+
+}  // namespace probing_internal
+
+// Bounds the makespan by probing deadlines for up to options.time_limit
+// seconds. Every raised lower bound and every improving schedule is reported
+// to `incumbents` when it is not null, and `on_bound` is called with each
+// raised lower bound when it is set. Probing stops early once the bounds meet
+// or the stream has stopped the search.
+inline ProbeResult ProbeMakespan(const RCPSPInstance& instance,
+                                 const ProbeOptions& options,
+                                 IncumbentStream* incumbents,
+                                 const std::function<void(int64_t)>& on_bound = {}) {
+  using namespace probing_internal;
+  ProbeResult result;
+  // No task would fit the list schedule, and no deadline could be decided;
+  // the main solve proves infeasibility on its own.
+  std::string error;
+  if (!DemandsFitCapacities(instance, &error)) {
+    result.infeasible = true;
+    return result;
+  }
+  const auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                            std::chrono::duration<double>(options.time_limit));
+  const int num_threads =
+      options.num_threads > 0
+          ? options.num_threads
+          : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  const int n = static_cast<int>(instance.tasks.size());
+
+  StrengtheningOptions analysis;
+  analysis.enabled = true;
+  const StrengtheningPlan plan = AnalyzeInstance(instance, analysis);
+  std::vector<int64_t> heads;
+  std::vector<int64_t> tails;
+  ComputeHeadsAndTails(instance, &heads, &tails);
+
+  auto raise_lower_bound = [&](int64_t bound) {
+    if (bound <= result.lower_bound) return;
+    result.lower_bound = bound;
+    if (incumbents != nullptr) incumbents->OnBound(static_cast<double>(bound));
+    if (on_bound) on_bound(bound);
+  };
+  auto offer_schedule = [&](std::vector<int64_t> starts) {
+    int64_t makespan = 0;
+    for (int i = 0; i < n; ++i) {
+      makespan = std::max(makespan, starts[i] + instance.tasks[i].duration);
+    }
+    if (!result.starts.empty() && makespan >= result.upper_bound) return;
+    result.upper_bound = makespan;
+    result.starts = std::move(starts);
+    if (incumbents != nullptr) {
+      incumbents->OnSolution(static_cast<double>(makespan),
+                             static_cast<double>(result.lower_bound), result.starts);
+    }
+  };
+
+  // The static bound, and a latest-finish-time list schedule to probe under.
+  raise_lower_bound(plan.MakespanLowerBound());
+  std::vector<int> priority = TopologicalOrder(instance);
+  std::stable_sort(priority.begin(), priority.end(),
+                   [&](int a, int b) { return tails[a] > tails[b]; });
+  offer_schedule(SerialSchedule(instance, priority));
+
+  auto stopped = [&]() {
+    return std::chrono::steady_clock::now() >= deadline ||
+           (incumbents != nullptr && !incumbents->stop_reason().empty());
+  };
+  double probe_time_limit = options.probe_time_limit;
+  int64_t cap = result.upper_bound;
+  while (!result.optimal() && !stopped()) {
+    const int64_t lo = result.lower_bound;
+    const int64_t hi = std::min(cap, result.upper_bound);
+    if (lo >= hi) {
+      // Every deadline left is beyond one that could not be decided.
+      probe_time_limit *= 2;
+      cap = result.upper_bound;
+      continue;
+    }
+    const int64_t range = hi - lo;
+    const int count = static_cast<int>(std::min<int64_t>(num_threads, range));
+    std::vector<int64_t> deadlines(count);
+    for (int j = 0; j < count; ++j) deadlines[j] = lo + range * j / count;
+    const double remaining =
+        std::chrono::duration<double>(deadline - std::chrono::steady_clock::now()).count();
+    const double time_limit = std::max(0.0, std::min(probe_time_limit, remaining));
+
+    std::vector<ProbeOutcome> outcomes(count);
+    std::vector<std::vector<int64_t>> schedules(count);
+    ParallelFor(count, count, [&](int j) {
+      outcomes[j] = Probe(instance, plan, heads, tails, deadlines[j], time_limit,
+                          &schedules[j]);
+    });
+
+    ++result.rounds;
+    result.probes += count;
+    const int64_t previous_lower = result.lower_bound;
+    const int64_t previous_upper = result.upper_bound;
+    for (int j = 0; j < count; ++j) {
+      switch (outcomes[j]) {
+        case ProbeOutcome::kRefutedByWindows:
+          ++result.refuted_by_windows;
+          raise_lower_bound(deadlines[j] + 1);
+          break;
+        case ProbeOutcome::kRefutedBySolver:
+          ++result.refuted_by_solver;
+          raise_lower_bound(deadlines[j] + 1);
+          break;
+        case ProbeOutcome::kFeasible:
+          ++result.feasible;
+          offer_schedule(std::move(schedules[j]));
+          break;
+        case ProbeOutcome::kUnknown:
+          ++result.unknown;
+          cap = std::min(cap, deadlines[j]);
+          break;
+      }
+    }
+    if (result.lower_bound == previous_lower && result.upper_bound == previous_upper) {
+      probe_time_limit *= 2;
+      cap = result.upper_bound;
+    }
+  }
+  return result;
+}
+
+#endif  // LOWER_BOUNDS_H_
@@ -0,0 +1,103 @@
+#ifndef MAKESPAN_BOUNDS_H_
+#define MAKESPAN_BOUNDS_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "rcpsp_instance.h"
+
+// Static lower bounds on the makespan, from the instance data alone. Model
+// strengthening adds them to the model; probing, decomposition, portfolio
+// coordination and sensitivity analysis start from them.
+
+// Longest paths from the sources to each start (heads) and from each start
+// to the sinks, the task's own duration included (tails).
+inline void ComputeHeadsAndTails(const RCPSPInstance& instance,
+                                 std::vector<int64_t>* heads,
+                                 std::vector<int64_t>* tails) {
+  const int n = static_cast<int>(instance.tasks.size());
+  const std::vector<int> order = TopologicalOrder(instance);
+  heads->assign(n, 0);
+  tails->assign(n, 0);
+  for (int i : order) {
+    for (int succ : instance.tasks[i].successors) {
+      (*heads)[succ] = std::max((*heads)[succ], (*heads)[i] + instance.tasks[i].duration);
+    }
+  }
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    int64_t after = 0;
+    for (int succ : instance.tasks[*it].successors) after = std::max(after, (*tails)[succ]);
+    (*tails)[*it] = instance.tasks[*it].duration + after;
+  }
+}
+
+// Length of the longest duration-weighted path.
+inline int64_t CriticalPathLength(const RCPSPInstance& instance) {
+  std::vector<int64_t> heads;
+  std::vector<int64_t> tails;
+  ComputeHeadsAndTails(instance, &heads, &tails);
+  int64_t length = 0;
+  for (size_t i = 0; i < heads.size(); ++i) length = std::max(length, heads[i] + tails[i]);
+  return length;
+}
+
+// Energetic bound over time windows. A task cannot start before its head and
+// must leave the rest of its tail, the longest path from its end to the
+// sinks, before the makespan. So for any head a and rest of tail b, the tasks
+// with head >= a and rest >= b run inside [a, makespan - b), and
+// makespan >= a + b + ceil(energy / capacity) on every resource. With
+// a = b = 0 this is the plain energy bound; unlike it, the windows combine
+// precedences and capacities, which no single constraint of the model does.
+// Every head is tried only if `all_heads`, since that is quadratic; otherwise
+// a = 0 and the bound takes O(n log n) per resource.
+inline int64_t EnergyLowerBound(const RCPSPInstance& instance, bool all_heads) {
+  const int n = static_cast<int>(instance.tasks.size());
+  std::vector<int64_t> heads;
+  std::vector<int64_t> rest;
+  ComputeHeadsAndTails(instance, &heads, &rest);
+  for (int i = 0; i < n; ++i) rest[i] -= instance.tasks[i].duration;
+
+  int64_t bound = 0;
+  std::vector<int> users;
+  std::vector<int64_t> window_heads;
+  for (size_t r = 0; r < instance.resources.size(); ++r) {
+    const int64_t capacity = instance.resources[r].capacity;
+    if (capacity <= 0) continue;
+    users.clear();
+    window_heads.assign(1, 0);
+    for (int i = 0; i < n; ++i) {
+      if (instance.tasks[i].resource_demands[r] == 0 || instance.tasks[i].duration == 0) {
+        continue;
+      }
+      users.push_back(i);
+      if (all_heads) window_heads.push_back(heads[i]);
+    }
+    std::sort(users.begin(), users.end(), [&rest](int a, int b) { return rest[a] > rest[b]; });
+    std::sort(window_heads.begin(), window_heads.end());
+    window_heads.erase(std::unique(window_heads.begin(), window_heads.end()), window_heads.end());
+    // Walking the users by decreasing rest adds them to the window in the
+    // order the threshold b admits them.
+    for (int64_t a : window_heads) {
+      int64_t energy = 0;
+      for (size_t k = 0; k < users.size(); ++k) {
+        const Task& task = instance.tasks[users[k]];
+        if (heads[users[k]] >= a) {
+          energy += static_cast<int64_t>(task.duration) * task.resource_demands[r];
+        }
+        const int64_t b = rest[users[k]];
+        if (energy > 0 && (k + 1 == users.size() || rest[users[k + 1]] < b)) {
+          bound = std::max(bound, a + b + (energy + capacity - 1) / capacity);
+        }
+      }
+    }
+  }
+  return bound;
+}
+
+// The larger of the critical path and the energy bound.
+inline int64_t MakespanLowerBound(const RCPSPInstance& instance, bool all_heads = false) {
+  return std::max(CriticalPathLength(instance), EnergyLowerBound(instance, all_heads));
+}
+
+#endif  // MAKESPAN_BOUNDS_H_
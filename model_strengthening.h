@@ -0,0 +1,356 @@
+#ifndef MODEL_STRENGTHENING_H_
+#define MODEL_STRENGTHENING_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "makespan_bounds.h"
+#include "ortools/sat/cp_model.h"
+#include "rcpsp_instance.h"
+
+// Model strengthening stage between RCPSPInstance and CpModelBuilder.
+//
+// The analysis only looks at the instance data and produces a plan; applying
+// the plan adds no-overlap constraints for disjunctive task sets, a redundant
+// cumulative over precedence chains, makespan lower bounds and, for small
+// instances, one clause per minimal forbidden set. Builders skip the cumulative of every resource the
+// plan marks as unary since its no-overlap replaces it.
+
+struct StrengtheningOptions {
+  bool enabled = false;
+  bool forbidden_sets = false;
+  // Above these sizes the quadratic parts of the analysis are skipped.
+  int max_clique_tasks = 2000;
+  int max_forbidden_set_tasks = 40;
+  int max_forbidden_set_size = 4;
+  int max_forbidden_sets = 500;
+
+  // Parses "--strengthen[=0|1]" and "--forbidden_sets[=0|1]". Returns false
+  // for any other argument.
+  bool ParseFlag(const std::string& arg) {
+    if (arg == "--strengthen" || arg == "--strengthen=1") {
+      enabled = true;
+    } else if (arg == "--strengthen=0") {
+      enabled = false;
+    } else if (arg == "--forbidden_sets" || arg == "--forbidden_sets=1") {
+      enabled = true;
+      forbidden_sets = true;
+    } else if (arg == "--forbidden_sets=0") {
+      forbidden_sets = false;
+    } else {
+      return false;
+    }
+    return true;
+  }
+};
+
+struct RedundantCumulative {
+  std::string reason;
+  std::vector<int64_t> demands;  // per task, 0 if the task is not part of it
+  int64_t capacity;
+};
+
+struct StrengtheningPlan {
+  // Resources whose tasks are pairwise incompatible; their cumulative is
+  // replaced by a no-overlap over disjunctive_sets[unary_set[r]].
+  std::vector<int> unary_set;
+  std::vector<std::vector<int>> disjunctive_sets;
+  std::vector<RedundantCumulative> redundant_cumulatives;
+  std::vector<std::vector<int>> forbidden_sets;
+  int64_t critical_path_bound = 0;
+  int64_t energy_bound = 0;
+
+  bool IsUnary(int resource) const {
+    return !unary_set.empty() && unary_set[resource] >= 0;
+  }
+
+  int64_t MakespanLowerBound() const {
+    return std::max(critical_path_bound, energy_bound);
+  }
+
+  std::string Summary() const {
+    int unary = 0;
+    for (int set : unary_set) unary += set >= 0 ? 1 : 0;
+    std::ostringstream oss;
+    oss << unary << " unary resources, " << disjunctive_sets.size()
+        << " no-overlap sets, " << redundant_cumulatives.size()
+        << " redundant cumulatives, " << forbidden_sets.size()
+        << " forbidden sets, makespan >= " << MakespanLowerBound();
+    return oss.str();
+  }
+};
+
+namespace strengthening_internal {
+
+inline bool Incompatible(const RCPSPInstance& instance, int a, int b) {
+  for (size_t r = 0; r < instance.resources.size(); ++r) {
+    if (instance.tasks[a].resource_demands[r] +
+            instance.tasks[b].resource_demands[r] >
+        instance.resources[r].capacity) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// reachable[i][j]: j is a (transitive) successor of i. Only for small n.
+inline std::vector<std::vector<bool>> TransitiveClosure(
+    const RCPSPInstance& instance, const std::vector<int>& order) {
+  const size_t n = instance.tasks.size();
+  std::vector<std::vector<bool>> reachable(n, std::vector<bool>(n, false));
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    for (int succ : instance.tasks[*it].successors) {
+      reachable[*it][succ] = true;
+      for (size_t j = 0; j < n; ++j) {
+        if (reachable[succ][j]) reachable[*it][j] = true;
+      }
+    }
+  }
+  return reachable;
+}
+
+}  // namespace strengthening_internal
+
+inline StrengtheningPlan AnalyzeInstance(const RCPSPInstance& instance,
+                                         const StrengtheningOptions& options) {
+  using namespace strengthening_internal;
+  StrengtheningPlan plan;
+  const int n = static_cast<int>(instance.tasks.size());
+  const int num_resources = static_cast<int>(instance.resources.size());
+  const std::vector<int> order = TopologicalOrder(instance);
+
+  // Lower bounds: longest path, and per resource the energy of the tasks
+  // whose time windows share a head and a tail.
+  plan.critical_path_bound = CriticalPathLength(instance);
+  plan.energy_bound = EnergyLowerBound(instance, n <= options.max_clique_tasks);
+
+  // Per resource, tasks demanding more than half the capacity are pairwise
+  // incompatible. If that is every task on the resource, it is unary. A task
+  // demanding more than the whole capacity makes the instance infeasible,
+  // which only the cumulative states, so its resource is never unary.
+  plan.unary_set.assign(num_resources, -1);
+  for (int r = 0; r < num_resources; ++r) {
+    const int capacity = instance.resources[r].capacity;
+    std::vector<int> large;
+    int users = 0;
+    bool overloaded = false;
+    for (int i = 0; i < n; ++i) {
+      const int demand = instance.tasks[i].resource_demands[r];
+      if (demand == 0 || instance.tasks[i].duration == 0) continue;
+      ++users;
+      if (2 * demand > capacity) large.push_back(i);
+      if (demand > capacity) overloaded = true;
+    }
+    if (large.size() < 2) continue;
+    if (static_cast<int>(large.size()) == users && !overloaded) {
+      plan.unary_set[r] = static_cast<int>(plan.disjunctive_sets.size());
+    }
+    plan.disjunctive_sets.push_back(std::move(large));
+  }
+
+  // Across resources: greedy maximal cliques of the demand-incompatibility
+  // graph, seeded with the tasks that use the most of their resources.
+  if (n <= options.max_clique_tasks && num_resources > 1) {
+    std::vector<double> load(n, 0.0);
+    for (int i = 0; i < n; ++i) {
+      for (int r = 0; r < num_resources; ++r) {
+        if (instance.resources[r].capacity > 0) {
+          load[i] = std::max(load[i], static_cast<double>(instance.tasks[i].resource_demands[r]) /
+                                          instance.resources[r].capacity);
+        }
+      }
+    }
+    std::vector<int> by_load;
+    for (int i = 0; i < n; ++i) {
+      if (instance.tasks[i].duration > 0) by_load.push_back(i);
+    }
+    std::stable_sort(by_load.begin(), by_load.end(),
+                     [&load](int a, int b) { return load[a] > load[b]; });
+    std::vector<bool> covered(n, false);
+    const size_t max_cliques = 64;
+    size_t added = 0;
+    for (int seed : by_load) {
+      if (covered[seed] || added >= max_cliques) continue;
+      std::vector<int> clique = {seed};
+      for (int candidate : by_load) {
+        if (candidate == seed) continue;
+        bool fits = true;
+        for (int member : clique) {
+          if (!Incompatible(instance, candidate, member)) {
+            fits = false;
+            break;
+          }
+        }
+        if (fits) clique.push_back(candidate);
+      }
+      for (int member : clique) covered[member] = true;
+      if (clique.size() < 3) continue;
+      // Skip cliques already implied by a single resource.
+      std::sort(clique.begin(), clique.end());
+      bool redundant = false;
+      for (const std::vector<int>& set : plan.disjunctive_sets) {
+        if (std::includes(set.begin(), set.end(), clique.begin(), clique.end())) {
+          redundant = true;
+          break;
+        }
+      }
+      if (redundant) continue;
+      plan.disjunctive_sets.push_back(std::move(clique));
+      ++added;
+    }
+  }
+
+  // Precedence-implied cumulative: tasks on one precedence chain never
+  // overlap, so at most (number of chains) tasks run at once. Any chain cover
+  // is an upper bound on the widest antichain; a greedy one is linear.
+  {
+    const std::vector<std::vector<int>> predecessors = ComputePredecessors(instance);
+    std::vector<int> chain_of(n, -1);
+    std::vector<int> chain_tail;
+    for (int i : order) {
+      for (int pred : predecessors[i]) {
+        if (chain_tail[chain_of[pred]] == pred) {
+          chain_of[i] = chain_of[pred];
+          break;
+        }
+      }
+      if (chain_of[i] < 0) {
+        chain_of[i] = static_cast<int>(chain_tail.size());
+        chain_tail.push_back(i);
+      }
+      chain_tail[chain_of[i]] = i;
+    }
+    const int64_t chains = static_cast<int64_t>(chain_tail.size());
+    if (chains >= 2 && 2 * chains <= n) {
+      RedundantCumulative cumulative;
+      cumulative.reason = "precedence chains";
+      cumulative.demands.assign(n, 0);
+      for (int i = 0; i < n; ++i) {
+        if (instance.tasks[i].duration > 0) cumulative.demands[i] = 1;
+      }
+      cumulative.capacity = chains;
+      plan.redundant_cumulatives.push_back(std::move(cumulative));
+    }
+  }
+
+  // Minimal forbidden sets: antichains whose joint demand exceeds a capacity
+  // while every proper subset fits. Enumerated by increasing size, and a
+  // forbidden set is never extended, so only minimal sets are produced.
+  if (options.forbidden_sets && n <= options.max_forbidden_set_tasks) {
+    const std::vector<std::vector<bool>> reachable = TransitiveClosure(instance, order);
+    std::vector<int> current;
+    std::vector<int64_t> usage(num_resources, 0);
+    std::function<void(int)> extend = [&](int next) {
+      if (static_cast<int>(plan.forbidden_sets.size()) >= options.max_forbidden_sets) return;
+      if (current.size() >= 2) {
+        bool forbidden = false;
+        bool minimal = true;
+        for (int r = 0; r < num_resources; ++r) {
+          if (usage[r] <= instance.resources[r].capacity) continue;
+          forbidden = true;
+          int64_t smallest = usage[r];
+          for (int member : current) {
+            smallest = std::min<int64_t>(smallest, instance.tasks[member].resource_demands[r]);
+          }
+          if (usage[r] - smallest > instance.resources[r].capacity) minimal = false;
+        }
+        if (forbidden) {
+          if (minimal) plan.forbidden_sets.push_back(current);
+          return;
+        }
+      }
+      if (static_cast<int>(current.size()) >= options.max_forbidden_set_size) return;
+      for (int candidate = next; candidate < n; ++candidate) {
+        if (instance.tasks[candidate].duration == 0) continue;
+        bool antichain = true;
+        for (int member : current) {
+          if (reachable[member][candidate] || reachable[candidate][member]) {
+            antichain = false;
+            break;
+          }
+        }
+        if (!antichain) continue;
+        current.push_back(candidate);
+        for (int r = 0; r < num_resources; ++r) {
+          usage[r] += instance.tasks[candidate].resource_demands[r];
+        }
+        extend(candidate + 1);
+        for (int r = 0; r < num_resources; ++r) {
+          usage[r] -= instance.tasks[candidate].resource_demands[r];
+        }
+        current.pop_back();
+      }
+    };
+    extend(0);
+  }
+
+  return plan;
+}
+
+// Adds the plan to the model. Returns, per resource, the index of the
+// no-overlap constraint that replaces its cumulative, or -1.
+inline std::vector<int> ApplyStrengthening(
+    const StrengtheningPlan& plan,
+    const std::vector<operations_research::sat::IntervalVar>& intervals,
+    const operations_research::sat::IntVar& makespan,
+    operations_research::sat::CpModelBuilder* model) {
+  using namespace operations_research::sat;
+  std::vector<int> set_index(plan.disjunctive_sets.size(), -1);
+  for (size_t s = 0; s < plan.disjunctive_sets.size(); ++s) {
+    std::vector<IntervalVar> set_intervals;
+    for (int task : plan.disjunctive_sets[s]) set_intervals.push_back(intervals[task]);
+    set_index[s] = model->Proto().constraints_size();
+    model->AddNoOverlap(set_intervals);
+  }
+
+  for (const RedundantCumulative& redundant : plan.redundant_cumulatives) {
+    auto cumulative = model->AddCumulative(redundant.capacity);
+    for (size_t i = 0; i < intervals.size(); ++i) {
+      if (redundant.demands[i] > 0) cumulative.AddDemand(intervals[i], redundant.demands[i]);
+    }
+  }
+
+  if (plan.MakespanLowerBound() > 0) {
+    model->AddGreaterOrEqual(makespan, plan.MakespanLowerBound());
+  }
+
+  // For each forbidden set, at least one pair must be sequenced. A pair that
+  // already shares a no-overlap set needs nothing more.
+  for (const std::vector<int>& set : plan.forbidden_sets) {
+    if (set.size() == 2) {
+      bool covered = false;
+      for (const std::vector<int>& disjunctive : plan.disjunctive_sets) {
+        if (std::binary_search(disjunctive.begin(), disjunctive.end(), set[0]) &&
+            std::binary_search(disjunctive.begin(), disjunctive.end(), set[1])) {
+          covered = true;
+          break;
+        }
+      }
+      if (!covered) model->AddNoOverlap({intervals[set[0]], intervals[set[1]]});
+      continue;
+    }
+    std::vector<BoolVar> orderings;
+    for (int a : set) {
+      for (int b : set) {
+        if (a == b) continue;
+        const BoolVar before = model->NewBoolVar();
+        model->AddLessOrEqual(intervals[a].EndExpr(), intervals[b].StartExpr())
+            .OnlyEnforceIf(before);
+        orderings.push_back(before);
+      }
+    }
+    model->AddBoolOr(orderings);
+  }
+
+  std::vector<int> unary_index(plan.unary_set.size(), -1);
+  for (size_t r = 0; r < plan.unary_set.size(); ++r) {
+    if (plan.unary_set[r] >= 0) unary_index[r] = set_index[plan.unary_set[r]];
+  }
+  return unary_index;
+}
+
+#endif  // MODEL_STRENGTHENING_H_
@@ -0,0 +1,421 @@
+#ifndef PACKED_INSTANCES_H_
+#define PACKED_INSTANCES_H_
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "rcpsp_instance.h"
+
+// A packed repository holds many instances in one binary file, laid out so
+// that a memory-mapped file can be used as is: no parsing and no allocation
+// per instance. rcpsp_pack writes it; PackedRepository maps it and hands out
+// PackedInstanceView, which the model builder takes directly.
+//
+// Layout, all integers little-endian (the byte order of the writing host,
+// which the reader checks):
+//
+//   Header
+//   one block per instance, 8-byte aligned, of int32 arrays:
+//     capacities[resources]
+//     durations[tasks]
+//     successor_offsets[tasks + 1]   CSR: successors of task i are
+//     successors[arcs]                successors[offsets[i]..offsets[i+1])
+//     demands[tasks * resources]      row-major, one row per task
+//   Entry[instances]                  the directory
+//   names                             instance names, not terminated
+//
+// Opening checks the header, that every block and name lies inside the file
+// and that the successor lists index nothing outside their instance: offsets
+// run from 0 to the arc count without decreasing and successor ids are task
+// ids. That is one pass over the offsets and the arcs; durations, capacities
+// and demands index nothing and are read as they are.
+
+namespace packed_format {
+
+constexpr char kMagic[8] = {'R', 'C', 'P', 'S', 'P', 'P', 'K', '1'};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kByteOrderMark = 0x01020304;
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t num_instances;
+  uint64_t directory_offset;
+  uint64_t names_offset;
+  uint64_t file_size;
+};
+
+struct Entry {
+  uint64_t offset;  // of the instance block
+  uint32_t num_tasks;
+  uint32_t num_resources;
+  uint32_t num_arcs;
+  int32_t horizon;
+  uint64_t name_offset;  // relative to Header::names_offset
+  uint64_t name_length;
+};
+
+static_assert(sizeof(Header) == 48, "Header layout is part of the format");
+static_assert(sizeof(Entry) == 40, "Entry layout is part of the format");
+
+// Size in bytes of the block of an instance.
+inline uint64_t BlockSize(uint64_t tasks, uint64_t resources, uint64_t arcs) {
+  return sizeof(int32_t) * (resources + tasks + (tasks + 1) + arcs + tasks * resources);
+}
+
+}  // namespace packed_format
+
+// The successors of a task, as a range over the mapped file.
+class IndexRange {
+ public:
+  IndexRange(const int32_t* begin, const int32_t* end) : begin_(begin), end_(end) {}
+  const int32_t* begin() const { return begin_; }
+  const int32_t* end() const { return end_; }
+  size_t size() const { return static_cast<size_t>(end_ - begin_); }
+
+ private:
+  const int32_t* begin_;
+  const int32_t* end_;
+};
+
+// Read-only view of one instance of a PackedRepository. Cheap to copy; valid
+// while the repository is open.
+class PackedInstanceView {
+ public:
+  PackedInstanceView() = default;
+
+  int num_tasks() const { return num_tasks_; }
+  int num_resources() const { return num_resources_; }
+  int horizon() const { return horizon_; }
+  int capacity(int resource) const { return capacities_[resource]; }
+  int duration(int task) const { return durations_[task]; }
+  IndexRange successors(int task) const {
+    return {successors_ + successor_offsets_[task],
+            successors_ + successor_offsets_[task + 1]};
+  }
+  int demand(int task, int resource) const {
+    return demands_[static_cast<size_t>(task) * num_resources_ + resource];
+  }
+
+ private:
+  friend class PackedRepository;
+
+  int num_tasks_ = 0;
+  int num_resources_ = 0;
+  int horizon_ = 0;
+  const int32_t* capacities_ = nullptr;
+  const int32_t* durations_ = nullptr;
+  const int32_t* successor_offsets_ = nullptr;
+  const int32_t* successors_ = nullptr;
+  const int32_t* demands_ = nullptr;
+};
+
+// The accessors of rcpsp_instance.h for views.
+inline int TaskCount(const PackedInstanceView& view) { return view.num_tasks(); }
+inline int ResourceCount(const PackedInstanceView& view) {
+  return view.num_resources();
+}
+inline int InstanceHorizon(const PackedInstanceView& view) { return view.horizon(); }
+inline int ResourceCapacity(const PackedInstanceView& view, int resource) {
+  return view.capacity(resource);
+}
+inline int TaskDuration(const PackedInstanceView& view, int task) {
+  return view.duration(task);
+}
+inline IndexRange TaskSuccessors(const PackedInstanceView& view, int task) {
+  return view.successors(task);
+}
+inline int TaskDemand(const PackedInstanceView& view, int task, int resource) {
+  return view.demand(task, resource);
+}
+
+// Unpacks a view, for the code that needs an RCPSPInstance.
+inline RCPSPInstance ToInstance(const PackedInstanceView& view) {
+  RCPSPInstance instance;
+  instance.horizon = view.horizon();
+  instance.resources.resize(view.num_resources());
+  for (int r = 0; r < view.num_resources(); ++r) {
+    instance.resources[r].capacity = view.capacity(r);
+  }
+  instance.tasks.resize(view.num_tasks());
+  for (int i = 0; i < view.num_tasks(); ++i) {
+    Task& task = instance.tasks[i];
+    task.id = i;
+    task.name = "Task " + std::to_string(i);
+    task.duration = view.duration(i);
+    const IndexRange successors = view.successors(i);
+    task.successors.assign(successors.begin(), successors.end());
+    task.resource_demands.resize(view.num_resources());
+    for (int r = 0; r < view.num_resources(); ++r) {
+      task.resource_demands[r] = view.demand(i, r);
+    }
+  }
+  return instance;
+}
+
+// A repository file opened for reading, memory-mapped where the platform
+// supports it and read into memory otherwise.
+class PackedRepository {
+ public:
+  PackedRepository() = default;
+  ~PackedRepository() { Close(); }
+  PackedRepository(const PackedRepository&) = delete;
+  PackedRepository& operator=(const PackedRepository&) = delete;
+
+  bool Open(const std::string& filename, std::string* error) {
+    Close();
+#if defined(__unix__) || defined(__APPLE__)
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+      *error = "cannot open " + filename;
+      return false;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size == 0) {
+      ::close(fd);
+      *error = "cannot read " + filename;
+      return false;
+    }
+    void* address = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ,
+                           MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) {
+      *error = "cannot map " + filename;
+      return false;
+    }
+    data_ = static_cast<const char*>(address);
+    size_ = static_cast<size_t>(info.st_size);
+    mapped_ = true;
+#else
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) {
+      *error = "cannot open " + filename;
+      return false;
+    }
+    buffer_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+#endif
+    if (!CheckLayout(error)) {
+      *error = filename + ": " + *error;
+      Close();
+      return false;
+    }
+    return true;
+  }
+
+  void Close() {
+#if defined(__unix__) || defined(__APPLE__)
+    if (mapped_) ::munmap(const_cast<char*>(data_), size_);
+#endif
+    mapped_ = false;
+    buffer_.clear();
+    data_ = nullptr;
+    size_ = 0;
+    header_ = nullptr;
+    entries_ = nullptr;
+  }
+
+  int size() const { return header_ == nullptr ? 0 : static_cast<int>(header_->num_instances); }
+
+  std::string_view name(int index) const {
+    const packed_format::Entry& entry = entries_[index];
+    return {data_ + header_->names_offset + entry.name_offset,
+            static_cast<size_t>(entry.name_length)};
+  }
+
+  PackedInstanceView instance(int index) const {
+    const packed_format::Entry& entry = entries_[index];
+    const int32_t* block = reinterpret_cast<const int32_t*>(data_ + entry.offset);
+    PackedInstanceView view;
+    view.num_tasks_ = static_cast<int>(entry.num_tasks);
+    view.num_resources_ = static_cast<int>(entry.num_resources);
+    view.horizon_ = entry.horizon;
+    view.capacities_ = block;
+    view.durations_ = view.capacities_ + entry.num_resources;
+    view.successor_offsets_ = view.durations_ + entry.num_tasks;
+    view.successors_ = view.successor_offsets_ + entry.num_tasks + 1;
+    view.demands_ = view.successors_ + entry.num_arcs;
+    return view;
+  }
+
+ private:
+  bool CheckLayout(std::string* error) {
+    using packed_format::Entry;
+    using packed_format::Header;
+    if (size_ < sizeof(Header)) {
+      *error = "truncated header";
+      return false;
+    }
+    header_ = reinterpret_cast<const Header*>(data_);
+    if (std::memcmp(header_->magic, packed_format::kMagic, sizeof(header_->magic)) != 0) {
+      *error = "not a packed repository";
+      return false;
+    }
+    if (header_->version != packed_format::kVersion ||
+        header_->byte_order != packed_format::kByteOrderMark) {
+      *error = "unsupported version or byte order";
+      return false;
+    }
+    if (header_->file_size != size_ || header_->directory_offset % 8 != 0 ||
+        header_->directory_offset > size_ ||
+        header_->num_instances > (size_ - header_->directory_offset) / sizeof(Entry) ||
+        header_->names_offset <
+            header_->directory_offset + header_->num_instances * sizeof(Entry) ||
+        header_->names_offset > size_) {
+      *error = "corrupt directory";
+      return false;
+    }
+    entries_ = reinterpret_cast<const Entry*>(data_ + header_->directory_offset);
+    for (uint64_t k = 0; k < header_->num_instances; ++k) {
+      const Entry& entry = entries_[k];
+      const uint64_t block =
+          packed_format::BlockSize(entry.num_tasks, entry.num_resources, entry.num_arcs);
+      if (entry.num_tasks > INT32_MAX || entry.num_resources > INT32_MAX ||
+          entry.offset % 8 != 0 || entry.offset < sizeof(Header) ||
+          entry.offset > header_->directory_offset ||
+          block > header_->directory_offset - entry.offset ||
+          entry.name_offset > size_ - header_->names_offset ||
+          entry.name_length > size_ - header_->names_offset - entry.name_offset) {
+        *error = "corrupt entry " + std::to_string(k);
+        return false;
+      }
+      if (!CheckSuccessors(instance(static_cast<int>(k)), entry.num_arcs)) {
+        *error = "corrupt successors in entry " + std::to_string(k);
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static bool CheckSuccessors(const PackedInstanceView& view, uint32_t num_arcs) {
+    const int32_t* offsets = view.successor_offsets_;
+    const int num_tasks = view.num_tasks();
+    if (offsets[0] != 0 || offsets[num_tasks] < 0 ||
+        static_cast<uint32_t>(offsets[num_tasks]) != num_arcs) {
+      return false;
+    }
+    for (int i = 0; i < num_tasks; ++i) {
+      if (offsets[i + 1] < offsets[i]) return false;
+    }
+    for (uint32_t a = 0; a < num_arcs; ++a) {
+      if (view.successors_[a] < 0 || view.successors_[a] >= num_tasks) return false;
+    }
+    return true;
+  }
+
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+  bool mapped_ = false;
+  std::vector<char> buffer_;
+  const packed_format::Header* header_ = nullptr;
+  const packed_format::Entry* entries_ = nullptr;
+};
+
+// Writes a repository one instance at a time; the directory and the names
+// are kept in memory and written by Close().
+class PackedRepositoryWriter {
+ public:
+  bool Open(const std::string& filename, std::string* error) {
+    out_.open(filename, std::ios::binary | std::ios::trunc);
+    if (!out_) {
+      *error = "cannot write " + filename;
+      return false;
+    }
+    const packed_format::Header placeholder = {};
+    out_.write(reinterpret_cast<const char*>(&placeholder), sizeof(placeholder));
+    offset_ = sizeof(placeholder);
+    return true;
+  }
+
+  void Add(const std::string& name, const RCPSPInstance& instance) {
+    const int num_tasks = static_cast<int>(instance.tasks.size());
+    const int num_resources = static_cast<int>(instance.resources.size());
+    std::vector<int32_t>& block = block_;
+    block.clear();
+    for (const Resource& resource : instance.resources) block.push_back(resource.capacity);
+    for (const Task& task : instance.tasks) block.push_back(task.duration);
+    int32_t arcs = 0;
+    block.push_back(0);
+    for (const Task& task : instance.tasks) {
+      arcs += static_cast<int32_t>(task.successors.size());
+      block.push_back(arcs);
+    }
+    for (const Task& task : instance.tasks) {
+      block.insert(block.end(), task.successors.begin(), task.successors.end());
+    }
+    for (const Task& task : instance.tasks) {
+      for (int r = 0; r < num_resources; ++r) block.push_back(task.resource_demands[r]);
+    }
+
+    packed_format::Entry entry = {};
+    entry.offset = offset_;
+    entry.num_tasks = static_cast<uint32_t>(num_tasks);
+    entry.num_resources = static_cast<uint32_t>(num_resources);
+    entry.num_arcs = static_cast<uint32_t>(arcs);
+    entry.horizon = instance.horizon;
+    entry.name_offset = names_.size();
+    entry.name_length = name.size();
+    entries_.push_back(entry);
+    names_ += name;
+
+    const size_t bytes = block.size() * sizeof(int32_t);
+    out_.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(bytes));
+    offset_ += bytes;
+    Pad();
+  }
+
+  bool Close(std::string* error) {
+    packed_format::Header header = {};
+    std::memcpy(header.magic, packed_format::kMagic, sizeof(header.magic));
+    header.version = packed_format::kVersion;
+    header.byte_order = packed_format::kByteOrderMark;
+    header.num_instances = entries_.size();
+    header.directory_offset = offset_;
+    const size_t directory_bytes = entries_.size() * sizeof(packed_format::Entry);
+    out_.write(reinterpret_cast<const char*>(entries_.data()),
+               static_cast<std::streamsize>(directory_bytes));
+    header.names_offset = offset_ + directory_bytes;
+    out_.write(names_.data(), static_cast<std::streamsize>(names_.size()));
+    header.file_size = header.names_offset + names_.size();
+    out_.seekp(0);
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out_.close();
+    if (!out_) {
+      *error = "write failed";
+      return false;
+    }
+    return true;
+  }
+
+  int size() const { return static_cast<int>(entries_.size()); }
+
+ private:
+  void Pad() {
+    static const char kZeros[8] = {};
+    const size_t padding = (8 - offset_ % 8) % 8;
+    out_.write(kZeros, static_cast<std::streamsize>(padding));
+    offset_ += padding;
+  }
+
+  std::ofstream out_;
+  uint64_t offset_ = 0;
+  std::vector<packed_format::Entry> entries_;
+  std::string names_;
+  std::vector<int32_t> block_;
+};
+
+#endif  // PACKED_INSTANCES_H_
@@ -0,0 +1,29 @@
+#ifndef PARALLEL_FOR_H_
+#define PARALLEL_FOR_H_
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// Runs fn(0..count-1) on up to num_threads threads. Indices are handed out
+// one at a time, so uneven work balances itself; with one thread or one
+// index, fn runs on the calling thread.
+inline void ParallelFor(int count, int num_threads,
+                        const std::function<void(int)>& fn) {
+  if (num_threads <= 1 || count <= 1) {
+    for (int i = 0; i < count; ++i) fn(i);
+    return;
+  }
+  std::atomic<int> next(0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < std::min(num_threads, count); ++t) {
+    threads.emplace_back([&]() {
+      for (int i = next++; i < count; i = next++) fn(i);
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+}
+
+#endif  // PARALLEL_FOR_H_
@@ -0,0 +1,739 @@
+#ifndef PORTFOLIO_H_
+#define PORTFOLIO_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "incumbent_stream.h"
+#include "instance_generator.h"
+#include "json_escape.h"
+#include "makespan_bounds.h"
+#include "ortools/sat/cp_model.h"
+#include "ortools/sat/cp_model_solver.h"
+#include "ortools/sat/sat_parameters.pb.h"
+#include "parallel_for.h"
+#include "rcpsp_instance.h"
+
+// Multi-project portfolio scheduling: many projects, each with a release
+// date, a due date and a weight, compete for one set of shared resource
+// capacities, and the objective is the total weighted delay
+// sum(weight * max(0, completion - due)).
+//
+// No model of the whole portfolio is built. The shared capacities are
+// coordinated by Lagrangian prices instead: time is cut into buckets, and
+// every iteration
+//
+//   1. solves each project alone with CP-SAT, in parallel, minimizing its
+//      weighted delay plus the price of the resources it uses in each bucket;
+//   2. merges the project schedules with a serial list scheduler, in the
+//      order of their start times, into a feasible portfolio schedule;
+//   3. raises the price of every bucket the project schedules overload and
+//      lowers it where capacity is left idle.
+//
+// Projects whose delay costs less than the congestion they cause learn to
+// move out of the way, and the list scheduler turns each round into a
+// schedule that respects the capacities. The best one is kept. Every model
+// holds a single project, so 100 projects of 300 tasks stay 100 small solves
+// per iteration.
+
+struct Project {
+  std::string name;
+  RCPSPInstance instance;  // its own capacities are replaced by the shared ones
+  int64_t release = 0;
+  int64_t due = 0;
+  int64_t weight = 1;
+};
+
+struct Portfolio {
+  std::vector<Resource> resources;  // shared capacities
+  std::vector<Project> projects;
+
+  int NumTasks() const {
+    int count = 0;
+    for (const Project& project : projects) {
+      count += static_cast<int>(project.instance.tasks.size());
+    }
+    return count;
+  }
+
+  // Index of each project's first task in the combined instance.
+  std::vector<int> FirstTasks() const {
+    std::vector<int> first_tasks;
+    int count = 0;
+    for (const Project& project : projects) {
+      first_tasks.push_back(count);
+      count += static_cast<int>(project.instance.tasks.size());
+    }
+    return first_tasks;
+  }
+
+  // All projects as one instance with the shared capacities, project after
+  // project. Task names are prefixed with the project name.
+  RCPSPInstance Combined() const {
+    RCPSPInstance combined;
+    combined.resources = resources;
+    combined.horizon = 0;
+    int64_t latest_release = 0;
+    for (const Project& project : projects) {
+      const int first = static_cast<int>(combined.tasks.size());
+      for (const Task& task : project.instance.tasks) {
+        Task copy = task;
+        copy.id = first + task.id;
+        copy.name = project.name + ": " + task.name;
+        for (int& succ : copy.successors) succ += first;
+        combined.tasks.push_back(std::move(copy));
+        combined.horizon += task.duration;
+      }
+      latest_release = std::max(latest_release, project.release);
+    }
+    combined.horizon += static_cast<int>(latest_release);
+    return combined;
+  }
+};
+
+// Reads a portfolio file:
+//
+//   # shared capacities, one per resource
+//   capacity 12 8 10 6
+//   project house.rcp release=0 due=60 weight=3 name=House
+//   project software.rcp release=15 due=90
+//
+// Instance paths are relative to the portfolio file. Without a capacity
+// line, each shared capacity is the largest one among the projects.
+inline bool ReadPortfolio(const std::string& filename, Portfolio* portfolio) {
+  std::ifstream in(filename);
+  if (!in.is_open()) {
+    std::cerr << "Cannot open portfolio " << filename << std::endl;
+    return false;
+  }
+  const size_t slash = filename.find_last_of('/');
+  const std::string directory =
+      slash == std::string::npos ? "" : filename.substr(0, slash + 1);
+  portfolio->resources.clear();
+  portfolio->projects.clear();
+  bool has_capacities = false;
+  int line_number = 0;
+  for (std::string line; std::getline(in, line);) {
+    ++line_number;
+    std::istringstream fields(line);
+    std::string keyword;
+    if (!(fields >> keyword) || keyword[0] == '#') continue;
+    const std::string where = filename + ":" + std::to_string(line_number);
+    if (keyword == "capacity") {
+      portfolio->resources.clear();
+      for (int capacity; fields >> capacity;) {
+        portfolio->resources.push_back({capacity});
+      }
+      has_capacities = true;
+      continue;
+    }
+    if (keyword != "project") {
+      std::cerr << where << ": unknown keyword '" << keyword << "'" << std::endl;
+      return false;
+    }
+    Project project;
+    std::string path;
+    fields >> path;
+    bool has_due = false;
+    for (std::string field; fields >> field;) {
+      const size_t eq = field.find('=');
+      const std::string name = field.substr(0, eq);
+      const std::string value = eq == std::string::npos ? "" : field.substr(eq + 1);
+      if (name == "release") {
+        project.release = std::atoll(value.c_str());
+      } else if (name == "due") {
+        project.due = std::atoll(value.c_str());
+        has_due = true;
+      } else if (name == "weight") {
+        project.weight = std::atoll(value.c_str());
+      } else if (name == "name") {
+        project.name = value;
+      } else {
+        std::cerr << where << ": unknown project field '" << field << "'" << std::endl;
+        return false;
+      }
+    }
+    if (path.empty() || !has_due) {
+      std::cerr << where << ": a project needs an instance and a due date" << std::endl;
+      return false;
+    }
+    if (!ReadPattersonInstance(path[0] == '/' ? path : directory + path,
+                               &project.instance)) {
+      return false;
+    }
+    if (project.name.empty()) project.name = path;
+    portfolio->projects.push_back(std::move(project));
+  }
+  if (portfolio->projects.empty()) {
+    std::cerr << "No projects in " << filename << std::endl;
+    return false;
+  }
+
+  if (!has_capacities) {
+    for (const Project& project : portfolio->projects) {
+      const std::vector<Resource>& own = project.instance.resources;
+      if (portfolio->resources.size() < own.size()) {
+        portfolio->resources.resize(own.size(), Resource{0});
+      }
+      for (size_t r = 0; r < own.size(); ++r) {
+        portfolio->resources[r].capacity =
+            std::max(portfolio->resources[r].capacity, own[r].capacity);
+      }
+    }
+  }
+  for (Project& project : portfolio->projects) {
+    if (project.instance.resources.size() != portfolio->resources.size()) {
+      std::cerr << "Project " << project.name << " uses "
+                << project.instance.resources.size() << " resources, the portfolio "
+                << portfolio->resources.size() << std::endl;
+      return false;
+    }
+    for (const Task& task : project.instance.tasks) {
+      for (size_t r = 0; r < portfolio->resources.size(); ++r) {
+        if (task.resource_demands[r] > portfolio->resources[r].capacity) {
+          std::cerr << "Project " << project.name << ": " << task.name
+                    << " demands more than the capacity of resource " << r
+                    << std::endl;
+          return false;
+        }
+      }
+    }
+    project.instance.resources = portfolio->resources;
+  }
+  return true;
+}
+
+// A synthetic portfolio for scaling studies: `num_projects` generated
+// projects with seeds seed, seed + 1, ... Shared capacities are twice the
+// largest generated ones, and projects are released about as fast as the
+// bottleneck resource can absorb their work, so they overlap and compete.
+// Each is due 1.5 times its lower bound after its release. Fails with a
+// message in `error` if `params` do not pass GeneratorParams::Validate().
+inline bool GeneratePortfolio(int num_projects, const GeneratorParams& params,
+                              Portfolio* result, std::string* error) {
+  if (!params.Validate(error)) return false;
+  Portfolio portfolio;
+  SplitMix64 rng(params.seed * 0x9E3779B97F4A7C15ULL + 1);
+  for (int k = 0; k < num_projects; ++k) {
+    GeneratorParams project_params = params;
+    project_params.seed = params.seed + k;
+    Project project;
+    project.name = "Project " + std::to_string(k + 1);
+    project.instance = GenerateInstance(project_params);
+    project.weight = rng.Uniform(1, 5);
+    const std::vector<Resource>& own = project.instance.resources;
+    portfolio.resources.resize(own.size(), Resource{0});
+    for (size_t r = 0; r < own.size(); ++r) {
+      portfolio.resources[r].capacity =
+          std::max(portfolio.resources[r].capacity, 2 * own[r].capacity);
+    }
+    portfolio.projects.push_back(std::move(project));
+  }
+  int64_t release = 0;
+  for (Project& project : portfolio.projects) {
+    project.instance.resources = portfolio.resources;
+    RCPSPInstance energy_only = project.instance;
+    for (Task& task : energy_only.tasks) task.successors.clear();
+    project.release = release;
+    project.due = release + static_cast<int64_t>(std::ceil(
+                                1.5 * MakespanLowerBound(project.instance)));
+    release += MakespanLowerBound(energy_only);
+  }
+  *result = std::move(portfolio);
+  return true;
+}
+
+struct PortfolioOptions {
+  std::string file;
+  int generate_projects = 0;  // > 0: generate this many projects
+  int iterations = 10;
+  double project_time_limit = 1.0;
+  int num_threads = 0;      // 0: one per hardware thread
+  double time_limit = 0.0;  // for all iterations together; 0: none
+
+  bool enabled() const { return !file.empty() || generate_projects > 0; }
+
+  // Parses "--portfolio=FILE", "--projects=N", "--portfolio_iterations=N",
+  // "--project_time_limit=S" and "--portfolio_threads=N". Returns false for
+  // any other argument.
+  bool ParseFlag(const std::string& arg) {
+    const size_t eq = arg.find('=');
+    if (arg.rfind("--", 0) != 0 || eq == std::string::npos) return false;
+    const std::string name = arg.substr(2, eq - 2);
+    const char* value = arg.c_str() + eq + 1;
+    if (name == "portfolio") {
+      file = value;
+    } else if (name == "projects") {
+      generate_projects = std::atoi(value);
+    } else if (name == "portfolio_iterations") {
+      iterations = std::atoi(value);
+    } else if (name == "project_time_limit") {
+      project_time_limit = std::atof(value);
+    } else if (name == "portfolio_threads") {
+      num_threads = std::atoi(value);
+    } else {
+      return false;
+    }
+    return true;
+  }
+};
+
+struct PortfolioResult {
+  std::vector<int64_t> starts;  // in the task order of Portfolio::Combined()
+  std::vector<int64_t> completions;  // per project
+  int64_t weighted_delay = 0;
+  int64_t delay_lower_bound = 0;
+  int64_t makespan = 0;
+  int64_t makespan_lower_bound = 0;
+  int iterations = 0;
+  int improving_iterations = 0;
+  int failed_project_solves = 0;
+  double peak_load = 0.0;  // of the last project schedules, 1 = at capacity
+
+  std::string Summary() const {
+    std::ostringstream oss;
+    oss << "weighted delay " << weighted_delay << " (lower bound "
+        << delay_lower_bound << "), makespan " << makespan << ", " << iterations
+        << " iterations (" << improving_iterations << " improving, "
+        << failed_project_solves << " failed project solves), last peak load "
+        << peak_load;
+    return oss.str();
+  }
+
+  std::string ToJson(const Portfolio& portfolio) const {
+    const std::vector<int> first_tasks = portfolio.FirstTasks();
+    std::ostringstream oss;
+    oss << "{\"weightedDelay\": " << weighted_delay
+        << ", \"delayLowerBound\": " << delay_lower_bound
+        << ", \"iterations\": " << iterations
+        << ", \"improvingIterations\": " << improving_iterations
+        << ", \"projects\": [";
+    for (size_t p = 0; p < portfolio.projects.size(); ++p) {
+      const Project& project = portfolio.projects[p];
+      if (p > 0) oss << ",";
+      oss << "\n    {\"name\": \"" << JsonEscaped(project.name) << "\", \"firstTask\": "
+          << first_tasks[p] << ", \"numTasks\": " << project.instance.tasks.size()
+          << ", \"release\": " << project.release << ", \"due\": " << project.due
+          << ", \"weight\": " << project.weight
+          << ", \"completion\": " << completions[p] << ", \"delay\": "
+          << std::max<int64_t>(0, completions[p] - project.due) << "}";
+    }
+    oss << "]}";
+    return oss.str();
+  }
+};
+
+namespace portfolio_internal {
+
+// Per-project data that does not change between iterations.
+struct ProjectData {
+  std::vector<int> position;     // of each task in a topological order
+  std::vector<int64_t> earliest;  // earliest start after the release
+  std::vector<int64_t> tail;      // longest path from the start to the end
+  int64_t length_bound = 0;
+};
+
+inline ProjectData AnalyzeProject(const Project& project) {
+  const RCPSPInstance& instance = project.instance;
+  const std::vector<int> order = TopologicalOrder(instance);
+  ProjectData data;
+  data.position.assign(instance.tasks.size(), 0);
+  for (size_t p = 0; p < order.size(); ++p) data.position[order[p]] = static_cast<int>(p);
+  ComputeHeadsAndTails(instance, &data.earliest, &data.tail);
+  // The project's capacities are the shared ones.
+  data.length_bound = MakespanLowerBound(instance);
+  return data;
+}
+
+// Usage of the shared resources over time, for list scheduling. It grows
+// with the schedule, so no horizon has to be known in advance.
+class UsageProfile {
+ public:
+  explicit UsageProfile(const std::vector<Resource>& resources)
+      : resources_(resources), usage_(resources.size()) {}
+
+  // Earliest start >= t at which the task fits under every capacity.
+  int64_t EarliestFit(const Task& task, int64_t t) const {
+    for (;;) {
+      int64_t conflict = -1;
+      for (size_t r = 0; r < resources_.size() && conflict < 0; ++r) {
+        const int demand = task.resource_demands[r];
+        if (demand == 0) continue;
+        const std::vector<int>& usage = usage_[r];
+        const int64_t end = std::min<int64_t>(t + task.duration, usage.size());
+        // From the right: jumping past the last conflict skips the most.
+        for (int64_t u = end - 1; u >= t; --u) {
+          if (usage[u] + demand > resources_[r].capacity) {
+            conflict = u;
+            break;
+          }
+        }
+      }
+      if (conflict < 0) return t;
+      t = conflict + 1;
+    }
+  }
+
+  void Add(const Task& task, int64_t start) {
+    for (size_t r = 0; r < resources_.size(); ++r) {
+      const int demand = task.resource_demands[r];
+      if (demand == 0) continue;
+      std::vector<int>& usage = usage_[r];
+      if (static_cast<int64_t>(usage.size()) < start + task.duration) {
+        usage.resize(start + task.duration, 0);
+      }
+      for (int64_t u = start; u < start + task.duration; ++u) usage[u] += demand;
+    }
+  }
+
+ private:
+  const std::vector<Resource>& resources_;
+  std::vector<std::vector<int>> usage_;
+};
+
+// Serial schedule generation over all projects: tasks are taken by
+// increasing `priority` (one value per combined task, non-decreasing along
+// precedences) and each starts as early as its predecessors, its project's
+// release and the shared capacities allow.
+inline std::vector<int64_t> ListSchedule(const Portfolio& portfolio,
+                                         const std::vector<ProjectData>& data,
+                                         const std::vector<int>& first_tasks,
+                                         const std::vector<int64_t>& priority) {
+  std::vector<std::tuple<int64_t, int, int, int>> order;  // priority, project, position, task
+  order.reserve(priority.size());
+  for (size_t p = 0; p < portfolio.projects.size(); ++p) {
+    const int n = static_cast<int>(portfolio.projects[p].instance.tasks.size());
+    for (int i = 0; i < n; ++i) {
+      order.emplace_back(priority[first_tasks[p] + i], static_cast<int>(p),
+                         data[p].position[i], i);
+    }
+  }
+  std::sort(order.begin(), order.end());
+
+  std::vector<int64_t> starts(priority.size(), 0);
+  std::vector<int64_t> ready(priority.size(), 0);
+  for (size_t p = 0; p < portfolio.projects.size(); ++p) {
+    const int n = static_cast<int>(portfolio.projects[p].instance.tasks.size());
+    std::fill(ready.begin() + first_tasks[p], ready.begin() + first_tasks[p] + n,
+              portfolio.projects[p].release);
+  }
+  UsageProfile profile(portfolio.resources);
+  for (const auto& entry : order) {
+    const int p = std::get<1>(entry);
+    const int i = std::get<3>(entry);
+    const Task& task = portfolio.projects[p].instance.tasks[i];
+    const int64_t start = profile.EarliestFit(task, ready[first_tasks[p] + i]);
+    starts[first_tasks[p] + i] = start;
+    profile.Add(task, start);
+    for (int succ : task.successors) {
+      int64_t& succ_ready = ready[first_tasks[p] + succ];
+      succ_ready = std::max(succ_ready, start + task.duration);
+    }
+  }
+  return starts;
+}
+
+// Per-bucket prices of the shared resources, in weighted delay per unit of
+// time for the whole capacity.
+struct ResourcePrices {
+  int64_t bucket_width = 1;
+  int num_buckets = 0;
+  std::vector<std::vector<double>> prices;  // [resource][bucket]
+
+  bool IsZero() const {
+    for (const std::vector<double>& row : prices) {
+      for (double price : row) {
+        if (price > 0.0) return false;
+      }
+    }
+    return true;
+  }
+
+  // Price of running the task over [start, start + duration).
+  double Cost(const Task& task, int64_t start,
+              const std::vector<Resource>& resources) const {
+    double cost = 0.0;
+    const int64_t end = start + task.duration;
+    for (size_t r = 0; r < resources.size(); ++r) {
+      const int demand = task.resource_demands[r];
+      if (demand == 0) continue;
+      double price_time = 0.0;
+      for (int64_t b = start / bucket_width; b * bucket_width < end; ++b) {
+        const int64_t overlap = std::min(end, (b + 1) * bucket_width) -
+                                std::max(start, b * bucket_width);
+        price_time += overlap * prices[r][std::min<int64_t>(b, num_buckets - 1)];
+      }
+      cost += price_time * demand / resources[r].capacity;
+    }
+    return cost;
+  }
+};
+
+struct ProjectSolve {
+  bool solved = false;
+  std::vector<int64_t> starts;
+};
+
+// Solves one project alone under the prices. `hint` holds a schedule of the
+// project that ends by `horizon`, so the model is always feasible.
+inline ProjectSolve SolveProject(const Project& project, const ProjectData& data,
+                                 const std::vector<Resource>& resources,
+                                 const ResourcePrices& prices, int64_t horizon,
+                                 const std::vector<int64_t>& hint, double time_limit,
+                                 int num_workers) {
+  using namespace operations_research;
+  using namespace operations_research::sat;
+  const RCPSPInstance& instance = project.instance;
+  const int n = static_cast<int>(instance.tasks.size());
+  // One unit of delay outweighs moving every task by one, the tie-break that
+  // keeps tasks off the critical path from drifting right.
+  const int64_t scale = n + 1;
+  const bool priced = !prices.IsZero();
+
+  CpModelBuilder model;
+  std::vector<IntVar> start_vars;
+  std::vector<IntervalVar> intervals;
+  std::vector<LinearExpr> ends;
+  LinearExpr objective;
+  for (int i = 0; i < n; ++i) {
+    const Task& task = instance.tasks[i];
+    const int64_t min_start = project.release + data.earliest[i];
+    const int64_t max_start = std::max(min_start, horizon - data.tail[i]);
+    const IntVar start = model.NewIntVar(Domain(min_start, max_start));
+    start_vars.push_back(start);
+    intervals.push_back(model.NewFixedSizeIntervalVar(start, task.duration));
+    ends.push_back(intervals.back().EndExpr());
+    objective += ends.back();
+    if (!hint.empty()) model.AddHint(start, hint[i]);
+    if (!priced || task.duration == 0) continue;
+
+    // The price of the task as a table over the bucket it starts in.
+    const int64_t width = prices.bucket_width;
+    const int64_t first_bucket = min_start / width;
+    const int64_t last_bucket = max_start / width;
+    std::vector<int64_t> costs(last_bucket + 1, 0);
+    int64_t min_cost = INT64_MAX;
+    int64_t max_cost = 0;
+    for (int64_t b = first_bucket; b <= last_bucket; ++b) {
+      costs[b] = std::llround(
+          scale * prices.Cost(task, std::max(min_start, b * width), resources));
+      min_cost = std::min(min_cost, costs[b]);
+      max_cost = std::max(max_cost, costs[b]);
+    }
+    if (max_cost == 0) continue;
+    const IntVar bucket = model.NewIntVar(Domain(first_bucket, last_bucket));
+    model.AddLessOrEqual(width * LinearExpr(bucket), start);
+    model.AddLessOrEqual(start, width * LinearExpr(bucket) + (width - 1));
+    const IntVar cost = model.NewIntVar(Domain(min_cost, max_cost));
+    model.AddElement(bucket, costs, cost);
+    objective += cost;
+  }
+  for (int i = 0; i < n; ++i) {
+    for (int succ : instance.tasks[i].successors) {
+      model.AddLessOrEqual(intervals[i].EndExpr(), intervals[succ].StartExpr());
+    }
+  }
+  for (size_t r = 0; r < resources.size(); ++r) {
+    CumulativeConstraint cumulative = model.AddCumulative(resources[r].capacity);
+    for (int i = 0; i < n; ++i) {
+      const int demand = instance.tasks[i].resource_demands[r];
+      if (demand > 0) cumulative.AddDemand(intervals[i], demand);
+    }
+  }
+  const IntVar completion = model.NewIntVar(Domain(project.release, horizon));
+  model.AddMaxEquality(completion, ends);
+  const IntVar delay =
+      model.NewIntVar(Domain(0, std::max<int64_t>(0, horizon - project.due)));
+  model.AddGreaterOrEqual(delay, LinearExpr(completion) - project.due);
+  objective += (scale * project.weight) * LinearExpr(delay);
+  model.Minimize(objective);
+
+  SatParameters parameters;
+  parameters.set_max_time_in_seconds(time_limit);
+  parameters.set_num_workers(std::max(1, num_workers));
+  const CpSolverResponse response = SolveWithParameters(model.Build(), parameters);
+  ProjectSolve result;
+  if (response.status() != CpSolverStatus::OPTIMAL &&
+      response.status() != CpSolverStatus::FEASIBLE) {
+    return result;
+  }
+  result.solved = true;
+  for (const IntVar& start : start_vars) {
+    result.starts.push_back(SolutionIntegerValue(response, start));
+  }
+  return result;
+}
+
+}  // namespace portfolio_internal
+
+// Schedules the portfolio by price coordination and returns the best
+// feasible schedule found. Every improving schedule is reported to
+// `incumbents` when it is not null, with the weighted delay as objective; a
+// stop requested through the stream ends the iterations.
+inline PortfolioResult SolvePortfolio(const Portfolio& portfolio,
+                                      const PortfolioOptions& options,
+                                      IncumbentStream* incumbents,
+                                      const std::atomic<bool>* stop_requested) {
+  using namespace portfolio_internal;
+  const auto start_time = std::chrono::steady_clock::now();
+  const int num_projects = static_cast<int>(portfolio.projects.size());
+  const int num_resources = static_cast<int>(portfolio.resources.size());
+  const std::vector<int> first_tasks = portfolio.FirstTasks();
+  const int num_tasks = portfolio.NumTasks();
+  const int num_threads =
+      options.num_threads > 0
+          ? options.num_threads
+          : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  const int parallel_projects = std::max(1, std::min(num_threads, num_projects));
+  const int workers_per_project = std::max(1, num_threads / parallel_projects);
+
+  PortfolioResult result;
+  std::vector<ProjectData> data;
+  double mean_weight = 0.0;
+  for (const Project& project : portfolio.projects) {
+    data.push_back(AnalyzeProject(project));
+    const int64_t earliest_completion = project.release + data.back().length_bound;
+    result.delay_lower_bound +=
+        project.weight * std::max<int64_t>(0, earliest_completion - project.due);
+    result.makespan_lower_bound =
+        std::max(result.makespan_lower_bound, earliest_completion);
+    mean_weight += static_cast<double>(project.weight) / std::max(1, num_projects);
+  }
+
+  auto project_of = [&](int task) {
+    return static_cast<int>(std::upper_bound(first_tasks.begin(), first_tasks.end(), task) -
+                            first_tasks.begin()) -
+           1;
+  };
+  auto task_of = [&](int global) -> const Task& {
+    const int p = project_of(global);
+    return portfolio.projects[p].instance.tasks[global - first_tasks[p]];
+  };
+  auto accept = [&](const std::vector<int64_t>& starts) {
+    std::vector<int64_t> completions(num_projects, 0);
+    int64_t weighted_delay = 0;
+    int64_t makespan = 0;
+    for (int p = 0; p < num_projects; ++p) {
+      const Project& project = portfolio.projects[p];
+      completions[p] = project.release;
+      for (size_t i = 0; i < project.instance.tasks.size(); ++i) {
+        completions[p] = std::max(
+            completions[p], starts[first_tasks[p] + i] + project.instance.tasks[i].duration);
+      }
+      weighted_delay += project.weight * std::max<int64_t>(0, completions[p] - project.due);
+      makespan = std::max(makespan, completions[p]);
+    }
+    if (!result.starts.empty() && weighted_delay >= result.weighted_delay) return false;
+    result.starts = starts;
+    result.completions = std::move(completions);
+    result.weighted_delay = weighted_delay;
+    result.makespan = makespan;
+    if (incumbents != nullptr) {
+      incumbents->OnSolution(static_cast<double>(weighted_delay),
+                             static_cast<double>(result.delay_lower_bound), starts);
+    }
+    return true;
+  };
+
+  // A first schedule by minimum slack: tasks whose latest start for their
+  // project's due date comes first go first.
+  std::vector<int64_t> relaxed(num_tasks, 0);
+  for (int p = 0; p < num_projects; ++p) {
+    const Project& project = portfolio.projects[p];
+    for (size_t i = 0; i < project.instance.tasks.size(); ++i) {
+      relaxed[first_tasks[p] + i] = project.due - data[p].tail[i];
+    }
+  }
+  accept(ListSchedule(portfolio, data, first_tasks, relaxed));
+  relaxed = result.starts;
+
+  // Every project alone fits in the span of that schedule, so it bounds the
+  // project models. Prices are kept for at most 256 buckets of it.
+  const int64_t horizon = std::max<int64_t>(1, result.makespan);
+  ResourcePrices prices;
+  prices.bucket_width = (horizon + 255) / 256;
+  prices.num_buckets = static_cast<int>((horizon + prices.bucket_width - 1) / prices.bucket_width);
+  prices.prices.assign(num_resources, std::vector<double>(prices.num_buckets, 0.0));
+
+  auto out_of_time = [&]() {
+    if (stop_requested != nullptr && stop_requested->load()) return true;
+    const double elapsed = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start_time)
+                               .count();
+    return options.time_limit > 0.0 && elapsed >= options.time_limit;
+  };
+
+  std::atomic<int> failed_solves(0);
+  for (int iteration = 0; iteration < options.iterations; ++iteration) {
+    if (result.weighted_delay <= result.delay_lower_bound || out_of_time()) break;
+
+    // 1. Every project alone under the current prices, hinted with its last
+    // schedule. A failed solve keeps that schedule.
+    ParallelFor(num_projects, parallel_projects, [&](int p) {
+      const Project& project = portfolio.projects[p];
+      const int n = static_cast<int>(project.instance.tasks.size());
+      const std::vector<int64_t> hint(relaxed.begin() + first_tasks[p],
+                                      relaxed.begin() + first_tasks[p] + n);
+      const ProjectSolve solve =
+          SolveProject(project, data[p], portfolio.resources, prices, horizon, hint,
+                       options.project_time_limit, workers_per_project);
+      if (!solve.solved) {
+        ++failed_solves;
+        return;
+      }
+      std::copy(solve.starts.begin(), solve.starts.end(), relaxed.begin() + first_tasks[p]);
+    });
+    ++result.iterations;
+
+    // 2. A feasible portfolio schedule in the order of the project schedules.
+    const std::vector<int64_t> repaired = ListSchedule(portfolio, data, first_tasks, relaxed);
+    if (accept(repaired)) ++result.improving_iterations;
+    if (repaired == relaxed) break;  // the project schedules already fit together
+
+    // 3. Subgradient step on the load of every bucket.
+    std::vector<std::vector<double>> load(num_resources,
+                                          std::vector<double>(prices.num_buckets, 0.0));
+    for (int global = 0; global < num_tasks; ++global) {
+      const Task& task = task_of(global);
+      const int64_t start = relaxed[global];
+      const int64_t end = start + task.duration;
+      for (int r = 0; r < num_resources; ++r) {
+        const int demand = task.resource_demands[r];
+        if (demand == 0) continue;
+        for (int64_t b = start / prices.bucket_width; b * prices.bucket_width < end; ++b) {
+          const int64_t overlap = std::min(end, (b + 1) * prices.bucket_width) -
+                                  std::max(start, b * prices.bucket_width);
+          load[r][std::min<int64_t>(b, prices.num_buckets - 1)] +=
+              static_cast<double>(overlap) * demand;
+        }
+      }
+    }
+    const double step = mean_weight / std::sqrt(iteration + 1.0);
+    result.peak_load = 0.0;
+    for (int r = 0; r < num_resources; ++r) {
+      const double bucket_capacity =
+          static_cast<double>(portfolio.resources[r].capacity) * prices.bucket_width;
+      if (bucket_capacity <= 0.0) continue;
+      for (int b = 0; b < prices.num_buckets; ++b) {
+        const double utilization = load[r][b] / bucket_capacity;
+        result.peak_load = std::max(result.peak_load, utilization);
+        prices.prices[r][b] = std::max(0.0, prices.prices[r][b] + step * (utilization - 1.0));
+      }
+    }
+  }
+  result.failed_project_solves = failed_solves;
+  return result;
+}
+
+#endif  // PORTFOLIO_H_
@@ -0,0 +1,163 @@
+#ifndef RCPSP_INSTANCE_H_
+#define RCPSP_INSTANCE_H_
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// RCPSP instance structure shared by driver, rcpsp_solver and the tools.
+struct Task {
+  int id;
+  std::string name;
+  int duration;
+  std::vector<int> successors;
+  std::vector<int> resource_demands;
+};
+
+struct Resource {
+  int capacity;
+};
+
+struct RCPSPInstance {
+  std::vector<Task> tasks;
+  std::vector<Resource> resources;
+  int horizon;
+};
+
+// Read-only accessors. Code templated on the instance type goes through
+// these, so it takes an RCPSPInstance or a PackedInstanceView
+// (packed_instances.h) alike.
+inline int TaskCount(const RCPSPInstance& instance) {
+  return static_cast<int>(instance.tasks.size());
+}
+inline int ResourceCount(const RCPSPInstance& instance) {
+  return static_cast<int>(instance.resources.size());
+}
+inline int InstanceHorizon(const RCPSPInstance& instance) {
+  return instance.horizon;
+}
+inline int ResourceCapacity(const RCPSPInstance& instance, int resource) {
+  return instance.resources[resource].capacity;
+}
+inline int TaskDuration(const RCPSPInstance& instance, int task) {
+  return instance.tasks[task].duration;
+}
+inline const std::vector<int>& TaskSuccessors(const RCPSPInstance& instance,
+                                              int task) {
+  return instance.tasks[task].successors;
+}
+inline int TaskDemand(const RCPSPInstance& instance, int task, int resource) {
+  return instance.tasks[task].resource_demands[resource];
+}
+inline const RCPSPInstance& ToInstance(const RCPSPInstance& instance) {
+  return instance;
+}
+
+// Predecessor lists derived from the successor lists.
+inline std::vector<std::vector<int>> ComputePredecessors(
+    const RCPSPInstance& instance) {
+  std::vector<std::vector<int>> predecessors(instance.tasks.size());
+  for (size_t i = 0; i < instance.tasks.size(); ++i) {
+    for (int succ : instance.tasks[i].successors) {
+      predecessors[succ].push_back(static_cast<int>(i));
+    }
+  }
+  return predecessors;
+}
+
+// Tasks in topological order of the precedence graph (Kahn's algorithm).
+inline std::vector<int> TopologicalOrder(const RCPSPInstance& instance) {
+  const int n = static_cast<int>(instance.tasks.size());
+  std::vector<int> in_degree(n, 0);
+  for (const Task& task : instance.tasks) {
+    for (int succ : task.successors) ++in_degree[succ];
+  }
+  std::vector<int> order;
+  order.reserve(n);
+  for (int i = 0; i < n; ++i) {
+    if (in_degree[i] == 0) order.push_back(i);
+  }
+  for (size_t head = 0; head < order.size(); ++head) {
+    for (int succ : instance.tasks[order[head]].successors) {
+      if (--in_degree[succ] == 0) order.push_back(succ);
+    }
+  }
+  return order;
+}
+
+// Reads an instance in the Patterson (.rcp) format used by the RCPSP
+// benchmark libraries:
+//
+//   <tasks> <resources>
+//   <capacity of each resource>
+//   one line per task: <duration> <demand per resource> <#succ> <succ ids>
+//
+// Successor ids are 1-based in the file. The dummy source and sink tasks are
+// kept as zero-duration tasks. The horizon is the sum of all durations.
+inline bool ReadPattersonInstance(const std::string& filename,
+                                  RCPSPInstance* instance) {
+  std::ifstream in(filename);
+  if (!in.is_open()) {
+    std::cerr << "Cannot open instance " << filename << std::endl;
+    return false;
+  }
+  int num_tasks = 0;
+  int num_resources = 0;
+  if (!(in >> num_tasks >> num_resources) || num_tasks <= 0 ||
+      num_resources < 0) {
+    std::cerr << "Invalid header in " << filename << std::endl;
+    return false;
+  }
+  instance->tasks.assign(num_tasks, Task());
+  instance->resources.assign(num_resources, Resource());
+  for (Resource& resource : instance->resources) {
+    in >> resource.capacity;
+  }
+  instance->horizon = 0;
+  for (int i = 0; i < num_tasks; ++i) {
+    Task& task = instance->tasks[i];
+    task.id = i;
+    task.name = "Task " + std::to_string(i);
+    task.resource_demands.assign(num_resources, 0);
+    int num_successors = 0;
+    in >> task.duration;
+    for (int& demand : task.resource_demands) in >> demand;
+    in >> num_successors;
+    for (int s = 0; s < num_successors; ++s) {
+      int succ = 0;
+      in >> succ;
+      if (succ < 1 || succ > num_tasks) {
+        std::cerr << "Invalid successor " << succ << " of task " << i + 1
+                  << " in " << filename << std::endl;
+        return false;
+      }
+      task.successors.push_back(succ - 1);
+    }
+    instance->horizon += task.duration;
+  }
+  if (!in) {
+    std::cerr << "Truncated instance " << filename << std::endl;
+    return false;
+  }
+  return true;
+}
+
+inline void WritePattersonInstance(const RCPSPInstance& instance,
+                                   std::ostream& out) {
+  out << instance.tasks.size() << " " << instance.resources.size() << "\n";
+  for (size_t r = 0; r < instance.resources.size(); ++r) {
+    out << (r > 0 ? " " : "") << instance.resources[r].capacity;
+  }
+  out << "\n";
+  for (const Task& task : instance.tasks) {
+    out << task.duration;
+    for (int demand : task.resource_demands) out << " " << demand;
+    out << " " << task.successors.size();
+    for (int succ : task.successors) out << " " << succ + 1;
+    out << "\n";
+  }
+}
+
+#endif  // RCPSP_INSTANCE_H_
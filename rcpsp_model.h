@@ -0,0 +1,91 @@
+#ifndef RCPSP_MODEL_H_
+#define RCPSP_MODEL_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "model_strengthening.h"
+#include "ortools/sat/cp_model.h"
+#include "rcpsp_instance.h"
+
+// The makespan model rcpsp_solver solves, shared with rcpsp_tune so that the
+// tuner measures exactly the model it tunes for.
+struct RcpspModel {
+  operations_research::sat::CpModelBuilder builder;
+  std::vector<operations_research::sat::IntervalVar> intervals;
+  std::vector<operations_research::sat::IntVar> starts;
+  // Proto indices of the start variables, in task order.
+  std::vector<int> start_variables;
+  operations_research::sat::IntVar makespan;
+  StrengtheningPlan plan;
+};
+
+// Builds the model of an RCPSPInstance or of a PackedInstanceView, read
+// through the accessors of rcpsp_instance.h. The strengthening analysis
+// works on an RCPSPInstance, so a view is unpacked for it.
+template <typename Instance>
+void BuildRcpspModel(const Instance& instance,
+                     const StrengtheningOptions& strengthening,
+                     RcpspModel* model) {
+  using operations_research::sat::CumulativeConstraint;
+  using operations_research::sat::IntervalVar;
+  using operations_research::sat::IntVar;
+  using operations_research::sat::LinearExpr;
+  operations_research::sat::CpModelBuilder& builder = model->builder;
+  const int num_tasks = TaskCount(instance);
+  const int num_resources = ResourceCount(instance);
+  const int horizon = InstanceHorizon(instance);
+
+  model->intervals.reserve(num_tasks);
+  model->starts.reserve(num_tasks);
+  model->start_variables.reserve(num_tasks);
+  for (int i = 0; i < num_tasks; ++i) {
+    const IntVar start = builder.NewIntVar({0, horizon});
+    const IntVar duration = builder.NewConstant(TaskDuration(instance, i));
+    const IntVar end = builder.NewIntVar({0, horizon});
+    model->intervals.push_back(builder.NewIntervalVar(start, duration, end));
+    model->starts.push_back(start);
+    model->start_variables.push_back(start.index());
+  }
+
+  for (int i = 0; i < num_tasks; ++i) {
+    for (const int succ : TaskSuccessors(instance, i)) {
+      builder.AddLessOrEqual(model->intervals[i].EndExpr(),
+                             model->intervals[succ].StartExpr());
+    }
+  }
+
+  if (strengthening.enabled) {
+    model->plan = AnalyzeInstance(ToInstance(instance), strengthening);
+  }
+
+  for (int r = 0; r < num_resources; ++r) {
+    if (model->plan.IsUnary(r)) continue;
+    int first_user = 0;
+    while (first_user < num_tasks && TaskDemand(instance, first_user, r) <= 0) {
+      ++first_user;
+    }
+    if (first_user == num_tasks) continue;
+    CumulativeConstraint cumulative = builder.AddCumulative(
+        builder.NewConstant(ResourceCapacity(instance, r)));
+    for (int i = first_user; i < num_tasks; ++i) {
+      const int demand = TaskDemand(instance, i, r);
+      if (demand > 0) cumulative.AddDemand(model->intervals[i], demand);
+    }
+  }
+
+  model->makespan = builder.NewIntVar({0, horizon});
+  std::vector<LinearExpr> ends;
+  ends.reserve(num_tasks);
+  for (const IntervalVar& interval : model->intervals) {
+    ends.push_back(interval.EndExpr());
+  }
+  builder.AddMaxEquality(model->makespan, ends);
+  builder.Minimize(model->makespan);
+
+  if (strengthening.enabled) {
+    ApplyStrengthening(model->plan, model->intervals, model->makespan, &builder);
+  }
+}
+
+#endif  // RCPSP_MODEL_H_
@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "packed_instances.h"
+#include "rcpsp_instance.h"
+
+// Packs Patterson instances into one memory-mappable repository for
+// `rcpsp_solver --repository=`.
+//
+//   rcpsp_pack --output=corpus.rcpk corpus/
+//   rcpsp_pack --output=j30.rcpk j30/j301_1.rcp j30/j301_2.rcp
+//   rcpsp_pack --list=corpus.rcpk
+//
+// Directories are searched recursively for .rcp files, which are packed in
+// path order; an instance is named by its path relative to the directory it
+// was found in.
+
+namespace {
+
+void PrintUsage() {
+  std::cerr << "Usage: rcpsp_pack --output=corpus.rcpk <dir|file.rcp>...\n"
+               "       rcpsp_pack --list=corpus.rcpk\n";
+}
+
+int ListRepository(const std::string& filename) {
+  PackedRepository repository;
+  std::string error;
+  if (!repository.Open(filename, &error)) {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+  for (int k = 0; k < repository.size(); ++k) {
+    const PackedInstanceView view = repository.instance(k);
+    size_t arcs = 0;
+    for (int i = 0; i < view.num_tasks(); ++i) arcs += view.successors(i).size();
+    std::cout << repository.name(k) << "\t" << view.num_tasks() << " tasks\t"
+              << view.num_resources() << " resources\t" << arcs << " arcs\n";
+  }
+  std::cerr << repository.size() << " instances" << std::endl;
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  namespace fs = std::filesystem;
+  std::string output;
+  std::string list;
+  // (path, name) of the instances to pack.
+  std::vector<std::pair<std::string, std::string>> inputs;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg.rfind("--output=", 0) == 0) {
+      output = arg.substr(9);
+    } else if (arg.rfind("--list=", 0) == 0) {
+      list = arg.substr(7);
+    } else if (arg.rfind("--", 0) == 0) {
+      std::cerr << "Unknown flag: " << arg << std::endl;
+      PrintUsage();
+      return 1;
+    } else if (fs::is_directory(arg)) {
+      std::vector<std::pair<std::string, std::string>> found;
+      for (const fs::directory_entry& entry : fs::recursive_directory_iterator(arg)) {
+        if (!entry.is_regular_file() || entry.path().extension() != ".rcp") continue;
+        found.emplace_back(entry.path().string(),
+                           fs::relative(entry.path(), arg).generic_string());
+      }
+      std::sort(found.begin(), found.end());
+      inputs.insert(inputs.end(), found.begin(), found.end());
+    } else {
+      inputs.emplace_back(arg, fs::path(arg).filename().string());
+    }
+  }
+  if (!list.empty()) return ListRepository(list);
+  if (output.empty() || inputs.empty()) {
+    PrintUsage();
+    return 1;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  PackedRepositoryWriter writer;
+  std::string error;
+  if (!writer.Open(output, &error)) {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+  size_t tasks = 0;
+  for (const auto& [path, name] : inputs) {
+    RCPSPInstance instance;
+    if (!ReadPattersonInstance(path, &instance)) return 1;
+    writer.Add(name, instance);
+    tasks += instance.tasks.size();
+  }
+  if (!writer.Close(&error)) {
+    std::cerr << output << ": " << error << std::endl;
+    return 1;
+  }
+  const double pack_ms = std::chrono::duration<double, std::milli>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+  std::cerr << output << ": " << writer.size() << " instances, " << tasks
+            << " tasks, packed in " << pack_ms << " ms" << std::endl;
+  return 0;
+}
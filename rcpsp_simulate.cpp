@@ -0,0 +1,801 @@
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "instance_generator.h"
+#include "json_escape.h"
+#include "rcpsp_instance.h"
+#include "schedule_network.h"
+#include "trace_reader.h"
+
+// Monte Carlo robustness evaluation of a schedule under stochastic durations.
+//
+//   rcpsp_simulate --instance=benchmarks/house.rcp --schedule=output.json
+//   rcpsp_simulate --instance=big.rcp --order=0,2,1,... --default=lognormal:0.3
+//
+// The schedule (or the serial schedule of a priority order) is chained into a
+// precedence and resource-flow network, so replaying a scenario is a longest
+// path over a fixed topological order. Scenarios are processed kLanes at a
+// time in structure-of-arrays blocks of SIMD vectors, and blocks are spread
+// over threads. Every block is seeded from its index, so results do not
+// depend on the number of threads.
+//
+// Durations follow per-task triangular, beta-PERT or lognormal distributions,
+// sampled by interpolating precomputed quantile tables.
+
+namespace {
+
+// Lanes per block: one native SIMD register of floats, so that every vector
+// operation below is a single instruction.
+#if defined(__AVX512F__)
+constexpr int kLanes = 16;
+#elif defined(__AVX__)
+constexpr int kLanes = 8;
+#else
+constexpr int kLanes = 4;
+#endif
+constexpr int kQuantiles = 256;
+constexpr int kTaskBins = 64;
+constexpr int kMakespanBins = 4096;
+
+// One value per scenario lane. GCC and Clang lower arithmetic, comparisons
+// and ?: on these types to the widest SIMD instructions of the target.
+typedef float FloatLanes __attribute__((vector_size(kLanes * sizeof(float))));
+typedef int32_t IntLanes __attribute__((vector_size(kLanes * sizeof(int32_t))));
+typedef uint32_t UintLanes __attribute__((vector_size(kLanes * sizeof(uint32_t))));
+typedef double DoubleLanes __attribute__((vector_size(kLanes * sizeof(double))));
+
+// ---------------------------------------------------------------------------
+// Duration distributions
+// ---------------------------------------------------------------------------
+
+enum class DistributionKind { FIXED, TRIANGULAR, PERT, LOGNORMAL };
+
+struct Distribution {
+  DistributionKind kind = DistributionKind::FIXED;
+  // FIXED: a. TRIANGULAR and PERT: min a, mode b, max c. LOGNORMAL: median a,
+  // sigma b.
+  double a = 0.0;
+  double b = 0.0;
+  double c = 0.0;
+};
+
+// Default distribution relative to each nominal duration, e.g. "pert:0.8:1.5"
+// (min and max as factors of the nominal duration, which is the mode) or
+// "lognormal:0.3" (the nominal duration is the median).
+struct DefaultDistribution {
+  DistributionKind kind = DistributionKind::PERT;
+  double low = 0.8;
+  double high = 1.5;
+  std::string spec = "pert:0.8:1.5";
+
+  bool Parse(const std::string& text) {
+    std::vector<std::string> parts;
+    std::stringstream ss(text);
+    for (std::string part; std::getline(ss, part, ':');) parts.push_back(part);
+    if (parts.empty()) return false;
+    spec = text;
+    if (parts[0] == "fixed" && parts.size() == 1) {
+      kind = DistributionKind::FIXED;
+    } else if ((parts[0] == "pert" || parts[0] == "triangular") && parts.size() == 3) {
+      kind = parts[0] == "pert" ? DistributionKind::PERT : DistributionKind::TRIANGULAR;
+      low = std::atof(parts[1].c_str());
+      high = std::atof(parts[2].c_str());
+      return low <= 1.0 && high >= 1.0;
+    } else if (parts[0] == "lognormal" && parts.size() == 2) {
+      kind = DistributionKind::LOGNORMAL;
+      low = std::atof(parts[1].c_str());
+      return low >= 0.0;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  Distribution For(int duration) const {
+    Distribution distribution;
+    distribution.kind = kind;
+    if (kind == DistributionKind::FIXED) {
+      distribution.a = duration;
+    } else if (kind == DistributionKind::LOGNORMAL) {
+      distribution.a = duration;
+      distribution.b = low;
+    } else {
+      distribution.a = low * duration;
+      distribution.b = duration;
+      distribution.c = high * duration;
+    }
+    return distribution;
+  }
+};
+
+// Reads per-task overrides, one per line:
+//   <task> fixed <d> | triangular <min> <mode> <max> | pert <min> <mode> <max>
+//   | lognormal <median> <sigma>
+// Task ids are 0-based like the taskId of the traces. '#' starts a comment.
+bool ReadDistributions(const std::string& filename, std::vector<Distribution>* out) {
+  std::ifstream in(filename);
+  if (!in.is_open()) {
+    std::cerr << "Cannot open " << filename << std::endl;
+    return false;
+  }
+  int line_number = 0;
+  for (std::string line; std::getline(in, line);) {
+    ++line_number;
+    line = line.substr(0, line.find('#'));
+    std::istringstream fields(line);
+    int task = -1;
+    std::string kind;
+    if (!(fields >> task)) continue;
+    fields >> kind;
+    Distribution distribution;
+    bool ok = task >= 0 && task < static_cast<int>(out->size());
+    if (kind == "fixed") {
+      distribution.kind = DistributionKind::FIXED;
+      ok = ok && static_cast<bool>(fields >> distribution.a);
+    } else if (kind == "triangular" || kind == "pert") {
+      distribution.kind =
+          kind == "pert" ? DistributionKind::PERT : DistributionKind::TRIANGULAR;
+      ok = ok && static_cast<bool>(fields >> distribution.a >> distribution.b >> distribution.c) &&
+           distribution.a <= distribution.b && distribution.b <= distribution.c;
+    } else if (kind == "lognormal") {
+      distribution.kind = DistributionKind::LOGNORMAL;
+      ok = ok && static_cast<bool>(fields >> distribution.a >> distribution.b) &&
+           distribution.a > 0.0;
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      std::cerr << filename << ":" << line_number << ": invalid distribution" << std::endl;
+      return false;
+    }
+    (*out)[task] = distribution;
+  }
+  return true;
+}
+
+// Inverse CDF of a density on [lo, hi], tabulated at u = k / kQuantiles.
+std::vector<double> InvertDensity(const std::function<double(double)>& density,
+                                  double lo, double hi) {
+  constexpr int kCells = 8192;
+  std::vector<double> cdf(kCells + 1, 0.0);
+  const double width = (hi - lo) / kCells;
+  for (int i = 0; i < kCells; ++i) {
+    cdf[i + 1] = cdf[i] + density(lo + (i + 0.5) * width);
+  }
+  std::vector<double> quantiles(kQuantiles + 1);
+  int cell = 0;
+  for (int k = 0; k <= kQuantiles; ++k) {
+    const double target = cdf[kCells] * k / kQuantiles;
+    while (cell < kCells - 1 && cdf[cell + 1] < target) ++cell;
+    const double mass = cdf[cell + 1] - cdf[cell];
+    const double fraction = mass > 0.0 ? (target - cdf[cell]) / mass : 0.0;
+    quantiles[k] = lo + (cell + std::min(1.0, std::max(0.0, fraction))) * width;
+  }
+  return quantiles;
+}
+
+// Fills table[0..kQuantiles] with the quantiles of the distribution.
+void FillQuantiles(const Distribution& distribution, float* table) {
+  switch (distribution.kind) {
+    case DistributionKind::FIXED:
+      std::fill(table, table + kQuantiles + 1, static_cast<float>(distribution.a));
+      return;
+    case DistributionKind::TRIANGULAR: {
+      const double a = distribution.a, m = distribution.b, b = distribution.c;
+      for (int k = 0; k <= kQuantiles; ++k) {
+        const double u = static_cast<double>(k) / kQuantiles;
+        double value = a;
+        if (b > a) {
+          value = u < (m - a) / (b - a) ? a + std::sqrt(u * (b - a) * (m - a))
+                                        : b - std::sqrt((1.0 - u) * (b - a) * (b - m));
+        }
+        table[k] = static_cast<float>(value);
+      }
+      return;
+    }
+    case DistributionKind::PERT: {
+      const double a = distribution.a, m = distribution.b, b = distribution.c;
+      if (b <= a) {
+        std::fill(table, table + kQuantiles + 1, static_cast<float>(a));
+        return;
+      }
+      const double alpha = 1.0 + 4.0 * (m - a) / (b - a);
+      const double beta = 1.0 + 4.0 * (b - m) / (b - a);
+      const std::vector<double> unit = InvertDensity(
+          [&](double x) { return std::pow(x, alpha - 1.0) * std::pow(1.0 - x, beta - 1.0); },
+          0.0, 1.0);
+      for (int k = 0; k <= kQuantiles; ++k) {
+        table[k] = static_cast<float>(a + unit[k] * (b - a));
+      }
+      return;
+    }
+    case DistributionKind::LOGNORMAL: {
+      // The normal is truncated at five standard deviations.
+      const std::vector<double> normal =
+          InvertDensity([](double z) { return std::exp(-0.5 * z * z); }, -5.0, 5.0);
+      for (int k = 0; k <= kQuantiles; ++k) {
+        table[k] = static_cast<float>(distribution.a * std::exp(distribution.b * normal[k]));
+      }
+      return;
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Replay kernel
+// ---------------------------------------------------------------------------
+
+// Everything a thread accumulates; merged once all blocks are done.
+struct ReplayStats {
+  int64_t replays = 0;
+  int64_t on_time = 0;
+  double makespan_sum = 0.0;
+  double makespan_sum_squares = 0.0;
+  float makespan_min = INFINITY;
+  float makespan_max = 0.0f;
+  std::vector<uint64_t> makespan_histogram;
+  std::vector<uint64_t> critical;        // per task
+  std::vector<double> finish_sum;        // per task
+  std::vector<uint32_t> finish_histogram;  // per task, kTaskBins each
+
+  explicit ReplayStats(int num_tasks)
+      : makespan_histogram(kMakespanBins, 0),
+        critical(num_tasks, 0),
+        finish_sum(num_tasks, 0.0),
+        finish_histogram(static_cast<size_t>(num_tasks) * kTaskBins, 0) {}
+
+  void Merge(const ReplayStats& other) {
+    replays += other.replays;
+    on_time += other.on_time;
+    makespan_sum += other.makespan_sum;
+    makespan_sum_squares += other.makespan_sum_squares;
+    makespan_min = std::min(makespan_min, other.makespan_min);
+    makespan_max = std::max(makespan_max, other.makespan_max);
+    for (size_t i = 0; i < makespan_histogram.size(); ++i) {
+      makespan_histogram[i] += other.makespan_histogram[i];
+    }
+    for (size_t i = 0; i < critical.size(); ++i) {
+      critical[i] += other.critical[i];
+      finish_sum[i] += other.finish_sum[i];
+    }
+    for (size_t i = 0; i < finish_histogram.size(); ++i) {
+      finish_histogram[i] += other.finish_histogram[i];
+    }
+  }
+};
+
+// Bounds used to bin finish times and makespans: the earliest finishes with
+// every duration at its minimum and at its maximum quantile.
+struct Bins {
+  std::vector<float> finish_lo;
+  std::vector<float> finish_scale;  // bins per time unit
+  float makespan_lo = 0.0f;
+  float makespan_scale = 0.0f;
+};
+
+class ReplayKernel {
+ public:
+  ReplayKernel(const ScheduleNetwork& network, const std::vector<float>& quantiles,
+               const Bins& bins, uint64_t seed)
+      : network_(network),
+        quantiles_(quantiles),
+        bins_(bins),
+        seed_(seed),
+        start_(network.num_tasks),
+        finish_(network.num_tasks),
+        critical_(network.num_tasks),
+        critical_count_(network.num_tasks, IntLanes{}),
+        finish_sum_(network.num_tasks, DoubleLanes{}) {}
+
+  // Replays kLanes scenarios seeded from `block`.
+  void RunBlock(uint64_t block, ReplayStats* stats) {
+    SplitMix64 seeder(seed_ ^ (block * 0xD1B54A32D192ED03ULL));
+    UintLanes rng;
+    for (int l = 0; l < kLanes; ++l) rng[l] = static_cast<uint32_t>(seeder.Next()) | 1u;
+
+    // Forward pass: earliest starts over the network in topological order.
+    const FloatLanes zero = {};
+    for (int task : network_.order) {
+      FloatLanes start = zero;
+      for (int a = network_.predecessor_offsets[task];
+           a < network_.predecessor_offsets[task + 1]; ++a) {
+        const FloatLanes pred_finish = finish_[network_.predecessors[a]];
+        start = start > pred_finish ? start : pred_finish;
+      }
+      // xorshift32 per lane, then linear interpolation in the quantile table.
+      rng ^= rng << 13;
+      rng ^= rng >> 17;
+      rng ^= rng << 5;
+      const FloatLanes position =
+          __builtin_convertvector(rng >> 8, FloatLanes) * (kQuantiles / 16777216.0f);
+      const IntLanes index = __builtin_convertvector(position, IntLanes);
+      const FloatLanes fraction = position - __builtin_convertvector(index, FloatLanes);
+      const float* table = quantiles_.data() + static_cast<size_t>(task) * (kQuantiles + 1);
+      FloatLanes low;
+      FloatLanes high;
+      for (int l = 0; l < kLanes; ++l) {
+        low[l] = table[index[l]];
+        high[l] = table[index[l] + 1];
+      }
+      start_[task] = start;
+      finish_[task] = start + low + fraction * (high - low);
+    }
+
+    FloatLanes makespan = zero;
+    for (int task = 0; task < network_.num_tasks; ++task) {
+      makespan = makespan > finish_[task] ? makespan : finish_[task];
+    }
+
+    // Backward pass: a task is critical when it ends the project or a
+    // critical successor starts exactly when it finishes. Masks are all ones
+    // (-1) or zero, so subtracting them counts.
+    for (auto it = network_.order.rbegin(); it != network_.order.rend(); ++it) {
+      const int task = *it;
+      const FloatLanes finish = finish_[task];
+      IntLanes critical = finish == makespan;
+      for (int a = network_.successor_offsets[task];
+           a < network_.successor_offsets[task + 1]; ++a) {
+        const int succ = network_.successors[a];
+        critical |= (start_[succ] == finish) & critical_[succ];
+      }
+      critical_[task] = critical;
+      critical_count_[task] -= critical;
+      finish_sum_[task] += __builtin_convertvector(finish, DoubleLanes);
+
+      uint32_t* histogram = stats->finish_histogram.data() + static_cast<size_t>(task) * kTaskBins;
+      const IntLanes bin = Bin(finish, bins_.finish_lo[task], bins_.finish_scale[task], kTaskBins);
+      for (int l = 0; l < kLanes; ++l) ++histogram[bin[l]];
+    }
+
+    const IntLanes bin = Bin(makespan, bins_.makespan_lo, bins_.makespan_scale, kMakespanBins);
+    const float on_time = network_.nominal_makespan + 1e-3f;
+    for (int l = 0; l < kLanes; ++l) {
+      const float value = makespan[l];
+      stats->makespan_sum += value;
+      stats->makespan_sum_squares += static_cast<double>(value) * value;
+      stats->makespan_min = std::min(stats->makespan_min, value);
+      stats->makespan_max = std::max(stats->makespan_max, value);
+      stats->on_time += value <= on_time ? 1 : 0;
+      ++stats->makespan_histogram[bin[l]];
+    }
+    stats->replays += kLanes;
+  }
+
+  // Moves the per-lane accumulators into `stats`.
+  void Flush(ReplayStats* stats) {
+    for (int task = 0; task < network_.num_tasks; ++task) {
+      for (int l = 0; l < kLanes; ++l) {
+        stats->critical[task] += static_cast<uint32_t>(critical_count_[task][l]);
+        stats->finish_sum[task] += finish_sum_[task][l];
+      }
+      critical_count_[task] = IntLanes{};
+      finish_sum_[task] = DoubleLanes{};
+    }
+  }
+
+ private:
+  static IntLanes Bin(FloatLanes value, float lo, float scale, int bins) {
+    IntLanes bin = __builtin_convertvector((value - lo) * scale, IntLanes);
+    const IntLanes first = {};
+    const IntLanes last = first + (bins - 1);
+    bin = bin < first ? first : bin;
+    return bin > last ? last : bin;
+  }
+
+  const ScheduleNetwork& network_;
+  const std::vector<float>& quantiles_;
+  const Bins& bins_;
+  const uint64_t seed_;
+  std::vector<FloatLanes> start_;
+  std::vector<FloatLanes> finish_;
+  std::vector<IntLanes> critical_;
+  std::vector<IntLanes> critical_count_;
+  std::vector<DoubleLanes> finish_sum_;
+};
+
+// Value below which `fraction` of the binned samples fall.
+double HistogramPercentile(const uint64_t* histogram, const uint32_t* histogram32,
+                           int bins, uint64_t total, double lo, double scale,
+                           double fraction) {
+  const double target = fraction * total;
+  double cumulative = 0.0;
+  for (int b = 0; b < bins; ++b) {
+    const double count = histogram != nullptr ? histogram[b] : histogram32[b];
+    if (cumulative + count >= target && count > 0) {
+      const double within = (target - cumulative) / count;
+      return lo + (b + within) / scale;
+    }
+    cumulative += count;
+  }
+  return lo + bins / scale;
+}
+
+// ---------------------------------------------------------------------------
+// Schedule input
+// ---------------------------------------------------------------------------
+
+// Reads the final schedule from a driver trace (the "Final solution" start
+// events), an rcpsp_solver output (start events with "time"), or the last
+// incumbent of either.
+bool ReadSchedule(const std::string& filename, int num_tasks,
+                  std::vector<int64_t>* starts, bool* event_file) {
+  TraceReader reader(filename);
+  if (!reader.is_open()) {
+    std::cerr << "Cannot open " << filename << std::endl;
+    return false;
+  }
+  *event_file = reader.is_event_file();
+  starts->assign(num_tasks, -1);
+  bool from_events = false;
+  std::vector<int64_t> last_incumbent;
+  TraceEvent event;
+  while (reader.Next(&event)) {
+    if (event.type == "start" && event.task_id >= 0 && event.task_id < num_tasks) {
+      if (event.DescriptionStartsWith("Final solution")) {
+        (*starts)[event.task_id] = event.start_time;
+        from_events = true;
+      } else if (event.description.empty()) {
+        (*starts)[event.task_id] = event.time;
+        from_events = true;
+      }
+    }
+    if (event.type == "incumbent" && !event.solution.empty()) {
+      last_incumbent = event.solution;
+    }
+  }
+  if (!from_events && !last_incumbent.empty()) *starts = last_incumbent;
+  if (!from_events && last_incumbent.empty()) {
+    std::cerr << "No schedule found in " << filename << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Parses the --order= list, which must name every task id in 0..n-1 once.
+bool ParseOrder(const std::string& list, int num_tasks, std::vector<int>* priority) {
+  std::vector<bool> seen(num_tasks, false);
+  priority->clear();
+  std::stringstream ss(list);
+  for (std::string item; std::getline(ss, item, ',');) {
+    char* end = nullptr;
+    const long id = std::strtol(item.c_str(), &end, 10);
+    if (item.empty() || *end != '\0' || id < 0 || id >= num_tasks) {
+      std::cerr << "Invalid task id \"" << item << "\" in --order; ids run from 0 to "
+                << num_tasks - 1 << std::endl;
+      return false;
+    }
+    if (seen[id]) {
+      std::cerr << "Task " << id << " is listed twice in --order" << std::endl;
+      return false;
+    }
+    seen[id] = true;
+    priority->push_back(static_cast<int>(id));
+  }
+  if (static_cast<int>(priority->size()) != num_tasks) {
+    std::cerr << "--order lists " << priority->size() << " of " << num_tasks
+              << " tasks; it must be a permutation of 0.." << num_tasks - 1 << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// A member of the top-level JSON object, from the opening quote of its key
+// to the end of its value.
+struct JsonMember {
+  std::string key;
+  size_t begin;
+  size_t end;
+};
+
+// The members of the top-level object in `json`. Strings are skipped, so
+// braces and commas inside task names do not count.
+std::vector<JsonMember> TopLevelMembers(const std::string& json) {
+  std::vector<JsonMember> members;
+  size_t i = json.find('{');
+  if (i == std::string::npos) return members;
+  auto skip_whitespace = [&]() {
+    while (i < json.size() && std::isspace(static_cast<unsigned char>(json[i]))) ++i;
+  };
+  for (++i;;) {
+    skip_whitespace();
+    if (i >= json.size() || json[i] != '"') return members;
+    JsonMember member;
+    member.begin = i;
+    for (++i; i < json.size() && json[i] != '"'; ++i) {
+      if (json[i] == '\\') ++i;
+    }
+    member.key = json.substr(member.begin + 1, i - member.begin - 1);
+    i = json.find(':', i);
+    if (i == std::string::npos) return members;
+    int depth = 0;
+    bool in_string = false;
+    for (++i; i < json.size(); ++i) {
+      const char c = json[i];
+      if (in_string) {
+        if (c == '\\') {
+          ++i;
+        } else if (c == '"') {
+          in_string = false;
+        }
+      } else if (c == '"') {
+        in_string = true;
+      } else if (c == '{' || c == '[') {
+        ++depth;
+      } else if (c == '}' || c == ']') {
+        if (depth-- == 0) break;
+      } else if (c == ',' && depth == 0) {
+        break;
+      }
+    }
+    member.end = i;
+    while (member.end > member.begin &&
+           std::isspace(static_cast<unsigned char>(json[member.end - 1]))) {
+      --member.end;
+    }
+    members.push_back(member);
+    if (i >= json.size() || json[i] != ',') return members;
+    ++i;
+  }
+}
+
+std::string RiskToJson(const RCPSPInstance& instance, const ScheduleNetwork& network,
+                       const ReplayStats& stats, const Bins& bins,
+                       const std::string& distribution, int num_threads,
+                       double seconds) {
+  const double n = static_cast<double>(stats.replays);
+  const double mean = stats.makespan_sum / n;
+  const double variance = std::max(0.0, stats.makespan_sum_squares / n - mean * mean);
+  auto makespan_percentile = [&](double fraction) {
+    return HistogramPercentile(stats.makespan_histogram.data(), nullptr, kMakespanBins,
+                               stats.replays, bins.makespan_lo, bins.makespan_scale,
+                               fraction);
+  };
+
+  std::ostringstream json;
+  json << "{\n";
+  json << "    \"replays\": " << stats.replays << ",\n";
+  json << "    \"threads\": " << num_threads << ",\n";
+  json << "    \"seconds\": " << seconds << ",\n";
+  json << "    \"replaysPerSecond\": " << (seconds > 0.0 ? n / seconds : 0.0) << ",\n";
+  json << "    \"distribution\": \"" << JsonEscaped(distribution) << "\",\n";
+  json << "    \"precedenceArcs\": " << network.num_precedence_arcs << ",\n";
+  json << "    \"flowArcs\": " << network.num_flow_arcs << ",\n";
+  json << "    \"nominalMakespan\": " << network.nominal_makespan << ",\n";
+  json << "    \"onTimeProbability\": " << stats.on_time / n << ",\n";
+  json << "    \"makespan\": {\"mean\": " << mean << ", \"std\": " << std::sqrt(variance)
+       << ", \"min\": " << stats.makespan_min << ", \"max\": " << stats.makespan_max;
+  for (int p : {5, 10, 25, 50, 75, 90, 95, 99}) {
+    json << ", \"p" << p << "\": " << makespan_percentile(p / 100.0);
+  }
+  json << "},\n";
+  json << "    \"tasks\": [";
+  for (int i = 0; i < network.num_tasks; ++i) {
+    const uint32_t* histogram = stats.finish_histogram.data() + static_cast<size_t>(i) * kTaskBins;
+    auto finish_percentile = [&](double fraction) {
+      return HistogramPercentile(nullptr, histogram, kTaskBins, stats.replays,
+                                 bins.finish_lo[i], bins.finish_scale[i], fraction);
+    };
+    json << (i > 0 ? "," : "") << "\n      {\"taskId\": " << i << ", \"taskName\": \""
+         << JsonEscaped(instance.tasks[i].name) << "\", \"criticality\": " << stats.critical[i] / n
+         << ", \"meanFinish\": " << stats.finish_sum[i] / n
+         << ", \"finishP10\": " << finish_percentile(0.10)
+         << ", \"finishP50\": " << finish_percentile(0.50)
+         << ", \"finishP90\": " << finish_percentile(0.90) << "}";
+  }
+  json << "\n    ]\n  }";
+  return json.str();
+}
+
+void PrintUsage() {
+  std::cerr << "Usage: rcpsp_simulate (--instance=file.rcp | generator flags)\n"
+               "                      [--schedule=output.json | --order=i,j,...]\n"
+               "                      [--durations=file] [--default=pert:0.8:1.5]\n"
+               "                      [--replays=N] [--threads=N] [--replay_seed=S]\n"
+               "                      [--output=file.json]\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string instance_file;
+  std::string schedule_file;
+  std::string order_list;
+  std::string durations_file;
+  std::string output_file;
+  DefaultDistribution default_distribution;
+  GeneratorParams generator;
+  bool generate = false;
+  int64_t replays = 100000;
+  int num_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  uint64_t seed = 1;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg.rfind("--instance=", 0) == 0) {
+      instance_file = arg.substr(11);
+    } else if (arg.rfind("--schedule=", 0) == 0) {
+      schedule_file = arg.substr(11);
+    } else if (arg.rfind("--order=", 0) == 0) {
+      order_list = arg.substr(8);
+    } else if (arg.rfind("--durations=", 0) == 0) {
+      durations_file = arg.substr(12);
+    } else if (arg.rfind("--default=", 0) == 0) {
+      if (!default_distribution.Parse(arg.substr(10))) {
+        std::cerr << "Invalid distribution: " << arg << std::endl;
+        return 1;
+      }
+    } else if (arg.rfind("--replays=", 0) == 0) {
+      replays = std::atoll(arg.c_str() + 10);
+    } else if (arg.rfind("--threads=", 0) == 0) {
+      num_threads = std::max(1, std::atoi(arg.c_str() + 10));
+    } else if (arg.rfind("--replay_seed=", 0) == 0) {
+      seed = std::strtoull(arg.c_str() + 14, nullptr, 10);
+    } else if (arg.rfind("--output=", 0) == 0) {
+      output_file = arg.substr(9);
+    } else if (generator.ParseFlag(arg)) {
+      generate = true;
+    } else {
+      std::cerr << "Unknown flag: " << arg << std::endl;
+      PrintUsage();
+      return 1;
+    }
+  }
+  if (instance_file.empty() && !generate) {
+    PrintUsage();
+    return 1;
+  }
+
+  RCPSPInstance instance;
+  std::string error;
+  if (generate) {
+    if (!generator.Validate(&error)) {
+      std::cerr << error << std::endl;
+      return 1;
+    }
+    instance = GenerateInstance(generator);
+  } else if (!ReadPattersonInstance(instance_file, &instance)) {
+    return 1;
+  }
+  const int n = static_cast<int>(instance.tasks.size());
+
+  // The schedule to evaluate.
+  std::vector<int64_t> starts;
+  bool event_file = false;
+  if (!schedule_file.empty()) {
+    if (!ReadSchedule(schedule_file, n, &starts, &event_file)) return 1;
+  } else {
+    if (!DemandsFitCapacities(instance, &error)) {
+      std::cerr << "No feasible schedule: " << error << std::endl;
+      return 1;
+    }
+    std::vector<int> priority;
+    if (order_list.empty()) {
+      priority = TopologicalOrder(instance);
+    } else if (!ParseOrder(order_list, n, &priority)) {
+      return 1;
+    }
+    starts = SerialSchedule(instance, priority);
+    if (starts.empty()) {
+      std::cerr << "The priority order must list every task after its predecessors"
+                << std::endl;
+      return 1;
+    }
+  }
+  if (!IsFeasibleSchedule(instance, starts, &error)) {
+    std::cerr << "Infeasible schedule: " << error << std::endl;
+    return 1;
+  }
+  const ScheduleNetwork network = BuildScheduleNetwork(instance, starts);
+
+  std::vector<Distribution> distributions(n);
+  for (int i = 0; i < n; ++i) {
+    distributions[i] = default_distribution.For(instance.tasks[i].duration);
+  }
+  if (!durations_file.empty() && !ReadDistributions(durations_file, &distributions)) {
+    return 1;
+  }
+  std::vector<float> quantiles(static_cast<size_t>(n) * (kQuantiles + 1));
+  std::vector<float> shortest(n);
+  std::vector<float> longest(n);
+  for (int i = 0; i < n; ++i) {
+    float* table = quantiles.data() + static_cast<size_t>(i) * (kQuantiles + 1);
+    FillQuantiles(distributions[i], table);
+    shortest[i] = table[0];
+    longest[i] = table[kQuantiles];
+  }
+
+  Bins bins;
+  const std::vector<float> early = NetworkEarliestStarts(network, shortest);
+  const std::vector<float> late = NetworkEarliestStarts(network, longest);
+  bins.finish_lo.resize(n);
+  bins.finish_scale.resize(n);
+  float makespan_hi = 0.0f;
+  bins.makespan_lo = INFINITY;
+  for (int i = 0; i < n; ++i) {
+    bins.finish_lo[i] = early[i] + shortest[i];
+    const float range = std::max(1e-3f, late[i] + longest[i] - bins.finish_lo[i]);
+    bins.finish_scale[i] = kTaskBins / range;
+    makespan_hi = std::max(makespan_hi, late[i] + longest[i]);
+  }
+  bins.makespan_lo = 0.0f;
+  for (int i = 0; i < n; ++i) bins.makespan_lo = std::max(bins.makespan_lo, bins.finish_lo[i]);
+  bins.makespan_scale = kMakespanBins / std::max(1e-3f, makespan_hi - bins.makespan_lo);
+
+  std::cout << "Simulating " << n << " tasks, " << network.num_precedence_arcs
+            << " precedence and " << network.num_flow_arcs << " resource-flow arcs, "
+            << "nominal makespan " << network.nominal_makespan << std::endl;
+
+  const uint64_t num_blocks = static_cast<uint64_t>((std::max<int64_t>(1, replays) + kLanes - 1) / kLanes);
+  const auto start_time = std::chrono::steady_clock::now();
+  std::vector<ReplayStats> thread_stats(num_threads, ReplayStats(n));
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      ReplayKernel kernel(network, quantiles, bins, seed);
+      for (uint64_t block = t; block < num_blocks; block += num_threads) {
+        kernel.RunBlock(block, &thread_stats[t]);
+        // Per-lane counters are 32-bit; flush them well before they wrap.
+        if ((block / num_threads) % 65536 == 65535) kernel.Flush(&thread_stats[t]);
+      }
+      kernel.Flush(&thread_stats[t]);
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  for (int t = 1; t < num_threads; ++t) thread_stats[0].Merge(thread_stats[t]);
+  const ReplayStats& stats = thread_stats[0];
+  const double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+  const std::string risk = RiskToJson(instance, network, stats, bins, default_distribution.spec,
+                                      num_threads, seconds);
+  const double mean = stats.makespan_sum / stats.replays;
+  std::cout << stats.replays << " replays in " << seconds << " s ("
+            << stats.replays / std::max(seconds, 1e-9) << " per second)" << std::endl;
+  std::cout << "Makespan mean " << mean << ", on time with probability "
+            << static_cast<double>(stats.on_time) / stats.replays << std::endl;
+
+  // An events file gets a "risk" field next to its events so that the
+  // frontend can draw risk bands on the same schedule. The field of an
+  // earlier run, e.g. on a -risk.json file, is replaced.
+  std::string json;
+  if (event_file) {
+    std::ifstream in(schedule_file);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    json = contents.str();
+    const std::vector<JsonMember> members = TopLevelMembers(json);
+    for (size_t m = 0; m < members.size(); ++m) {
+      if (members[m].key != "risk") continue;
+      const size_t from = m > 0 ? members[m - 1].end : members[m].begin;
+      const size_t to = m > 0 || m + 1 == members.size() ? members[m].end : members[m + 1].begin;
+      json.erase(from, to - from);
+      break;
+    }
+    const size_t close = json.find_last_of('}');
+    json = json.substr(0, close);
+    while (!json.empty() && std::isspace(static_cast<unsigned char>(json.back()))) json.pop_back();
+    json += ",\n  \"risk\": " + risk + "\n}\n";
+    if (output_file.empty()) {
+      const size_t dot = schedule_file.rfind(".json");
+      output_file = schedule_file.substr(0, dot) + "-risk.json";
+    }
+  } else {
+    json = "{\n  \"risk\": " + risk + "\n}\n";
+    if (output_file.empty()) output_file = "risk.json";
+  }
+  std::ofstream out(output_file);
+  out << json;
+  std::cout << "Risk profile written to " << output_file << std::endl;
+  return 0;
+}
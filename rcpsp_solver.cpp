@@ -1,33 +1,33 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
 #include <vector>
 #include <string>
 #include <sstream>
+#include <thread>
 #include "ortools/sat/cp_model.h"
 #include "ortools/sat/cp_model.pb.h"
 #include "ortools/sat/cp_model_solver.h"
+#include "ortools/sat/model.h"
+#include "incumbent_stream.h"
+#include "instance_generator.h"
+#include "json_escape.h"
+#include "lower_bounds.h"
+#include "model_strengthening.h"
+#include "packed_instances.h"
+#include "portfolio.h"
+#include "rcpsp_instance.h"
+#include "rcpsp_model.h"
+#include "rolling_horizon.h"
+#include "sensitivity.h"
+#include "solver_config.h"
+#include "timeline.h"
 
 using namespace operations_research;
 using namespace sat;
 
-struct Task {
-    int id;
-    int duration;
-    std::vector<int> successors;
-    std::vector<int> predecessors;
-    std::vector<int> resource_demands;
-};
-
-struct Resource {
-    int capacity;
-};
-
-struct RCPSPInstance {
-    std::vector<Task> tasks;
-    std::vector<Resource> resources;
-    int horizon;
-};
-
 RCPSPInstance createSimpleInstance() {
     RCPSPInstance instance;
     
@@ -37,73 +37,124 @@ RCPSPInstance createSimpleInstance() {
     instance.resources[0].capacity = 3;
     instance.resources[1].capacity = 2;
     
-    instance.tasks[0] = {0, 3, {1}, {}, {2, 1}};
-    instance.tasks[1] = {1, 4, {2}, {0}, {1, 2}};
-    instance.tasks[2] = {2, 2, {3}, {1}, {2, 1}};
-    instance.tasks[3] = {3, 5, {4}, {2}, {1, 1}};
-    instance.tasks[4] = {4, 3, {}, {3}, {2, 0}};
+    instance.tasks[0] = {0, "Task 0", 3, {1}, {2, 1}};
+    instance.tasks[1] = {1, "Task 1", 4, {2}, {1, 2}};
+    instance.tasks[2] = {2, "Task 2", 2, {3}, {2, 1}};
+    instance.tasks[3] = {3, "Task 3", 5, {4}, {1, 1}};
+    instance.tasks[4] = {4, "Task 4", 3, {}, {2, 0}};
     
     instance.horizon = 20;
     
     return instance;
 }
 
-std::string solveRCPSP(const RCPSPInstance& instance) {
-    CpModelBuilder model;
+// Writes the schedule in the output format read by the frontend. `starts` is
+// empty when no feasible schedule was found.
+std::string scheduleJson(const RCPSPInstance& instance, const std::vector<int64_t>& starts,
+                         int64_t makespan, double best_bound, double wall_time,
+                         const IncumbentStream& incumbents, const std::string& extra_fields) {
+    std::stringstream json;
+    json << "{\n";
+    json << "  \"events\": [\n";
+    for (size_t i = 0; i < starts.size(); ++i) {
+        const int64_t end = starts[i] + instance.tasks[i].duration;
+        json << "    {\"type\": \"start\", \"taskId\": " << i << ", \"time\": " << starts[i] << "},\n";
+        json << "    {\"type\": \"complete\", \"taskId\": " << i << ", \"time\": " << end << "}";
+        if (i + 1 < starts.size()) json << ",";
+        json << "\n";
+    }
+    json << "  ],\n";
+    json << "  \"makespan\": " << makespan << ",\n";
+    json << "  \"bestBound\": " << best_bound << ",\n";
+    json << "  \"wallTime\": " << wall_time << ",\n";
+    json << extra_fields;
+    json << "  \"incumbents\": [";
+    for (size_t i = 0; i < incumbents.incumbents().size(); ++i) {
+        if (i > 0) json << ",";
+        json << "\n    " << incumbents.incumbents()[i].ToJson();
+    }
+    json << "\n  ],\n";
+    json << "  \"bounds\": [";
+    for (size_t i = 0; i < incumbents.bounds().size(); ++i) {
+        if (i > 0) json << ",";
+        json << "\n    " << incumbents.bounds()[i].ToJson();
+    }
+    json << "\n  ],\n";
+    json << "  \"stopReason\": \"" << incumbents.stop_reason() << "\"\n";
+    json << "}\n";
     
-    std::vector<IntervalVar> intervals;
+    return json.str();
+}
+
+std::string solveRCPSP(const RCPSPInstance& instance, const StopPolicy& stop_policy,
+                       const SolverConfig& config, const StrengtheningOptions& strengthening,
+                       const ProbeOptions& probing, const SensitivityOptions& sensitivity,
+                       Timeline* timeline) {
+    Model solver_model;
+    IncumbentStream incumbents(stop_policy, [&solver_model]() { StopSearch(&solver_model); });
     
-    for (int i = 0; i < instance.tasks.size(); ++i) {
-        const auto& task = instance.tasks[i];
-        IntVar start = model.NewIntVar({0, instance.horizon});
-        IntVar duration = model.NewConstant(task.duration);
-        IntVar end = model.NewIntVar({0, instance.horizon});
-        
-        IntervalVar interval = model.NewIntervalVar(start, duration, end);
-        intervals.push_back(interval);
+    // Proven bounds and the best probe schedule seed the main solve.
+    ProbeResult probe;
+    if (probing.enabled()) {
+        TimelineSpan span(timeline, "Probe", "bounds");
+        probe = ProbeMakespan(instance, probing, &incumbents);
+        std::cout << "Probing: " << probe.Summary() << std::endl;
     }
     
-    for (int i = 0; i < instance.tasks.size(); ++i) {
-        for (int succ : instance.tasks[i].successors) {
-            model.AddLessOrEqual(intervals[i].EndExpr(), intervals[succ].StartExpr());
-        }
+    const Timeline::Clock::time_point build_begin = Timeline::Clock::now();
+    RcpspModel rcpsp_model;
+    BuildRcpspModel(instance, strengthening, &rcpsp_model);
+    if (strengthening.enabled) {
+        std::cout << "Strengthening: " << rcpsp_model.plan.Summary() << std::endl;
+    }
+    const std::vector<IntervalVar>& intervals = rcpsp_model.intervals;
+    const IntVar makespan = rcpsp_model.makespan;
+    if (probe.lower_bound > 0) {
+        rcpsp_model.builder.AddGreaterOrEqual(makespan, probe.lower_bound);
+    }
+    for (size_t i = 0; i < probe.starts.size(); ++i) {
+        rcpsp_model.builder.AddHint(rcpsp_model.starts[i], probe.starts[i]);
+    }
+    CpModelProto model_proto = rcpsp_model.builder.Build();
+    config.model.AddSearchStrategy(rcpsp_model.start_variables, &model_proto);
+    if (timeline != nullptr) {
+        timeline->Complete("BuildModel", "model", build_begin, Timeline::Clock::now(),
+                           "{\"tasks\":" + std::to_string(instance.tasks.size()) + "}");
     }
     
-    for (int r = 0; r < instance.resources.size(); ++r) {
-        std::vector<IntervalVar> resource_intervals;
-        std::vector<int64_t> demands;
-        
-        for (int i = 0; i < instance.tasks.size(); ++i) {
-            if (instance.tasks[i].resource_demands[r] > 0) {
-                resource_intervals.push_back(intervals[i]);
-                demands.push_back(instance.tasks[i].resource_demands[r]);
-            }
+    SatParameters parameters = config.parameters;
+    stop_policy.ApplyTo(&parameters);
+    
+    solver_model.Add(NewSatParameters(parameters));
+    
+    solver_model.Add(NewFeasibleSolutionObserver([&](const CpSolverResponse& solution) {
+        std::vector<int64_t> starts;
+        for (const auto& interval : intervals) {
+            starts.push_back(SolutionIntegerValue(solution, interval.StartExpr()));
         }
-        
-        if (!resource_intervals.empty()) {
-            auto cumulative = model.AddCumulative(model.NewConstant(instance.resources[r].capacity));
-            for (size_t i = 0; i < resource_intervals.size(); ++i) {
-                cumulative.AddDemand(resource_intervals[i], demands[i]);
-            }
+        const Incumbent* incumbent = incumbents.OnSolution(
+            solution.objective_value(), solution.best_objective_bound(), std::move(starts));
+        // The observer runs on the worker that found the solution.
+        if (incumbent != nullptr && timeline != nullptr) {
+            timeline->Instant("Incumbent", "solver", incumbent->ToJsonWithoutStarts());
         }
-    }
+    }));
     
-    IntVar makespan = model.NewIntVar({0, instance.horizon});
-    std::vector<LinearExpr> ends;
-    for (const auto& interval : intervals) {
-        ends.push_back(interval.EndExpr());
+    CpSolverResponse response;
+    {
+        // Includes loading the model: SolveCpModel does not expose it.
+        TimelineSpan span(timeline, "SolveCpModel", "solver");
+        response = SolveCpModel(model_proto, &solver_model);
     }
-    model.AddMaxEquality(makespan, ends);
-    model.Minimize(makespan);
-    
-    const CpSolverResponse response = Solve(model.Build());
+    incumbents.Finish();
+    incumbents.OnSolveFinished(response.objective_value(), response.best_objective_bound());
     
     std::cout << "Solver status: " << response.status() << std::endl;
+    if (!incumbents.stop_reason().empty()) {
+        std::cout << "Stopped early: " << incumbents.stop_reason() << std::endl;
+    }
     
-    std::stringstream json;
-    json << "{\n";
-    json << "  \"events\": [\n";
-    
+    std::vector<int64_t> starts;
     if (response.status() == CpSolverStatus::OPTIMAL || response.status() == CpSolverStatus::FEASIBLE) {
         std::cout << "Found feasible solution" << std::endl;
         for (int i = 0; i < instance.tasks.size(); ++i) {
@@ -111,32 +162,264 @@ std::string solveRCPSP(const RCPSPInstance& instance) {
             int64_t end = SolutionIntegerValue(response, intervals[i].EndExpr());
             
             std::cout << "Task " << i << ": start=" << start << ", end=" << end << std::endl;
-            
-            json << "    {\"type\": \"start\", \"taskId\": " << i << ", \"time\": " << start << "},\n";
-            json << "    {\"type\": \"complete\", \"taskId\": " << i << ", \"time\": " << end << "}";
-            if (i < instance.tasks.size() - 1) json << ",";
-            json << "\n";
+            starts.push_back(start);
         }
     } else {
         std::cout << "No feasible solution found" << std::endl;
     }
     
-    json << "  ],\n";
-    json << "  \"makespan\": " << SolutionIntegerValue(response, makespan) << "\n";
-    json << "}\n";
+    std::stringstream extra;
+    extra << "  \"strengthened\": " << (strengthening.enabled ? "true" : "false") << ",\n";
+    if (probing.enabled()) {
+        extra << "  \"probing\": " << probe.ToJson() << ",\n";
+    }
+    if (sensitivity.enabled() && !starts.empty()) {
+        TimelineSpan span(timeline, "Sensitivity", "analysis");
+        const SensitivityResult analysis = AnalyzeSensitivity(
+            instance, starts, response.status() == CpSolverStatus::OPTIMAL, sensitivity);
+        std::cout << "Sensitivity: " << analysis.Summary() << std::endl;
+        std::cout << analysis.Table(instance);
+        extra << "  \"sensitivity\": " << analysis.ToJson(instance) << ",\n";
+    }
+    return scheduleJson(instance, starts, SolutionIntegerValue(response, makespan),
+                        response.best_objective_bound(), response.wall_time(), incumbents,
+                        extra.str());
+}
+
+std::string solveDecomposed(const RCPSPInstance& instance, const StopPolicy& stop_policy,
+                            DecompositionOptions decomposition) {
+    std::atomic<bool> stop_requested(false);
+    IncumbentStream incumbents(stop_policy, [&stop_requested]() { stop_requested = true; });
+    // Windows solve their own objective, so only the time limit carries over;
+    // the gap and target policies act on the complete schedules reported.
+    decomposition.time_limit = stop_policy.time_limit_seconds;
+    const DecompositionResult result =
+        SolveDecomposed(instance, decomposition, &incumbents, &stop_requested);
+    incumbents.Finish();
+    incumbents.OnSolveFinished(result.makespan, result.lower_bound);
     
-    return json.str();
+    std::cout << "Decomposition: " << result.Summary() << std::endl;
+    std::cout << "Makespan " << result.makespan << ", lower bound " << result.lower_bound
+              << std::endl;
+    if (!incumbents.stop_reason().empty()) {
+        std::cout << "Stopped early: " << incumbents.stop_reason() << std::endl;
+    }
+    
+    std::stringstream extra;
+    extra << "  \"decomposition\": " << result.ToJson() << ",\n";
+    return scheduleJson(instance, result.starts, result.makespan, result.lower_bound,
+                        incumbents.ElapsedSeconds(), incumbents, extra.str());
 }
 
-int main(int argc, char** argv) {
-    std::string output_file = argc > 1 ? argv[1] : "output.json";
+std::string solvePortfolio(const Portfolio& portfolio, const StopPolicy& stop_policy,
+                           const PortfolioOptions& options) {
+    std::atomic<bool> stop_requested(false);
+    IncumbentStream incumbents(stop_policy, [&stop_requested]() { stop_requested = true; });
+    const PortfolioResult result = SolvePortfolio(portfolio, options, &incumbents, &stop_requested);
+    incumbents.Finish();
+    incumbents.OnSolveFinished(result.weighted_delay, result.delay_lower_bound);
     
-    RCPSPInstance instance = createSimpleInstance();
+    std::cout << "Portfolio: " << result.Summary() << std::endl;
+    if (!incumbents.stop_reason().empty()) {
+        std::cout << "Stopped early: " << incumbents.stop_reason() << std::endl;
+    }
     
-    std::cout << "Solving RCPSP instance with " << instance.tasks.size() << " tasks and " 
-              << instance.resources.size() << " resources..." << std::endl;
+    std::stringstream extra;
+    extra << "  \"portfolio\": " << result.ToJson(portfolio) << ",\n";
+    return scheduleJson(portfolio.Combined(), result.starts, result.makespan,
+                        result.makespan_lower_bound, incumbents.ElapsedSeconds(), incumbents,
+                        extra.str());
+}
+
+// Solves every instance of a packed repository, one solve per thread, and
+// returns one JSON line per instance in repository order. Models are built
+// straight from the mapped file; each solve gets one worker unless the config
+// sets num_workers, and its own IncumbentStream for the stall and target
+// policies.
+std::string solveBatch(const PackedRepository& repository, const StopPolicy& stop_policy,
+                       const SolverConfig& config, const StrengtheningOptions& strengthening,
+                       int num_threads, Timeline* timeline) {
+    SatParameters parameters = config.parameters;
+    if (!parameters.has_num_workers()) {
+        parameters.set_num_workers(1);
+    }
+    stop_policy.ApplyTo(&parameters);
     
-    std::string json_output = solveRCPSP(instance);
+    std::vector<std::string> lines(repository.size());
+    std::atomic<int> next(0);
+    std::atomic<int> solved(0);
+    auto worker = [&](int thread_index) {
+        if (timeline != nullptr) {
+            timeline->NameThread("batch " + std::to_string(thread_index));
+        }
+        for (int k = next++; k < repository.size(); k = next++) {
+            const std::string timeline_args = "{\"instance\":" + std::to_string(k) + "}";
+            const PackedInstanceView view = repository.instance(k);
+            const Timeline::Clock::time_point build_begin = Timeline::Clock::now();
+            RcpspModel rcpsp_model;
+            BuildRcpspModel(view, strengthening, &rcpsp_model);
+            CpModelProto model_proto = rcpsp_model.builder.Build();
+            config.model.AddSearchStrategy(rcpsp_model.start_variables, &model_proto);
+            const Timeline::Clock::time_point solve_begin = Timeline::Clock::now();
+            Model solver_model;
+            IncumbentStream incumbents(stop_policy,
+                                       [&solver_model]() { StopSearch(&solver_model); });
+            incumbents.set_echo(false);
+            solver_model.Add(NewSatParameters(parameters));
+            solver_model.Add(NewFeasibleSolutionObserver([&](const CpSolverResponse& solution) {
+                incumbents.OnSolution(solution.objective_value(), solution.best_objective_bound());
+            }));
+            const CpSolverResponse response = SolveCpModel(model_proto, &solver_model);
+            incumbents.Finish();
+            incumbents.OnSolveFinished(response.objective_value(), response.best_objective_bound());
+            if (timeline != nullptr) {
+                timeline->Complete("BuildModel", "model", build_begin, solve_begin, timeline_args);
+                timeline->Complete("SolveCpModel", "solver", solve_begin, Timeline::Clock::now(),
+                                   timeline_args);
+            }
+            
+            const bool found = response.status() == CpSolverStatus::OPTIMAL ||
+                               response.status() == CpSolverStatus::FEASIBLE;
+            std::stringstream line;
+            line << "{\"name\": \"" << JsonEscaped(repository.name(k))
+                 << "\", \"tasks\": " << view.num_tasks()
+                 << ", \"status\": \"" << CpSolverStatus_Name(response.status())
+                 << "\", \"makespan\": "
+                 << (found ? std::to_string(SolutionIntegerValue(response, rcpsp_model.makespan))
+                           : std::string("null"))
+                 << ", \"bestBound\": " << response.best_objective_bound()
+                 << ", \"wallTime\": " << response.wall_time()
+                 << ", \"stopReason\": \"" << incumbents.stop_reason() << "\"}";
+            lines[k] = line.str();
+            std::cout << "[" << ++solved << "/" << repository.size() << "] " + lines[k] + "\n"
+                      << std::flush;
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back(worker, t);
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    
+    std::string json_lines;
+    for (const std::string& line : lines) {
+        json_lines += line + "\n";
+    }
+    return json_lines;
+}
+
+int main(int argc, char** argv) {
+    std::string output_file = "output.json";
+    std::string instance_file;
+    std::string repository_file;
+    int batch_threads = std::max(1u, std::thread::hardware_concurrency());
+    StopPolicy stop_policy;
+    StrengtheningOptions strengthening;
+    DecompositionOptions decomposition;
+    PortfolioOptions portfolio_options;
+    ProbeOptions probing;
+    SensitivityOptions sensitivity;
+    TimelineOptions timeline_options;
+    GeneratorParams generator;
+    bool generate = false;
+    SolverConfig config;
+    if (!config.LoadFromArgs(argc, argv)) {
+        return 1;
+    }
+    config.model.ApplyTo(&strengthening);
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (SolverConfig::IsFlag(arg) || stop_policy.ParseFlag(arg) ||
+            strengthening.ParseFlag(arg) || decomposition.ParseFlag(arg) ||
+            portfolio_options.ParseFlag(arg) || probing.ParseFlag(arg) ||
+            sensitivity.ParseFlag(arg) || timeline_options.ParseFlag(arg)) {
+            continue;
+        }
+        if (generator.ParseFlag(arg)) {
+            generate = true;
+            continue;
+        }
+        if (arg.rfind("--instance=", 0) == 0) {
+            instance_file = arg.substr(11);
+            continue;
+        }
+        if (arg.rfind("--repository=", 0) == 0) {
+            repository_file = arg.substr(13);
+            continue;
+        }
+        if (arg.rfind("--batch_threads=", 0) == 0) {
+            batch_threads = std::max(1, std::atoi(arg.c_str() + 16));
+            continue;
+        }
+        if (arg.rfind("--", 0) == 0) {
+            std::cerr << "Unknown flag: " << arg << std::endl;
+            return 1;
+        }
+        output_file = arg;
+    }
+    std::string policy_error;
+    if (!stop_policy.Validate(&policy_error)) {
+        std::cerr << policy_error << std::endl;
+        return 1;
+    }
+    
+    Timeline timeline_storage(timeline_options.max_events);
+    Timeline* timeline = timeline_options.enabled() ? &timeline_storage : nullptr;
+    
+    std::string json_output;
+    if (!repository_file.empty()) {
+        PackedRepository repository;
+        std::string error;
+        if (!repository.Open(repository_file, &error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        std::cout << "Solving " << repository.size() << " instances of " << repository_file
+                  << " on " << batch_threads << " threads..." << std::endl;
+        json_output = solveBatch(repository, stop_policy, config, strengthening, batch_threads,
+                                 timeline);
+    } else if (portfolio_options.enabled()) {
+        Portfolio portfolio;
+        std::string error;
+        if (portfolio_options.file.empty()) {
+            if (!GeneratePortfolio(portfolio_options.generate_projects, generator, &portfolio,
+                                   &error)) {
+                std::cerr << error << std::endl;
+                return 1;
+            }
+        } else if (!ReadPortfolio(portfolio_options.file, &portfolio)) {
+            return 1;
+        }
+        portfolio_options.time_limit = stop_policy.time_limit_seconds;
+        std::cout << "Solving portfolio of " << portfolio.projects.size() << " projects with "
+                  << portfolio.NumTasks() << " tasks and " << portfolio.resources.size() << " shared resources..."
+                  << std::endl;
+        json_output = solvePortfolio(portfolio, stop_policy, portfolio_options);
+    } else {
+        RCPSPInstance instance;
+        std::string error;
+        if (generate) {
+            if (!generator.Validate(&error)) {
+                std::cerr << error << std::endl;
+                return 1;
+            }
+            instance = GenerateInstance(generator);
+        } else if (instance_file.empty()) {
+            instance = createSimpleInstance();
+        } else if (!ReadPattersonInstance(instance_file, &instance)) {
+            return 1;
+        }
+        
+        std::cout << "Solving RCPSP instance with " << instance.tasks.size() << " tasks and " 
+                  << instance.resources.size() << " resources..." << std::endl;
+        
+        json_output = decomposition.enabled
+                          ? solveDecomposed(instance, stop_policy, decomposition)
+                          : solveRCPSP(instance, stop_policy, config, strengthening, probing,
+                                       sensitivity, timeline);
+    }
     
     std::ofstream out(output_file);
     out << json_output;
@@ -144,5 +427,15 @@ int main(int argc, char** argv) {
     
     std::cout << "Solution written to " << output_file << std::endl;
     
+    if (timeline != nullptr) {
+        std::string error;
+        if (!timeline->WriteTo(timeline_options.file, &error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        std::cout << "Timeline of " << timeline->size() << " spans written to "
+                  << timeline_options.file << std::endl;
+    }
+    
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,551 @@
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "instance_generator.h"
+#include "model_strengthening.h"
+#include "ortools/sat/cp_model.h"
+#include "ortools/sat/cp_model.pb.h"
+#include "ortools/sat/cp_model_solver.h"
+#include "ortools/sat/sat_parameters.pb.h"
+#include "rcpsp_instance.h"
+#include "rcpsp_model.h"
+#include "solver_config.h"
+
+// Tunes the CP-SAT parameters and model options of rcpsp_solver over a
+// corpus of instances and writes the winner as a config file that both
+// rcpsp_solver and driver load with --params=FILE.
+//
+//   rcpsp_tune benchmarks/*.rcp --output=tuned.params
+//   rcpsp_tune --generate=20 --tasks=60 --configs=81 --min_time=0.5
+//
+// Candidates are sampled from the search space below, plus the current
+// defaults of both binaries. They are raced by successive halving: every
+// rung solves the whole corpus with each surviving candidate, keeps the best
+// 1/eta of them and multiplies the time limit by eta. A candidate's score is
+// its mean relative gap to the best lower bound known for each instance, with
+// ties broken by solve time, so proving optimality faster also counts.
+//
+// Runs are executed in parallel. Each run is pinned to as many CPUs as its
+// candidate has CP-SAT workers, all of them for a candidate that leaves the
+// count to CP-SAT; the worker threads inherit the pinning, so concurrent runs
+// never compete for a core and timings stay comparable.
+
+namespace {
+
+using operations_research::sat::CpModelProto;
+using operations_research::sat::CpSolverResponse;
+using operations_research::sat::CpSolverStatus;
+using operations_research::sat::DecisionStrategyProto;
+using operations_research::sat::SatParameters;
+
+struct TuneOptions {
+  int num_configs = 27;
+  int eta = 3;
+  double min_time = 1.0;
+  double max_time = 60.0;
+  int max_workers = 8;
+  uint64_t seed = 1;
+  std::string output_file = "tuned.params";
+};
+
+struct Candidate {
+  SolverConfig config;
+  // What a binary sets whatever its config says. Applied on top of the config
+  // in every run and never written out.
+  SatParameters forced;
+  std::string name;
+
+  // CP-SAT workers per run; 0 when the count is left to CP-SAT.
+  int workers() const {
+    return forced.has_num_workers() ? forced.num_workers()
+                                    : config.parameters.num_workers();
+  }
+
+  // Tells candidates apart, for dropping duplicate samples.
+  std::string Key() const { return config.ToString() + forced.ShortDebugString(); }
+};
+
+// One value per choice; sampled independently.
+Candidate SampleCandidate(SplitMix64* rng, int max_workers) {
+  static const SatParameters::SearchBranching kBranching[] = {
+      SatParameters::AUTOMATIC_SEARCH, SatParameters::FIXED_SEARCH,
+      SatParameters::PORTFOLIO_SEARCH, SatParameters::PSEUDO_COST_SEARCH,
+      SatParameters::PORTFOLIO_WITH_QUICK_RESTART_SEARCH};
+  static const DecisionStrategyProto::VariableSelectionStrategy kSelection[] = {
+      DecisionStrategyProto::CHOOSE_FIRST,
+      DecisionStrategyProto::CHOOSE_LOWEST_MIN,
+      DecisionStrategyProto::CHOOSE_MIN_DOMAIN_SIZE};
+  static const DecisionStrategyProto::DomainReductionStrategy kReduction[] = {
+      DecisionStrategyProto::SELECT_MIN_VALUE,
+      DecisionStrategyProto::SELECT_LOWER_HALF};
+
+  Candidate candidate;
+  SatParameters& parameters = candidate.config.parameters;
+  ModelOptions& model = candidate.config.model;
+  parameters.set_search_branching(kBranching[rng->Uniform(0, 4)]);
+  parameters.set_linearization_level(static_cast<int>(rng->Uniform(0, 2)));
+  parameters.set_use_lns(rng->Uniform(0, 1) == 1);
+  int workers = 1;
+  const int max_log = static_cast<int>(std::log2(std::max(1, max_workers)));
+  for (int64_t k = rng->Uniform(0, max_log); k > 0; --k) workers *= 2;
+  parameters.set_num_workers(workers);
+  // One in four candidates leaves the search order to CP-SAT.
+  const int64_t selection = rng->Uniform(0, 3);
+  if (selection < 3) {
+    model.variable_selection = kSelection[selection];
+    model.domain_reduction = kReduction[rng->Uniform(0, 1)];
+  }
+  model.strengthen = rng->Uniform(0, 1) == 1;
+  return candidate;
+}
+
+std::string Describe(const SolverConfig& config) {
+  std::stringstream text;
+  const SatParameters& parameters = config.parameters;
+  text << SatParameters::SearchBranching_Name(parameters.search_branching())
+       << " lin=" << parameters.linearization_level()
+       << " lns=" << (parameters.use_lns() ? 1 : 0)
+       << " workers="
+       << (parameters.num_workers() > 0 ? std::to_string(parameters.num_workers())
+                                        : std::string("all"))
+       << " strengthen=" << (config.model.strengthen ? 1 : 0);
+  if (config.model.variable_selection.has_value()) {
+    text << " "
+         << DecisionStrategyProto::VariableSelectionStrategy_Name(
+                *config.model.variable_selection)
+         << "/"
+         << DecisionStrategyProto::DomainReductionStrategy_Name(
+                config.model.domain_reduction);
+  }
+  return text.str();
+}
+
+// The candidates every tuning run starts from: what rcpsp_solver and driver
+// use without a config. rcpsp_solver leaves the worker count to CP-SAT, so its
+// runs get every CPU. driver's 30 s default gives way to the rung's time limit
+// as it does to --time_limit.
+std::vector<Candidate> BaselineCandidates() {
+  Candidate solver_defaults;
+  solver_defaults.name = "rcpsp_solver defaults";
+  Candidate driver_defaults;
+  driver_defaults.name = "driver defaults";
+  driver_defaults.config.parameters.set_search_branching(
+      SatParameters::PORTFOLIO_SEARCH);
+  driver_defaults.config.parameters.set_num_workers(1);
+  driver_defaults.config.model.variable_selection =
+      DecisionStrategyProto::CHOOSE_FIRST;
+  driver_defaults.forced.set_num_workers(1);
+  driver_defaults.forced.set_cp_model_presolve(false);
+  driver_defaults.forced.set_enumerate_all_solutions(true);
+  return {solver_defaults, driver_defaults};
+}
+
+// ---------------------------------------------------------------------------
+// CPU pinning
+// ---------------------------------------------------------------------------
+
+// The CPUs this process may run on.
+std::vector<int> AllowedCpus() {
+  std::vector<int> cpus;
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+    }
+  }
+#endif
+  if (cpus.empty()) {
+    const int count = std::max(1u, std::thread::hardware_concurrency());
+    for (int cpu = 0; cpu < count; ++cpu) cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+// Pins the calling thread, and the threads it creates from now on, to the
+// given CPUs. A no-op where affinity is not supported.
+void PinCurrentThread(const std::vector<int>& cpus) {
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (const int cpu : cpus) CPU_SET(cpu, &set);
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+  (void)cpus;
+#endif
+}
+
+// Hands out disjoint sets of CPUs. Requests are served in arrival order, so
+// a run that needs many CPUs is not starved by smaller ones.
+class CpuPool {
+ public:
+  explicit CpuPool(std::vector<int> cpus) : free_(std::move(cpus)) {
+    std::sort(free_.begin(), free_.end());
+  }
+
+  std::vector<int> Acquire(int count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const uint64_t ticket = next_ticket_++;
+    ready_.wait(lock, [&] {
+      return ticket == serving_ && static_cast<int>(free_.size()) >= count;
+    });
+    ++serving_;
+    // Neighbouring CPU numbers usually share caches.
+    std::vector<int> taken(free_.begin(), free_.begin() + count);
+    free_.erase(free_.begin(), free_.begin() + count);
+    ready_.notify_all();
+    return taken;
+  }
+
+  void Release(const std::vector<int>& cpus) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.insert(free_.end(), cpus.begin(), cpus.end());
+    std::sort(free_.begin(), free_.end());
+    ready_.notify_all();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  std::vector<int> free_;
+  uint64_t next_ticket_ = 0;
+  uint64_t serving_ = 0;
+};
+
+// ---------------------------------------------------------------------------
+// Racing
+// ---------------------------------------------------------------------------
+
+struct RunResult {
+  bool feasible = false;
+  bool optimal = false;
+  int64_t makespan = 0;
+  double best_bound = 0.0;
+  double wall_time = 0.0;
+};
+
+// Solves on `num_cpus` CPUs, which is also the worker count of a candidate
+// that leaves it to CP-SAT: CP-SAT would start one per hardware thread, not
+// per CPU the run is pinned to.
+RunResult SolveOnce(const RCPSPInstance& instance, const Candidate& candidate,
+                    double time_limit, int seed, int num_cpus) {
+  const SolverConfig& config = candidate.config;
+  StrengtheningOptions strengthening;
+  config.model.ApplyTo(&strengthening);
+  RcpspModel model;
+  BuildRcpspModel(instance, strengthening, &model);
+  CpModelProto proto = model.builder.Build();
+  config.model.AddSearchStrategy(model.start_variables, &proto);
+
+  SatParameters parameters = config.parameters;
+  parameters.MergeFrom(candidate.forced);
+  if (parameters.num_workers() == 0) parameters.set_num_workers(num_cpus);
+  parameters.set_max_time_in_seconds(time_limit);
+  parameters.set_random_seed(seed);
+  parameters.set_log_search_progress(false);
+  const CpSolverResponse response =
+      operations_research::sat::SolveWithParameters(proto, parameters);
+
+  RunResult result;
+  result.feasible = response.status() == CpSolverStatus::OPTIMAL ||
+                    response.status() == CpSolverStatus::FEASIBLE;
+  result.optimal = response.status() == CpSolverStatus::OPTIMAL;
+  result.makespan = static_cast<int64_t>(std::llround(response.objective_value()));
+  result.best_bound = response.best_objective_bound();
+  result.wall_time = response.wall_time();
+  return result;
+}
+
+struct Score {
+  double mean_gap = 0.0;
+  double mean_time = 0.0;
+  int solved = 0;  // instances proven optimal
+
+  bool operator<(const Score& other) const {
+    if (std::abs(mean_gap - other.mean_gap) > 1e-9) {
+      return mean_gap < other.mean_gap;
+    }
+    return mean_time < other.mean_time;
+  }
+};
+
+class Tuner {
+ public:
+  Tuner(std::vector<RCPSPInstance> corpus, std::vector<int> cpus)
+      : corpus_(std::move(corpus)), cpus_(cpus), pool_(std::move(cpus)) {
+    StrengtheningOptions analysis;
+    for (const RCPSPInstance& instance : corpus_) {
+      lower_bounds_.push_back(static_cast<double>(
+          std::max<int64_t>(1, AnalyzeInstance(instance, analysis).MakespanLowerBound())));
+    }
+  }
+
+  // Solves every instance with every candidate and returns their scores.
+  std::vector<Score> Race(const std::vector<Candidate>& candidates,
+                          double time_limit) {
+    struct Run {
+      int candidate;
+      int instance;
+    };
+    std::vector<Run> runs;
+    for (size_t c = 0; c < candidates.size(); ++c) {
+      for (size_t i = 0; i < corpus_.size(); ++i) {
+        runs.push_back({static_cast<int>(c), static_cast<int>(i)});
+      }
+    }
+    // Widest runs first, so narrow ones fill the gaps they leave.
+    std::stable_sort(runs.begin(), runs.end(), [&](const Run& a, const Run& b) {
+      return Workers(candidates[a.candidate]) > Workers(candidates[b.candidate]);
+    });
+
+    std::vector<RunResult> results(runs.size());
+    std::mutex next_mutex;
+    size_t next = 0;
+    auto work = [&]() {
+      for (;;) {
+        size_t index;
+        {
+          std::lock_guard<std::mutex> lock(next_mutex);
+          if (next == runs.size()) return;
+          index = next++;
+        }
+        const Run& run = runs[index];
+        const std::vector<int> cpus =
+            pool_.Acquire(Workers(candidates[run.candidate]));
+        PinCurrentThread(cpus);
+        // Every candidate sees the same seed on an instance.
+        results[index] = SolveOnce(corpus_[run.instance], candidates[run.candidate],
+                                   time_limit, run.instance + 1,
+                                   static_cast<int>(cpus.size()));
+        pool_.Release(cpus);
+      }
+    };
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < cpus_.size(); ++t) threads.emplace_back(work);
+    for (std::thread& thread : threads) thread.join();
+
+    for (size_t r = 0; r < runs.size(); ++r) {
+      double& bound = lower_bounds_[runs[r].instance];
+      if (results[r].feasible) bound = std::max(bound, std::ceil(results[r].best_bound - 1e-6));
+    }
+    std::vector<Score> scores(candidates.size());
+    for (size_t r = 0; r < runs.size(); ++r) {
+      const RunResult& result = results[r];
+      const double bound = lower_bounds_[runs[r].instance];
+      const RCPSPInstance& instance = corpus_[runs[r].instance];
+      // No schedule counts as a schedule at the horizon, and then some.
+      const double makespan =
+          result.feasible ? static_cast<double>(result.makespan)
+                          : 2.0 * std::max<double>(instance.horizon, bound);
+      Score& score = scores[runs[r].candidate];
+      score.mean_gap += (makespan - bound) / bound / corpus_.size();
+      score.mean_time += result.wall_time / corpus_.size();
+      if (result.optimal) ++score.solved;
+    }
+    return scores;
+  }
+
+  int num_cpus() const { return static_cast<int>(cpus_.size()); }
+
+ private:
+  int Workers(const Candidate& candidate) const {
+    const int workers = candidate.workers();
+    return workers > 0 ? std::min(workers, num_cpus()) : num_cpus();
+  }
+
+  std::vector<RCPSPInstance> corpus_;
+  std::vector<int> cpus_;
+  CpuPool pool_;
+  std::vector<double> lower_bounds_;
+};
+
+void PrintRung(int rung, double time_limit,
+               const std::vector<Candidate>& candidates,
+               const std::vector<Score>& scores, const std::vector<int>& order,
+               int kept) {
+  std::cout << "\nRung " << rung << ": " << candidates.size()
+            << " candidates, " << time_limit << " s per run\n";
+  std::cout << "  rank  mean gap   mean time  optimal  configuration\n";
+  for (size_t k = 0; k < order.size(); ++k) {
+    const Candidate& candidate = candidates[order[k]];
+    const Score& score = scores[order[k]];
+    std::cout << (static_cast<int>(k) < kept ? "  " : "x ") << std::setw(4)
+              << k + 1 << "  " << std::fixed << std::setprecision(4)
+              << std::setw(8) << score.mean_gap << "  " << std::setprecision(2)
+              << std::setw(8) << score.mean_time << " s  " << std::setw(7)
+              << score.solved << "  "
+              << (candidate.name.empty() ? Describe(candidate.config)
+                                         : candidate.name + ": " +
+                                               Describe(candidate.config))
+              << "\n";
+  }
+  std::cout.unsetf(std::ios::fixed);
+}
+
+void PrintUsage() {
+  std::cerr << "Usage: rcpsp_tune (instance.rcp... | --corpus=list.txt |\n"
+               "                    --generate=N [generator flags])\n"
+               "                  [--configs=N] [--eta=N] [--min_time=S]\n"
+               "                  [--max_time=S] [--max_workers=N] [--cpus=N]\n"
+               "                  [--tune_seed=S] [--output=tuned.params]\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  TuneOptions options;
+  std::vector<std::string> instance_files;
+  GeneratorParams generator;
+  int num_generated = 0;
+  int num_cpus = 0;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg.rfind("--corpus=", 0) == 0) {
+      std::ifstream list(arg.substr(9));
+      if (!list) {
+        std::cerr << "Cannot open " << arg.substr(9) << std::endl;
+        return 1;
+      }
+      for (std::string line; std::getline(list, line);) {
+        if (!line.empty() && line[0] != '#') instance_files.push_back(line);
+      }
+    } else if (arg.rfind("--generate=", 0) == 0) {
+      num_generated = std::atoi(arg.c_str() + 11);
+    } else if (arg.rfind("--configs=", 0) == 0) {
+      options.num_configs = std::max(1, std::atoi(arg.c_str() + 10));
+    } else if (arg.rfind("--eta=", 0) == 0) {
+      options.eta = std::max(2, std::atoi(arg.c_str() + 6));
+    } else if (arg.rfind("--min_time=", 0) == 0) {
+      options.min_time = std::atof(arg.c_str() + 11);
+    } else if (arg.rfind("--max_time=", 0) == 0) {
+      options.max_time = std::atof(arg.c_str() + 11);
+    } else if (arg.rfind("--max_workers=", 0) == 0) {
+      options.max_workers = std::max(1, std::atoi(arg.c_str() + 14));
+    } else if (arg.rfind("--cpus=", 0) == 0) {
+      num_cpus = std::atoi(arg.c_str() + 7);
+    } else if (arg.rfind("--tune_seed=", 0) == 0) {
+      options.seed = std::strtoull(arg.c_str() + 12, nullptr, 10);
+    } else if (arg.rfind("--output=", 0) == 0) {
+      options.output_file = arg.substr(9);
+    } else if (generator.ParseFlag(arg)) {
+      continue;
+    } else if (arg.rfind("--", 0) == 0) {
+      std::cerr << "Unknown flag: " << arg << std::endl;
+      PrintUsage();
+      return 1;
+    } else {
+      instance_files.push_back(arg);
+    }
+  }
+
+  std::vector<RCPSPInstance> corpus;
+  for (const std::string& file : instance_files) {
+    RCPSPInstance instance;
+    if (!ReadPattersonInstance(file, &instance)) return 1;
+    corpus.push_back(std::move(instance));
+  }
+  std::string error;
+  if (num_generated > 0 && !generator.Validate(&error)) {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+  for (int k = 0; k < num_generated; ++k) {
+    GeneratorParams params = generator;
+    params.seed = generator.seed + k;
+    corpus.push_back(GenerateInstance(params));
+  }
+  if (corpus.empty()) {
+    PrintUsage();
+    return 1;
+  }
+
+  std::vector<int> cpus = AllowedCpus();
+  if (num_cpus > 0 && num_cpus < static_cast<int>(cpus.size())) {
+    cpus.resize(num_cpus);
+  }
+  options.max_workers = std::min<int>(options.max_workers, cpus.size());
+  std::cout << "Tuning over " << corpus.size() << " instances on "
+            << cpus.size() << " CPUs" << std::endl;
+
+  // Baselines first, then distinct samples.
+  std::vector<Candidate> candidates = BaselineCandidates();
+  std::map<std::string, bool> seen;
+  for (const Candidate& candidate : candidates) {
+    seen[candidate.Key()] = true;
+  }
+  SplitMix64 rng(options.seed);
+  for (int attempt = 0; static_cast<int>(candidates.size()) < options.num_configs &&
+                        attempt < 100 * options.num_configs;
+       ++attempt) {
+    Candidate candidate = SampleCandidate(&rng, options.max_workers);
+    if (seen[candidate.Key()]) continue;
+    seen[candidate.Key()] = true;
+    candidates.push_back(std::move(candidate));
+  }
+
+  Tuner tuner(std::move(corpus), cpus);
+  double time_limit = options.min_time;
+  Score best_score;
+  for (int rung = 0;; ++rung) {
+    const std::vector<Score> scores = tuner.Race(candidates, time_limit);
+    std::vector<int> order(candidates.size());
+    for (size_t c = 0; c < order.size(); ++c) order[c] = static_cast<int>(c);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](int a, int b) { return scores[a] < scores[b]; });
+    const int kept = std::max<int>(
+        1, (static_cast<int>(candidates.size()) + options.eta - 1) / options.eta);
+    PrintRung(rung, time_limit, candidates, scores, order, kept);
+    best_score = scores[order[0]];
+
+    std::vector<Candidate> survivors;
+    for (int k = 0; k < kept; ++k) survivors.push_back(candidates[order[k]]);
+    candidates = std::move(survivors);
+    if (candidates.size() == 1) break;
+    time_limit = std::min(options.max_time, time_limit * options.eta);
+  }
+  const Candidate& winner = candidates[0];
+
+  // Report the winner against the defaults at the final time limit.
+  const std::vector<Candidate> baselines = BaselineCandidates();
+  const std::vector<Score> baseline_scores = tuner.Race(baselines, time_limit);
+  std::cout << "\nWinner: " << Describe(winner.config) << "\n";
+  std::stringstream summary;
+  summary << std::fixed << std::setprecision(4) << "mean gap " << best_score.mean_gap
+          << " at " << time_limit << " s per run";
+  for (size_t b = 0; b < baselines.size(); ++b) {
+    summary << ", " << baselines[b].name << " " << baseline_scores[b].mean_gap;
+  }
+  std::cout << summary.str() << std::endl;
+
+  // The tuned time limit is not part of the config; it belongs to the caller.
+  SolverConfig config = winner.config;
+  config.parameters.clear_max_time_in_seconds();
+  std::ofstream out(options.output_file);
+  out << config.ToString({"Written by rcpsp_tune over " +
+                              std::to_string(tuner.num_cpus()) + " CPUs.",
+                          summary.str()});
+  if (!out) {
+    std::cerr << "Cannot write " << options.output_file << std::endl;
+    return 1;
+  }
+  std::cout << "Configuration written to " << options.output_file << std::endl;
+  return 0;
+}
@@ -0,0 +1,558 @@
+#ifndef ROLLING_HORIZON_H_
+#define ROLLING_HORIZON_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "incumbent_stream.h"
+#include "makespan_bounds.h"
+#include "ortools/sat/cp_model.h"
+#include "ortools/sat/cp_model_solver.h"
+#include "ortools/sat/sat_parameters.pb.h"
+#include "parallel_for.h"
+#include "rcpsp_instance.h"
+
+// Rolling-horizon decomposition for projects too large for one CP-SAT model.
+//
+// Tasks are ordered by earliest start along the precedence topological order
+// and cut into overlapping windows. Each window is solved with every earlier
+// window frozen: frozen tasks only appear as fixed intervals in the window's
+// cumulatives and as release dates of their successors, and frozen intervals
+// that end before the window may start are dropped, so each model stays about
+// the size of a window. Only the first window_tasks - overlap_tasks tasks of a
+// window are frozen; the rest are solved again, hinted, in the next window.
+//
+// A stitching pass then re-optimizes the tasks around every freeze point
+// inside the time span they already occupy, so it can only improve the
+// schedule. Projects whose parts share neither precedences nor resources are
+// split into independent components solved in parallel, and stitches whose
+// time spans do not overlap run in parallel as well.
+
+struct DecompositionOptions {
+  bool enabled = false;
+  int window_tasks = 400;
+  int overlap_tasks = 100;
+  int stitch_tasks = 0;  // tasks re-optimized per freeze point; 0: 2 * overlap
+  double window_time_limit = 5.0;
+  int num_threads = 0;      // 0: one per hardware thread
+  double time_limit = 0.0;  // for all windows and stitches; 0: none
+
+  // Parses "--decompose[=0|1]", "--decompose_window=N", "--overlap=N",
+  // "--stitch=N", "--window_time_limit=S" and "--decompose_threads=N".
+  // Returns false for any other argument; "--window=" belongs to the
+  // instance generator.
+  bool ParseFlag(const std::string& arg) {
+    if (arg == "--decompose" || arg == "--decompose=1") {
+      enabled = true;
+      return true;
+    }
+    if (arg == "--decompose=0") {
+      enabled = false;
+      return true;
+    }
+    const size_t eq = arg.find('=');
+    if (arg.rfind("--", 0) != 0 || eq == std::string::npos) return false;
+    const std::string name = arg.substr(2, eq - 2);
+    const char* value = arg.c_str() + eq + 1;
+    if (name == "decompose_window") {
+      window_tasks = std::atoi(value);
+    } else if (name == "overlap") {
+      overlap_tasks = std::atoi(value);
+    } else if (name == "stitch") {
+      stitch_tasks = std::atoi(value);
+    } else if (name == "window_time_limit") {
+      window_time_limit = std::atof(value);
+    } else if (name == "decompose_threads") {
+      num_threads = std::atoi(value);
+    } else {
+      return false;
+    }
+    enabled = true;
+    return true;
+  }
+};
+
+struct DecompositionResult {
+  std::vector<int64_t> starts;
+  int64_t makespan = 0;
+  int64_t lower_bound = 0;
+  int components = 0;
+  int windows = 0;
+  int fallback_windows = 0;  // windows scheduled serially, unsolved or stopped
+  int stitches = 0;
+  int improved_stitches = 0;
+  int max_model_intervals = 0;
+
+  std::string Summary() const {
+    std::ostringstream oss;
+    oss << components << " components, " << windows << " windows ("
+        << fallback_windows << " fallback), " << improved_stitches << "/"
+        << stitches << " stitches improved, at most " << max_model_intervals
+        << " intervals per model";
+    return oss.str();
+  }
+
+  std::string ToJson() const {
+    std::ostringstream oss;
+    oss << "{\"components\": " << components << ", \"windows\": " << windows
+        << ", \"fallbackWindows\": " << fallback_windows
+        << ", \"stitches\": " << stitches
+        << ", \"improvedStitches\": " << improved_stitches
+        << ", \"maxModelIntervals\": " << max_model_intervals << "}";
+    return oss.str();
+  }
+};
+
+namespace decomposition_internal {
+
+// Usage of one resource by a task outside the subproblem.
+struct FixedUsage {
+  int resource;
+  int64_t start;
+  int64_t end;
+  int64_t demand;
+};
+
+// A set of tasks solved together with everything else fixed.
+struct Subproblem {
+  std::vector<int> tasks;
+  std::vector<int64_t> min_start;  // per entry of `tasks`
+  std::vector<int64_t> max_start;
+  std::vector<FixedUsage> fixed;
+  std::vector<int64_t> hint;  // empty, or one start per entry of `tasks`
+};
+
+// Weighted objective of a subproblem: its makespan first, then the sum of
+// end times so that tasks off the critical path do not drift to the right
+// and block the next window.
+inline int64_t SubproblemObjective(const RCPSPInstance& instance,
+                                   const Subproblem& subproblem,
+                                   const std::vector<int64_t>& starts) {
+  int64_t makespan = 0;
+  int64_t sum_ends = 0;
+  for (size_t i = 0; i < subproblem.tasks.size(); ++i) {
+    const int64_t end = starts[i] + instance.tasks[subproblem.tasks[i]].duration;
+    makespan = std::max(makespan, end);
+    sum_ends += end;
+  }
+  return static_cast<int64_t>(subproblem.tasks.size()) * makespan + sum_ends;
+}
+
+// Solves the subproblem. Returns false if no schedule was found in time.
+inline bool SolveSubproblem(const RCPSPInstance& instance,
+                            const Subproblem& subproblem, double time_limit,
+                            int num_workers, std::vector<int64_t>* starts) {
+  using namespace operations_research;
+  using namespace operations_research::sat;
+  const int size = static_cast<int>(subproblem.tasks.size());
+  std::unordered_map<int, int> local;
+  local.reserve(size);
+  for (int i = 0; i < size; ++i) local[subproblem.tasks[i]] = i;
+
+  CpModelBuilder model;
+  std::vector<IntVar> start_vars;
+  std::vector<IntervalVar> intervals;
+  int64_t horizon = 0;
+  for (int i = 0; i < size; ++i) {
+    const Task& task = instance.tasks[subproblem.tasks[i]];
+    const IntVar start =
+        model.NewIntVar(Domain(subproblem.min_start[i], subproblem.max_start[i]));
+    start_vars.push_back(start);
+    intervals.push_back(model.NewFixedSizeIntervalVar(start, task.duration));
+    horizon = std::max(horizon, subproblem.max_start[i] + task.duration);
+    if (!subproblem.hint.empty()) model.AddHint(start, subproblem.hint[i]);
+  }
+  for (int i = 0; i < size; ++i) {
+    for (int succ : instance.tasks[subproblem.tasks[i]].successors) {
+      const auto it = local.find(succ);
+      if (it == local.end()) continue;
+      model.AddLessOrEqual(intervals[i].EndExpr(), intervals[it->second].StartExpr());
+    }
+  }
+  for (size_t r = 0; r < instance.resources.size(); ++r) {
+    auto cumulative = model.AddCumulative(instance.resources[r].capacity);
+    for (int i = 0; i < size; ++i) {
+      const int demand = instance.tasks[subproblem.tasks[i]].resource_demands[r];
+      if (demand > 0) cumulative.AddDemand(intervals[i], demand);
+    }
+    for (const FixedUsage& usage : subproblem.fixed) {
+      if (usage.resource != static_cast<int>(r)) continue;
+      cumulative.AddDemand(
+          model.NewFixedSizeIntervalVar(usage.start, usage.end - usage.start),
+          usage.demand);
+    }
+  }
+
+  const IntVar makespan = model.NewIntVar(Domain(0, horizon));
+  std::vector<LinearExpr> ends;
+  for (const IntervalVar& interval : intervals) ends.push_back(interval.EndExpr());
+  model.AddMaxEquality(makespan, ends);
+  LinearExpr objective = size * LinearExpr(makespan);
+  for (const LinearExpr& end : ends) objective += end;
+  model.Minimize(objective);
+
+  SatParameters parameters;
+  parameters.set_max_time_in_seconds(time_limit);
+  parameters.set_num_workers(std::max(1, num_workers));
+  const CpSolverResponse response = SolveWithParameters(model.Build(), parameters);
+  if (response.status() != CpSolverStatus::OPTIMAL &&
+      response.status() != CpSolverStatus::FEASIBLE) {
+    return false;
+  }
+  starts->resize(size);
+  for (int i = 0; i < size; ++i) {
+    (*starts)[i] = SolutionIntegerValue(response, start_vars[i]);
+  }
+  return true;
+}
+
+// Disjoint-set forest used to split the project into components that share
+// neither precedences nor resources.
+class DisjointSets {
+ public:
+  explicit DisjointSets(int size) : parent_(size) {
+    std::iota(parent_.begin(), parent_.end(), 0);
+  }
+
+  int Find(int x) {
+    while (parent_[x] != x) {
+      parent_[x] = parent_[parent_[x]];
+      x = parent_[x];
+    }
+    return x;
+  }
+
+  void Union(int a, int b) { parent_[Find(a)] = Find(b); }
+
+ private:
+  std::vector<int> parent_;
+};
+
+}  // namespace decomposition_internal
+
+// Solves the instance window by window and returns a feasible schedule.
+// Every complete schedule is reported to `incumbents` when it is not null.
+// Each window and stitch gets at most what is left of options.time_limit.
+// Once that is used up or a stop is requested through the stream, the
+// remaining windows are scheduled serially, which is immediate, and the
+// remaining stitches are skipped.
+inline DecompositionResult SolveDecomposed(const RCPSPInstance& instance,
+                                           const DecompositionOptions& options,
+                                           IncumbentStream* incumbents,
+                                           const std::atomic<bool>* stop_requested) {
+  using namespace decomposition_internal;
+  const int n = static_cast<int>(instance.tasks.size());
+  const int num_resources = static_cast<int>(instance.resources.size());
+  const int window_tasks = std::max(2, options.window_tasks);
+  const int overlap = std::min(std::max(0, options.overlap_tasks), window_tasks - 1);
+  const int step = window_tasks - overlap;
+  const int stitch_tasks =
+      options.stitch_tasks > 0 ? options.stitch_tasks : std::max(2, 2 * overlap);
+  const int num_threads =
+      options.num_threads > 0
+          ? options.num_threads
+          : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+  // The time limit of the next window or stitch; 0 once it must not solve.
+  const auto deadline =
+      std::chrono::steady_clock::now() +
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(options.time_limit));
+  auto subproblem_time_limit = [&]() {
+    if (stop_requested != nullptr && stop_requested->load()) return 0.0;
+    if (options.time_limit <= 0.0) return options.window_time_limit;
+    const double remaining =
+        std::chrono::duration<double>(deadline - std::chrono::steady_clock::now()).count();
+    return std::max(0.0, std::min(options.window_time_limit, remaining));
+  };
+
+  DecompositionResult result;
+  result.starts.assign(n, -1);
+  const std::vector<std::vector<int>> predecessors = ComputePredecessors(instance);
+
+  // Static earliest starts give both the task order and the release date of
+  // each window.
+  const std::vector<int> topological = TopologicalOrder(instance);
+  std::vector<int64_t> earliest_start(n, 0);
+  std::vector<int> position(n, 0);
+  for (int p = 0; p < n; ++p) {
+    const int i = topological[p];
+    position[i] = p;
+    for (int succ : instance.tasks[i].successors) {
+      earliest_start[succ] =
+          std::max(earliest_start[succ], earliest_start[i] + instance.tasks[i].duration);
+    }
+  }
+  result.lower_bound = MakespanLowerBound(instance);
+
+  DisjointSets sets(n);
+  for (int i = 0; i < n; ++i) {
+    for (int succ : instance.tasks[i].successors) sets.Union(i, succ);
+  }
+  for (int r = 0; r < num_resources; ++r) {
+    int first_user = -1;
+    for (int i = 0; i < n; ++i) {
+      if (instance.tasks[i].resource_demands[r] == 0) continue;
+      if (first_user < 0) {
+        first_user = i;
+      } else {
+        sets.Union(first_user, i);
+      }
+    }
+  }
+  std::unordered_map<int, int> component_of_root;
+  std::vector<std::vector<int>> components;
+  for (int i : topological) {
+    const auto inserted =
+        component_of_root.emplace(sets.Find(i), static_cast<int>(components.size()));
+    if (inserted.second) components.emplace_back();
+    components[inserted.first->second].push_back(i);
+  }
+  for (std::vector<int>& order : components) {
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+      return earliest_start[a] != earliest_start[b]
+                 ? earliest_start[a] < earliest_start[b]
+                 : position[a] < position[b];
+    });
+  }
+  result.components = static_cast<int>(components.size());
+
+  // Component-level parallelism first; what is left goes to CP-SAT workers.
+  const int parallel_components =
+      std::min(num_threads, std::max(1, result.components));
+  const int threads_per_component = std::max(1, num_threads / parallel_components);
+
+  std::atomic<int> windows(0);
+  std::atomic<int> fallback_windows(0);
+  std::atomic<int> stitches(0);
+  std::atomic<int> improved_stitches(0);
+  std::atomic<int> max_model_intervals(0);
+  auto record_model_size = [&](const Subproblem& subproblem) {
+    const int size = static_cast<int>(subproblem.tasks.size() + subproblem.fixed.size());
+    int current = max_model_intervals.load();
+    while (size > current && !max_model_intervals.compare_exchange_weak(current, size)) {
+    }
+  };
+
+  std::vector<int64_t>& starts = result.starts;
+  auto end_of = [&](int task) { return starts[task] + instance.tasks[task].duration; };
+
+  // Windows. Components touch disjoint tasks, so they share `starts` safely.
+  std::vector<std::vector<int>> freeze_points(components.size());
+  ParallelFor(result.components, parallel_components, [&](int c) {
+    const std::vector<int>& order = components[c];
+    const int m = static_cast<int>(order.size());
+    std::vector<FixedUsage> frozen;
+    int64_t frozen_end = 0;
+    int64_t floor = 0;
+    std::vector<int64_t> tentative;  // starts of the overlap from the last window
+    for (int first = 0; first < m; first += step) {
+      const int last = std::min(m, first + window_tasks);
+      const bool final_window = last == m;
+      // A window may backfill down to the first start of the tasks frozen
+      // last, but not further; earlier frozen usage is dropped for good.
+      const int64_t release = std::max(earliest_start[order[first]], floor);
+      frozen.erase(std::remove_if(frozen.begin(), frozen.end(),
+                                  [&](const FixedUsage& usage) { return usage.end <= release; }),
+                   frozen.end());
+
+      Subproblem window;
+      int64_t latest_release = frozen_end;
+      int64_t total_duration = 0;
+      for (int p = first; p < last; ++p) {
+        const int task = order[p];
+        int64_t min_start = std::max(earliest_start[task], release);
+        for (int pred : predecessors[task]) {
+          if (starts[pred] >= 0) min_start = std::max(min_start, end_of(pred));
+        }
+        window.tasks.push_back(task);
+        window.min_start.push_back(min_start);
+        latest_release = std::max(latest_release, min_start);
+        total_duration += instance.tasks[task].duration;
+      }
+      // Running the window's tasks one after another behind everything
+      // frozen is always feasible, which bounds the window's horizon.
+      const int64_t horizon = latest_release + total_duration;
+      for (int task : window.tasks) {
+        window.max_start.push_back(horizon - instance.tasks[task].duration);
+      }
+      window.fixed = frozen;
+      if (!tentative.empty()) {
+        window.hint.assign(window.tasks.size(), 0);
+        for (size_t i = 0; i < window.tasks.size(); ++i) {
+          window.hint[i] = i < tentative.size() ? tentative[i] : window.min_start[i];
+        }
+      }
+      record_model_size(window);
+
+      std::vector<int64_t> window_starts;
+      const double time_limit = subproblem_time_limit();
+      if (time_limit <= 0.0 ||
+          !SolveSubproblem(instance, window, time_limit, threads_per_component,
+                           &window_starts)) {
+        ++fallback_windows;
+        window_starts.resize(window.tasks.size());
+        int64_t cursor = latest_release;
+        for (size_t i = 0; i < window.tasks.size(); ++i) {
+          window_starts[i] = std::max(cursor, window.min_start[i]);
+          cursor = window_starts[i] + instance.tasks[window.tasks[i]].duration;
+        }
+      }
+      ++windows;
+
+      const int frozen_count = final_window ? last - first : std::min(step, last - first);
+      int64_t first_frozen_start = INT64_MAX;
+      for (int i = 0; i < frozen_count; ++i) {
+        const int task = window.tasks[i];
+        starts[task] = window_starts[i];
+        first_frozen_start = std::min(first_frozen_start, starts[task]);
+        frozen_end = std::max(frozen_end, end_of(task));
+        for (int r = 0; r < num_resources; ++r) {
+          const int demand = instance.tasks[task].resource_demands[r];
+          if (demand > 0 && instance.tasks[task].duration > 0) {
+            frozen.push_back({r, starts[task], end_of(task), demand});
+          }
+        }
+      }
+      floor = std::max(floor, first_frozen_start);
+      tentative.assign(window_starts.begin() + frozen_count, window_starts.end());
+      if (final_window) break;
+      freeze_points[c].push_back(first + frozen_count);
+    }
+  });
+
+  auto report = [&]() {
+    result.makespan = 0;
+    for (int i = 0; i < n; ++i) result.makespan = std::max(result.makespan, end_of(i));
+    if (incumbents != nullptr) {
+      incumbents->OnSolution(static_cast<double>(result.makespan),
+                             static_cast<double>(result.lower_bound), starts);
+    }
+  };
+  report();
+
+  // Stitching. Each stitch may only move its tasks inside the span
+  // [lo, hi) they occupy now, between their fixed predecessors and
+  // successors, so stitches with disjoint spans are independent.
+  ParallelFor(result.components, parallel_components, [&](int c) {
+    const std::vector<int>& order = components[c];
+    const int m = static_cast<int>(order.size());
+    struct Stitch {
+      int first;
+      int last;
+      int64_t lo;
+      int64_t hi;
+    };
+    std::vector<Stitch> pending;
+    for (int point : freeze_points[c]) {
+      const int first = std::max(0, point - stitch_tasks / 2);
+      const int last = std::min(m, first + stitch_tasks);
+      pending.push_back({first, last, 0, 0});
+    }
+    while (!pending.empty()) {
+      const double time_limit = subproblem_time_limit();
+      if (time_limit <= 0.0) return;
+      for (Stitch& stitch : pending) {
+        stitch.lo = INT64_MAX;
+        stitch.hi = 0;
+        for (int p = stitch.first; p < stitch.last; ++p) {
+          stitch.lo = std::min(stitch.lo, starts[order[p]]);
+          stitch.hi = std::max(stitch.hi, end_of(order[p]));
+        }
+      }
+      // Greedily pick stitches with pairwise disjoint spans for this round.
+      std::vector<Stitch> round;
+      std::vector<Stitch> deferred;
+      for (const Stitch& stitch : pending) {
+        bool disjoint = true;
+        for (const Stitch& other : round) {
+          if (stitch.lo < other.hi && other.lo < stitch.hi) {
+            disjoint = false;
+            break;
+          }
+        }
+        (disjoint ? round : deferred).push_back(stitch);
+      }
+
+      std::vector<Subproblem> subproblems(round.size());
+      std::vector<std::vector<int64_t>> improved(round.size());
+      const int round_size = static_cast<int>(round.size());
+      const int workers = std::max(1, threads_per_component / round_size);
+      ParallelFor(round_size, threads_per_component, [&](int s) {
+        const Stitch& stitch = round[s];
+        Subproblem& subproblem = subproblems[s];
+        std::unordered_set<int> members;
+        for (int p = stitch.first; p < stitch.last; ++p) {
+          const int task = order[p];
+          members.insert(task);
+          subproblem.tasks.push_back(task);
+          subproblem.hint.push_back(starts[task]);
+        }
+        for (int task : subproblem.tasks) {
+          int64_t min_start = stitch.lo;
+          int64_t max_start = stitch.hi - instance.tasks[task].duration;
+          for (int pred : predecessors[task]) {
+            if (members.count(pred) == 0) min_start = std::max(min_start, end_of(pred));
+          }
+          for (int succ : instance.tasks[task].successors) {
+            if (members.count(succ) == 0) {
+              max_start = std::min(max_start, starts[succ] - instance.tasks[task].duration);
+            }
+          }
+          subproblem.min_start.push_back(min_start);
+          subproblem.max_start.push_back(max_start);
+        }
+        for (int task : order) {
+          if (members.count(task) > 0 || starts[task] >= stitch.hi ||
+              end_of(task) <= stitch.lo) {
+            continue;
+          }
+          for (int r = 0; r < num_resources; ++r) {
+            const int demand = instance.tasks[task].resource_demands[r];
+            if (demand > 0 && instance.tasks[task].duration > 0) {
+              subproblem.fixed.push_back({r, starts[task], end_of(task), demand});
+            }
+          }
+        }
+        record_model_size(subproblem);
+        std::vector<int64_t> stitched;
+        if (SolveSubproblem(instance, subproblem, time_limit, workers, &stitched) &&
+            SubproblemObjective(instance, subproblem, stitched) <
+                SubproblemObjective(instance, subproblem, subproblem.hint)) {
+          improved[s] = std::move(stitched);
+        }
+      });
+      // Apply after the round so that its stitches all read the same schedule.
+      for (int s = 0; s < round_size; ++s) {
+        ++stitches;
+        if (improved[s].empty()) continue;
+        ++improved_stitches;
+        for (size_t i = 0; i < subproblems[s].tasks.size(); ++i) {
+          starts[subproblems[s].tasks[i]] = improved[s][i];
+        }
+      }
+      pending = std::move(deferred);
+    }
+  });
+  report();
+
+  result.windows = windows;
+  result.fallback_windows = fallback_windows;
+  result.stitches = stitches;
+  result.improved_stitches = improved_stitches;
+  result.max_model_intervals = max_model_intervals;
+  return result;
+}
+
+#endif  // ROLLING_HORIZON_H_
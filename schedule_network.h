@@ -0,0 +1,268 @@
+#ifndef SCHEDULE_NETWORK_H_
+#define SCHEDULE_NETWORK_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "rcpsp_instance.h"
+
+// A fixed schedule turned into a precedence network.
+//
+// Besides the instance precedences, every resource gets `capacity` chains and
+// each task is appended to as many chains as it has units of demand
+// (Policella-style chaining). The resulting flow arcs say which task hands
+// its resource units to which, so earliest starts over the network stay
+// resource feasible for any durations and a replay of the schedule is a
+// plain longest-path computation.
+
+struct ScheduleNetwork {
+  int num_tasks = 0;
+  // Tasks sorted by nominal start; also a topological order of all arcs.
+  std::vector<int> order;
+  // Predecessors and successors in CSR form, indexed by task.
+  std::vector<int> predecessor_offsets;
+  std::vector<int> predecessors;
+  std::vector<int> successor_offsets;
+  std::vector<int> successors;
+  int num_precedence_arcs = 0;
+  int num_flow_arcs = 0;
+  int64_t nominal_makespan = 0;
+};
+
+// Checks precedences and capacities of `starts`. On failure, describes the
+// first violation in `error`.
+inline bool IsFeasibleSchedule(const RCPSPInstance& instance,
+                               const std::vector<int64_t>& starts,
+                               std::string* error) {
+  const int n = static_cast<int>(instance.tasks.size());
+  if (static_cast<int>(starts.size()) != n) {
+    *error = "schedule has " + std::to_string(starts.size()) + " starts for " +
+             std::to_string(n) + " tasks";
+    return false;
+  }
+  for (int i = 0; i < n; ++i) {
+    if (starts[i] < 0) {
+      *error = "task " + std::to_string(i) + " is not scheduled";
+      return false;
+    }
+    for (int succ : instance.tasks[i].successors) {
+      if (starts[i] + instance.tasks[i].duration > starts[succ]) {
+        *error = "precedence " + std::to_string(i) + " -> " +
+                 std::to_string(succ) + " is violated";
+        return false;
+      }
+    }
+  }
+  std::vector<std::pair<int64_t, int>> events;
+  for (size_t r = 0; r < instance.resources.size(); ++r) {
+    events.clear();
+    for (int i = 0; i < n; ++i) {
+      const int demand = instance.tasks[i].resource_demands[r];
+      if (demand == 0 || instance.tasks[i].duration == 0) continue;
+      events.push_back({starts[i], demand});
+      events.push_back({starts[i] + instance.tasks[i].duration, -demand});
+    }
+    // Releases sort before acquisitions at the same time.
+    std::sort(events.begin(), events.end());
+    int usage = 0;
+    for (const auto& event : events) {
+      usage += event.second;
+      if (usage > instance.resources[r].capacity) {
+        *error = "resource " + std::to_string(r) + " is overloaded at time " +
+                 std::to_string(event.first);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Checks that no task demands more of a resource than its capacity, which
+// makes every schedule infeasible. On failure, names the first such task in
+// `error`.
+inline bool DemandsFitCapacities(const RCPSPInstance& instance, std::string* error) {
+  for (size_t i = 0; i < instance.tasks.size(); ++i) {
+    const Task& task = instance.tasks[i];
+    if (task.duration == 0) continue;
+    for (size_t r = 0; r < instance.resources.size(); ++r) {
+      if (task.resource_demands[r] > instance.resources[r].capacity) {
+        *error = "task " + std::to_string(i) + " demands " +
+                 std::to_string(task.resource_demands[r]) + " of resource " +
+                 std::to_string(r) + ", whose capacity is " +
+                 std::to_string(instance.resources[r].capacity);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Serial schedule generation: tasks are started as early as possible in the
+// given order, which must list every predecessor before its successors.
+// Returns an empty vector if it does not, or if a task demands more than a
+// capacity and so never fits.
+inline std::vector<int64_t> SerialSchedule(const RCPSPInstance& instance,
+                                           const std::vector<int>& priority) {
+  const int n = static_cast<int>(instance.tasks.size());
+  const int num_resources = static_cast<int>(instance.resources.size());
+  std::string error;
+  if (!DemandsFitCapacities(instance, &error)) return {};
+  const std::vector<std::vector<int>> predecessors = ComputePredecessors(instance);
+  std::vector<int64_t> starts(n, -1);
+  // Time-indexed usage, one row per resource, grown on demand.
+  std::vector<std::vector<int>> usage(num_resources);
+  for (int task : priority) {
+    const Task& t = instance.tasks[task];
+    int64_t start = 0;
+    for (int pred : predecessors[task]) {
+      if (starts[pred] < 0) return {};
+      start = std::max<int64_t>(start, starts[pred] + instance.tasks[pred].duration);
+    }
+    for (bool fits = false; !fits;) {
+      fits = true;
+      for (int r = 0; r < num_resources && fits; ++r) {
+        if (t.resource_demands[r] == 0) continue;
+        std::vector<int>& row = usage[r];
+        if (row.size() < static_cast<size_t>(start + t.duration)) {
+          row.resize(start + t.duration, 0);
+        }
+        for (int64_t time = start; time < start + t.duration; ++time) {
+          if (row[time] + t.resource_demands[r] > instance.resources[r].capacity) {
+            fits = false;
+            start = time + 1;
+            break;
+          }
+        }
+      }
+    }
+    starts[task] = start;
+    for (int r = 0; r < num_resources; ++r) {
+      if (t.resource_demands[r] == 0) continue;
+      for (int64_t time = start; time < start + t.duration; ++time) {
+        usage[r][time] += t.resource_demands[r];
+      }
+    }
+  }
+  for (int64_t start : starts) {
+    if (start < 0) return {};
+  }
+  return starts;
+}
+
+// Builds the precedence and resource-flow network of a feasible schedule.
+inline ScheduleNetwork BuildScheduleNetwork(const RCPSPInstance& instance,
+                                            const std::vector<int64_t>& starts) {
+  const int n = static_cast<int>(instance.tasks.size());
+  ScheduleNetwork network;
+  network.num_tasks = n;
+  // Ties on the start are broken by topological rank so that a zero-duration
+  // task comes before the successors that start with it.
+  network.order = TopologicalOrder(instance);
+  std::stable_sort(network.order.begin(), network.order.end(),
+                   [&](int a, int b) { return starts[a] < starts[b]; });
+
+  std::vector<std::vector<int>> predecessors = ComputePredecessors(instance);
+  for (const std::vector<int>& preds : predecessors) {
+    network.num_precedence_arcs += static_cast<int>(preds.size());
+  }
+
+  struct Chain {
+    int last_task;
+    int64_t free_at;
+  };
+  for (size_t r = 0; r < instance.resources.size(); ++r) {
+    std::vector<Chain> chains(instance.resources[r].capacity, Chain{-1, 0});
+    std::vector<int> picked;
+    for (int task : network.order) {
+      const int demand = instance.tasks[task].resource_demands[r];
+      if (demand == 0) continue;
+      std::vector<int>& preds = predecessors[task];
+      auto is_predecessor = [&](int other) {
+        return std::find(preds.begin(), preds.end(), other) != preds.end();
+      };
+      // Chains whose last task already precedes this one add no arc, so they
+      // are taken first; then the chains that freed up last.
+      picked.clear();
+      for (int c = 0; c < static_cast<int>(chains.size()) &&
+                      static_cast<int>(picked.size()) < demand;
+           ++c) {
+        if (chains[c].free_at <= starts[task] &&
+            (chains[c].last_task < 0 || is_predecessor(chains[c].last_task))) {
+          picked.push_back(c);
+        }
+      }
+      if (static_cast<int>(picked.size()) < demand) {
+        std::vector<int> available;
+        for (int c = 0; c < static_cast<int>(chains.size()); ++c) {
+          if (chains[c].free_at <= starts[task] &&
+              std::find(picked.begin(), picked.end(), c) == picked.end()) {
+            available.push_back(c);
+          }
+        }
+        std::sort(available.begin(), available.end(), [&](int a, int b) {
+          return chains[a].free_at > chains[b].free_at;
+        });
+        for (int c : available) {
+          if (static_cast<int>(picked.size()) == demand) break;
+          picked.push_back(c);
+        }
+      }
+      for (int c : picked) {
+        const int last = chains[c].last_task;
+        if (last >= 0 && !is_predecessor(last)) {
+          preds.push_back(last);
+          ++network.num_flow_arcs;
+        }
+        chains[c] = {task, starts[task] + instance.tasks[task].duration};
+      }
+    }
+  }
+
+  network.predecessor_offsets.assign(n + 1, 0);
+  network.successor_offsets.assign(n + 1, 0);
+  for (int i = 0; i < n; ++i) {
+    network.predecessor_offsets[i + 1] =
+        network.predecessor_offsets[i] + static_cast<int>(predecessors[i].size());
+    for (int pred : predecessors[i]) ++network.successor_offsets[pred + 1];
+  }
+  for (int i = 0; i < n; ++i) {
+    network.successor_offsets[i + 1] += network.successor_offsets[i];
+  }
+  network.predecessors.resize(network.predecessor_offsets[n]);
+  network.successors.resize(network.successor_offsets[n]);
+  std::vector<int> next_successor(network.successor_offsets.begin(),
+                                  network.successor_offsets.end() - 1);
+  for (int i = 0; i < n; ++i) {
+    std::copy(predecessors[i].begin(), predecessors[i].end(),
+              network.predecessors.begin() + network.predecessor_offsets[i]);
+    for (int pred : predecessors[i]) {
+      network.successors[next_successor[pred]++] = i;
+    }
+  }
+  for (int i = 0; i < n; ++i) {
+    network.nominal_makespan = std::max<int64_t>(
+        network.nominal_makespan, starts[i] + instance.tasks[i].duration);
+  }
+  return network;
+}
+
+// Earliest starts over the network for the given durations.
+template <typename T>
+std::vector<T> NetworkEarliestStarts(const ScheduleNetwork& network,
+                                     const std::vector<T>& durations) {
+  std::vector<T> starts(network.num_tasks, T(0));
+  for (int task : network.order) {
+    T start = T(0);
+    for (int a = network.predecessor_offsets[task];
+         a < network.predecessor_offsets[task + 1]; ++a) {
+      const int pred = network.predecessors[a];
+      start = std::max(start, starts[pred] + durations[pred]);
+    }
+    starts[task] = start;
+  }
+  return starts;
+}
+
+#endif  // SCHEDULE_NETWORK_H_
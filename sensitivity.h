@@ -0,0 +1,412 @@
+#ifndef SENSITIVITY_H_
+#define SENSITIVITY_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "json_escape.h"
+#include "makespan_bounds.h"
+#include "model_strengthening.h"
+#include "ortools/sat/cp_model.h"
+#include "ortools/sat/cp_model_solver.h"
+#include "ortools/sat/sat_parameters.pb.h"
+#include "parallel_for.h"
+#include "rcpsp_instance.h"
+#include "rcpsp_model.h"
+#include "schedule_network.h"
+
+// Makespan sensitivity of a solved instance: the makespan after changing a
+// task's duration or a resource's capacity by +k and by -k.
+//
+// The solved schedule is turned into its precedence and resource-flow network
+// (schedule_network.h), whose replay stays feasible under any durations and
+// under more capacity. Every change is first screened without solving:
+//
+//   duration +k   the replay with the longer task is an upper bound; if it
+//                 keeps the makespan, the task's float absorbs the change
+//   duration -k   a task with float in the network cannot shorten the replay,
+//                 so it is skipped (not exact: another order might gain)
+//   capacity -k   if the schedule's peak use fits the lower capacity it stays
+//                 feasible; below the largest demand nothing is
+//   any change    when critical path and energy bounds of the changed
+//                 instance meet the upper bound, the makespan is known
+//
+// Longer tasks and less capacity never shorten the optimal makespan, so if
+// the base schedule is optimal, such a change screened at the same makespan
+// is exact. The rest are re-solved concurrently, each with one CP-SAT worker,
+// the screening bounds as constraints and a feasible schedule of the changed
+// instance as hint.
+
+struct SensitivityOptions {
+  int delta = 0;            // change k; 0: no analysis
+  double time_limit = 1.0;  // per re-solve
+  int num_threads = 0;      // 0: one per hardware thread
+
+  bool enabled() const { return delta > 0; }
+
+  // Parses "--sensitivity=K", "--sensitivity_time_limit=S" and
+  // "--sensitivity_threads=N". Returns false for any other argument.
+  bool ParseFlag(const std::string& arg) {
+    const size_t eq = arg.find('=');
+    if (arg.rfind("--", 0) != 0 || eq == std::string::npos) return false;
+    const std::string name = arg.substr(2, eq - 2);
+    const char* value = arg.c_str() + eq + 1;
+    if (name == "sensitivity") {
+      delta = std::atoi(value);
+    } else if (name == "sensitivity_time_limit") {
+      time_limit = std::atof(value);
+    } else if (name == "sensitivity_threads") {
+      num_threads = std::atoi(value);
+    } else {
+      return false;
+    }
+    return true;
+  }
+};
+
+struct SensitivityChange {
+  enum class Kind { kDuration, kCapacity };
+  enum class Method { kFloat, kPeak, kBound, kSolved, kInfeasible };
+
+  Kind kind = Kind::kDuration;
+  int index = 0;   // task or resource
+  int change = 0;  // applied change; durations and capacities stay >= 0
+  int64_t makespan = 0;
+  int64_t lower_bound = 0;
+  Method method = Method::kSolved;
+  bool exact = false;  // makespan is the optimum of the changed instance
+
+  static const char* MethodName(Method method) {
+    switch (method) {
+      case Method::kFloat:
+        return "float";
+      case Method::kPeak:
+        return "peak";
+      case Method::kBound:
+        return "bound";
+      case Method::kSolved:
+        return "solved";
+      case Method::kInfeasible:
+        return "infeasible";
+    }
+    return "";
+  }
+};
+
+struct SensitivityResult {
+  int delta = 0;
+  int64_t base_makespan = 0;
+  bool base_optimal = false;
+  // Ranked by decreasing makespan change, infeasible changes first.
+  std::vector<SensitivityChange> changes;
+  // Per task: float in the schedule network and the makespan change for
+  // +k and -k on its duration.
+  std::vector<int64_t> task_float;
+  std::vector<int64_t> task_increase;
+  std::vector<int64_t> task_decrease;
+  int screened = 0;
+  int solved = 0;
+  double wall_time = 0.0;
+
+  int64_t Delta(const SensitivityChange& change) const {
+    return change.makespan - base_makespan;
+  }
+
+  // Share of k by which the task's duration moves the makespan, in [0, 1].
+  double Criticality(int task) const {
+    const int64_t moved =
+        std::max(std::abs(task_increase[task]), std::abs(task_decrease[task]));
+    return std::min(1.0, static_cast<double>(moved) / delta);
+  }
+
+  std::string Summary() const {
+    std::ostringstream oss;
+    oss << changes.size() << " changes of " << delta << ": " << screened
+        << " screened, " << solved << " re-solved in " << wall_time << " s";
+    if (!base_optimal) oss << " (base makespan not proven optimal)";
+    return oss.str();
+  }
+
+  // The ranked changes that move the makespan, one per line.
+  std::string Table(const RCPSPInstance& instance) const {
+    std::ostringstream oss;
+    oss << std::left << std::setw(6) << "rank" << std::setw(32) << "change"
+        << std::setw(10) << "makespan" << std::setw(8) << "delta" << "how\n";
+    int rank = 0;
+    int unchanged = 0;
+    for (const SensitivityChange& change : changes) {
+      const bool infeasible = change.method == SensitivityChange::Method::kInfeasible;
+      if (!infeasible && Delta(change) == 0) {
+        ++unchanged;
+        continue;
+      }
+      std::ostringstream what;
+      if (change.kind == SensitivityChange::Kind::kDuration) {
+        what << "duration of " << instance.tasks[change.index].name;
+      } else {
+        what << "capacity of resource " << change.index;
+      }
+      what << " " << (change.change > 0 ? "+" : "") << change.change;
+      std::ostringstream delta_text;
+      if (!infeasible) delta_text << (Delta(change) > 0 ? "+" : "") << Delta(change);
+      oss << std::setw(6) << ++rank << std::setw(32) << what.str() << std::setw(10)
+          << (infeasible ? std::string("-") : std::to_string(change.makespan))
+          << std::setw(8) << delta_text.str() << SensitivityChange::MethodName(change.method)
+          << (change.exact || infeasible ? "" : ", not proven") << "\n";
+    }
+    oss << unchanged << " changes leave the makespan at " << base_makespan << "\n";
+    return oss.str();
+  }
+
+  // Trace annotation: the ranked changes, and per task its float and
+  // criticality, which the Gantt view colors bars by.
+  std::string ToJson(const RCPSPInstance& instance) const {
+    std::ostringstream oss;
+    oss << "{\"delta\": " << delta << ", \"baseMakespan\": " << base_makespan
+        << ", \"baseOptimal\": " << (base_optimal ? "true" : "false")
+        << ", \"screened\": " << screened << ", \"solved\": " << solved
+        << ", \"wallTime\": " << wall_time << ", \"changes\": [";
+    for (size_t c = 0; c < changes.size(); ++c) {
+      const SensitivityChange& change = changes[c];
+      const bool infeasible = change.method == SensitivityChange::Method::kInfeasible;
+      oss << (c > 0 ? ", " : "") << "{\"kind\": \""
+          << (change.kind == SensitivityChange::Kind::kDuration ? "duration" : "capacity")
+          << "\", \""
+          << (change.kind == SensitivityChange::Kind::kDuration ? "taskId" : "resourceId")
+          << "\": " << change.index << ", \"change\": " << change.change
+          << ", \"makespan\": " << (infeasible ? "null" : std::to_string(change.makespan))
+          << ", \"delta\": " << (infeasible ? "null" : std::to_string(Delta(change)))
+          << ", \"method\": \"" << SensitivityChange::MethodName(change.method)
+          << "\", \"exact\": " << (change.exact ? "true" : "false") << "}";
+    }
+    oss << "], \"tasks\": [";
+    for (size_t i = 0; i < task_float.size(); ++i) {
+      oss << (i > 0 ? ", " : "") << "{\"taskId\": " << i << ", \"taskName\": \""
+          << JsonEscaped(instance.tasks[i].name) << "\", \"float\": " << task_float[i]
+          << ", \"increase\": " << task_increase[i] << ", \"decrease\": " << task_decrease[i]
+          << ", \"criticality\": " << Criticality(static_cast<int>(i)) << "}";
+    }
+    oss << "]}";
+    return oss.str();
+  }
+};
+
+namespace sensitivity_internal {
+
+inline int64_t Makespan(const RCPSPInstance& instance, const std::vector<int64_t>& starts) {
+  int64_t makespan = 0;
+  for (size_t i = 0; i < instance.tasks.size(); ++i) {
+    makespan = std::max(makespan, starts[i] + instance.tasks[i].duration);
+  }
+  return makespan;
+}
+
+// Latest starts over the network under the deadline.
+inline std::vector<int64_t> NetworkLatestStarts(const ScheduleNetwork& network,
+                                                const RCPSPInstance& instance,
+                                                int64_t deadline) {
+  std::vector<int64_t> latest(network.num_tasks, 0);
+  for (auto it = network.order.rbegin(); it != network.order.rend(); ++it) {
+    const int task = *it;
+    int64_t finish = deadline;
+    for (int a = network.successor_offsets[task]; a < network.successor_offsets[task + 1];
+         ++a) {
+      finish = std::min(finish, latest[network.successors[a]]);
+    }
+    latest[task] = finish - instance.tasks[task].duration;
+  }
+  return latest;
+}
+
+// Minimizes the makespan of the changed instance within [lower, upper],
+// starting from `hint`, a feasible schedule of makespan `upper`.
+inline void Resolve(const RCPSPInstance& instance, const std::vector<int64_t>& hint,
+                    double time_limit, SensitivityChange* change) {
+  using namespace operations_research::sat;
+  RcpspModel model;
+  BuildRcpspModel(instance, StrengtheningOptions(), &model);
+  model.builder.AddGreaterOrEqual(model.makespan, change->lower_bound);
+  model.builder.AddLessOrEqual(model.makespan, change->makespan);
+  for (size_t i = 0; i < hint.size(); ++i) model.builder.AddHint(model.starts[i], hint[i]);
+
+  SatParameters parameters;
+  parameters.set_num_workers(1);
+  parameters.set_max_time_in_seconds(time_limit);
+  const CpSolverResponse response = SolveWithParameters(model.builder.Build(), parameters);
+  if (response.status() == CpSolverStatus::OPTIMAL ||
+      response.status() == CpSolverStatus::FEASIBLE) {
+    change->makespan = std::min<int64_t>(change->makespan,
+                                         SolutionIntegerValue(response, model.makespan));
+  }
+  change->lower_bound = std::max<int64_t>(
+      change->lower_bound, static_cast<int64_t>(response.best_objective_bound()));
+  change->exact = response.status() == CpSolverStatus::OPTIMAL ||
+                  change->lower_bound >= change->makespan;
+}
+
+}  // namespace sensitivity_internal
+
+// Analyzes the makespan sensitivity around `starts`, a feasible schedule of
+// the instance. `base_optimal` says whether its makespan is proven optimal.
+inline SensitivityResult AnalyzeSensitivity(const RCPSPInstance& instance,
+                                            const std::vector<int64_t>& starts,
+                                            bool base_optimal,
+                                            const SensitivityOptions& options) {
+  using namespace sensitivity_internal;
+  using Kind = SensitivityChange::Kind;
+  using Method = SensitivityChange::Method;
+  const auto start_time = std::chrono::steady_clock::now();
+  const int n = static_cast<int>(instance.tasks.size());
+  const int k = options.delta;
+  const int num_threads =
+      options.num_threads > 0
+          ? options.num_threads
+          : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+  SensitivityResult result;
+  result.delta = k;
+  result.base_makespan = Makespan(instance, starts);
+  result.base_optimal = base_optimal;
+
+  const ScheduleNetwork network = BuildScheduleNetwork(instance, starts);
+  std::vector<int64_t> durations(n);
+  for (int i = 0; i < n; ++i) durations[i] = instance.tasks[i].duration;
+  const std::vector<int64_t> earliest = NetworkEarliestStarts(network, durations);
+  const std::vector<int64_t> latest =
+      NetworkLatestStarts(network, instance, result.base_makespan);
+  result.task_float.resize(n);
+  for (int i = 0; i < n; ++i) result.task_float[i] = latest[i] - earliest[i];
+
+  // Screen every change; the ones left are re-solved below.
+  struct Pending {
+    int change;
+    RCPSPInstance instance;
+    std::vector<int64_t> hint;
+  };
+  std::vector<Pending> pending;
+  // `skip` is the screen that settles the change without solving, if any.
+  auto screen = [&](SensitivityChange change, RCPSPInstance changed,
+                    std::vector<int64_t> hint, Method skip) {
+    change.makespan = Makespan(changed, hint);
+    change.lower_bound = MakespanLowerBound(changed);
+    if (change.lower_bound >= change.makespan) {
+      change.method = Method::kBound;
+      change.exact = true;
+      result.changes.push_back(change);
+      return;
+    }
+    if (skip != Method::kSolved) {
+      change.method = skip;
+      // A change that cannot shorten the optimum and keeps an optimal
+      // makespan is exact.
+      const bool lengthens = (change.kind == Kind::kDuration) == (change.change > 0);
+      change.exact = base_optimal && lengthens;
+      result.changes.push_back(change);
+      return;
+    }
+    result.changes.push_back(change);
+    pending.push_back({static_cast<int>(result.changes.size()) - 1, std::move(changed),
+                       std::move(hint)});
+  };
+
+  for (int i = 0; i < n; ++i) {
+    // Milestones have no duration to change.
+    if (instance.tasks[i].duration == 0) continue;
+    for (const int sign : {+1, -1}) {
+      SensitivityChange change;
+      change.kind = Kind::kDuration;
+      change.index = i;
+      change.change = std::max(sign * k, -instance.tasks[i].duration);
+      RCPSPInstance changed = instance;
+      changed.tasks[i].duration += change.change;
+      changed.horizon += change.change;
+      std::vector<int64_t> changed_durations = durations;
+      changed_durations[i] += change.change;
+      std::vector<int64_t> replay = NetworkEarliestStarts(network, changed_durations);
+      const int64_t replay_makespan = Makespan(changed, replay);
+      const bool absorbed = sign > 0 ? replay_makespan <= result.base_makespan
+                                     : result.task_float[i] > 0;
+      screen(change, std::move(changed), std::move(replay),
+             absorbed ? Method::kFloat : Method::kSolved);
+    }
+  }
+  for (size_t r = 0; r < instance.resources.size(); ++r) {
+    int peak = 0;
+    int largest_demand = 0;
+    {
+      std::vector<std::pair<int64_t, int>> events;
+      for (int i = 0; i < n; ++i) {
+        const int demand = instance.tasks[i].resource_demands[r];
+        largest_demand = std::max(largest_demand, demand);
+        if (demand == 0 || instance.tasks[i].duration == 0) continue;
+        events.push_back({starts[i], demand});
+        events.push_back({starts[i] + instance.tasks[i].duration, -demand});
+      }
+      std::sort(events.begin(), events.end());
+      int usage = 0;
+      for (const auto& event : events) {
+        usage += event.second;
+        peak = std::max(peak, usage);
+      }
+    }
+    for (const int sign : {+1, -1}) {
+      SensitivityChange change;
+      change.kind = Kind::kCapacity;
+      change.index = static_cast<int>(r);
+      change.change = std::max(sign * k, -instance.resources[r].capacity);
+      RCPSPInstance changed = instance;
+      changed.resources[r].capacity += change.change;
+      if (changed.resources[r].capacity < largest_demand) {
+        change.method = Method::kInfeasible;
+        change.exact = true;
+        result.changes.push_back(change);
+        continue;
+      }
+      if (sign > 0) {
+        // The schedule, left-shifted over its network, is still feasible.
+        std::vector<int64_t> replay = NetworkEarliestStarts(network, durations);
+        screen(change, std::move(changed), std::move(replay), Method::kSolved);
+      } else if (peak <= changed.resources[r].capacity) {
+        screen(change, std::move(changed), starts, Method::kPeak);
+      } else {
+        std::vector<int64_t> hint = SerialSchedule(changed, network.order);
+        screen(change, std::move(changed), std::move(hint), Method::kSolved);
+      }
+    }
+  }
+  result.screened = static_cast<int>(result.changes.size() - pending.size());
+  result.solved = static_cast<int>(pending.size());
+
+  ParallelFor(
+      static_cast<int>(pending.size()), num_threads, [&](int p) {
+        Resolve(pending[p].instance, pending[p].hint, options.time_limit,
+                &result.changes[pending[p].change]);
+      });
+
+  result.task_increase.assign(n, 0);
+  result.task_decrease.assign(n, 0);
+  for (const SensitivityChange& change : result.changes) {
+    if (change.kind != Kind::kDuration) continue;
+    (change.change > 0 ? result.task_increase : result.task_decrease)[change.index] =
+        result.Delta(change);
+  }
+  std::stable_sort(result.changes.begin(), result.changes.end(),
+                   [&](const SensitivityChange& a, const SensitivityChange& b) {
+                     const bool a_infeasible = a.method == Method::kInfeasible;
+                     const bool b_infeasible = b.method == Method::kInfeasible;
+                     if (a_infeasible != b_infeasible) return a_infeasible;
+                     return std::abs(result.Delta(a)) > std::abs(result.Delta(b));
+                   });
+  result.wall_time =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+  return result;
+}
+
+#endif  // SENSITIVITY_H_
@@ -0,0 +1,202 @@
+#ifndef SOLVER_CONFIG_H_
+#define SOLVER_CONFIG_H_
+
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "google/protobuf/text_format.h"
+#include "model_strengthening.h"
+#include "ortools/sat/cp_model.pb.h"
+#include "ortools/sat/sat_parameters.pb.h"
+
+// Solver configuration shared by driver and rcpsp_solver and written by
+// rcpsp_tune. A config file is a SatParameters text proto in which lines of
+// the form "model.<option>: <value>" set model-building options instead:
+//
+//   search_branching: PORTFOLIO_SEARCH
+//   linearization_level: 2
+//   num_workers: 8
+//   model.strengthen: true
+//   model.variable_selection: CHOOSE_LOWEST_MIN
+//   model.domain_reduction: SELECT_MIN_VALUE
+//
+// Both binaries load one with --params=FILE. Flags on the command line still
+// take precedence over the file.
+
+struct ModelOptions {
+  bool strengthen = false;
+  bool forbidden_sets = false;
+  // Decision strategy over the start variables, in their task order. Unset
+  // leaves the search to CP-SAT.
+  std::optional<operations_research::sat::DecisionStrategyProto::
+                    VariableSelectionStrategy>
+      variable_selection;
+  operations_research::sat::DecisionStrategyProto::DomainReductionStrategy
+      domain_reduction =
+          operations_research::sat::DecisionStrategyProto::SELECT_MIN_VALUE;
+
+  // Parses one "model." option, without the prefix. Returns false for an
+  // unknown option or value.
+  bool Set(const std::string& name, const std::string& value) {
+    using operations_research::sat::DecisionStrategyProto;
+    if (name == "strengthen" || name == "forbidden_sets") {
+      bool flag;
+      if (value == "true" || value == "1") {
+        flag = true;
+      } else if (value == "false" || value == "0") {
+        flag = false;
+      } else {
+        return false;
+      }
+      (name == "strengthen" ? strengthen : forbidden_sets) = flag;
+      return true;
+    }
+    if (name == "variable_selection") {
+      DecisionStrategyProto::VariableSelectionStrategy strategy;
+      if (value == "NONE") {
+        variable_selection.reset();
+        return true;
+      }
+      if (!DecisionStrategyProto::VariableSelectionStrategy_Parse(value,
+                                                                  &strategy)) {
+        return false;
+      }
+      variable_selection = strategy;
+      return true;
+    }
+    if (name == "domain_reduction") {
+      return DecisionStrategyProto::DomainReductionStrategy_Parse(
+          value, &domain_reduction);
+    }
+    return false;
+  }
+
+  void ApplyTo(StrengtheningOptions* strengthening) const {
+    strengthening->enabled = strengthen || forbidden_sets;
+    strengthening->forbidden_sets = forbidden_sets;
+  }
+
+  // Adds the decision strategy, if any, over the given proto variables.
+  void AddSearchStrategy(const std::vector<int>& start_variables,
+                         operations_research::sat::CpModelProto* proto) const {
+    if (!variable_selection.has_value()) return;
+    operations_research::sat::DecisionStrategyProto* strategy =
+        proto->add_search_strategy();
+    strategy->set_variable_selection_strategy(*variable_selection);
+    strategy->set_domain_reduction_strategy(domain_reduction);
+    for (const int var : start_variables) strategy->add_variables(var);
+  }
+
+  std::string ToString() const {
+    using operations_research::sat::DecisionStrategyProto;
+    std::stringstream text;
+    text << "model.strengthen: " << (strengthen ? "true" : "false") << "\n";
+    text << "model.forbidden_sets: " << (forbidden_sets ? "true" : "false")
+         << "\n";
+    text << "model.variable_selection: "
+         << (variable_selection.has_value()
+                 ? DecisionStrategyProto::VariableSelectionStrategy_Name(
+                       *variable_selection)
+                 : std::string("NONE"))
+         << "\n";
+    text << "model.domain_reduction: "
+         << DecisionStrategyProto::DomainReductionStrategy_Name(
+                domain_reduction)
+         << "\n";
+    return text.str();
+  }
+};
+
+struct SolverConfig {
+  operations_research::sat::SatParameters parameters;
+  ModelOptions model;
+
+  // Parses the text of a config file. On failure returns false and describes
+  // the problem in *error.
+  bool Parse(const std::string& text, std::string* error) {
+    std::stringstream in(text);
+    std::string proto_text;
+    std::string line;
+    int line_number = 0;
+    while (std::getline(in, line)) {
+      ++line_number;
+      const size_t begin = line.find_first_not_of(" \t");
+      if (begin == std::string::npos || line.compare(begin, 6, "model.") != 0) {
+        proto_text += line;
+        proto_text += '\n';
+        continue;
+      }
+      const size_t colon = line.find(':', begin);
+      if (colon == std::string::npos ||
+          !model.Set(Trim(line.substr(begin + 6, colon - begin - 6)),
+                     Trim(line.substr(colon + 1)))) {
+        *error = "line " + std::to_string(line_number) +
+                 ": bad model option '" + Trim(line) + "'";
+        return false;
+      }
+    }
+    if (!google::protobuf::TextFormat::ParseFromString(proto_text,
+                                                       &parameters)) {
+      *error = "invalid SatParameters text";
+      return false;
+    }
+    return true;
+  }
+
+  bool Load(const std::string& filename, std::string* error) {
+    std::ifstream file(filename);
+    if (!file) {
+      *error = "cannot open " + filename;
+      return false;
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+    return Parse(text.str(), error);
+  }
+
+  // The config file text; `header` lines are written as comments.
+  std::string ToString(const std::vector<std::string>& header = {}) const {
+    std::string text;
+    for (const std::string& line : header) text += "# " + line + "\n";
+    std::string proto_text;
+    google::protobuf::TextFormat::PrintToString(parameters, &proto_text);
+    return text + proto_text + model.ToString();
+  }
+
+  // Returns true for "--params=FILE", which LoadFromArgs handles.
+  static bool IsFlag(const std::string& arg) {
+    return arg.rfind("--params=", 0) == 0;
+  }
+
+  // Loads the file of the last --params flag among the arguments, so that
+  // the other flags can be parsed on top of it afterwards. Returns false if
+  // the file cannot be loaded.
+  bool LoadFromArgs(int argc, char** argv) {
+    std::string filename;
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      if (IsFlag(arg)) filename = arg.substr(9);
+    }
+    if (filename.empty()) return true;
+    std::string error;
+    if (!Load(filename, &error)) {
+      std::cerr << "Cannot load " << filename << ": " << error << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  static std::string Trim(const std::string& text) {
+    const size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) return "";
+    const size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+  }
+};
+
+#endif  // SOLVER_CONFIG_H_
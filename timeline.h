@@ -0,0 +1,222 @@
+#ifndef TIMELINE_H_
+#define TIMELINE_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "json_escape.h"
+
+// Wall-time profile of a run, exported in the Chrome trace-event JSON format
+// that chrome://tracing, Perfetto (ui.perfetto.dev) and speedscope open.
+// Unlike the event trace, whose timestamps are milliseconds since start for
+// the frontend, spans here are recorded with the steady clock's nanosecond
+// resolution, and every thread that records one gets its own track.
+//
+//   Timeline timeline;
+//   {
+//     TimelineSpan span(&timeline, "LoadCpModel", "solver");
+//     LoadCpModel(model_proto, &model);
+//   }
+//   timeline.Instant("Incumbent", "solver", "{\"objective\":42}");
+//   timeline.WriteTo("run.trace.json", &error);
+//
+// Recording takes a mutex; hot paths sample rather than record every call.
+
+struct TimelineOptions {
+  std::string file;           // empty: no timeline
+  int propagate_sample = 64;  // record one Propagate() call in N
+  int max_events = 1 << 20;   // later events are counted and dropped
+
+  bool enabled() const { return !file.empty(); }
+
+  // Parses "--timeline=FILE", "--timeline_sample=N" and
+  // "--timeline_max_events=N". Returns false for any other argument.
+  bool ParseFlag(const std::string& arg) {
+    const size_t eq = arg.find('=');
+    if (arg.rfind("--", 0) != 0 || eq == std::string::npos) return false;
+    const std::string name = arg.substr(2, eq - 2);
+    const char* value = arg.c_str() + eq + 1;
+    if (name == "timeline") {
+      file = value;
+    } else if (name == "timeline_sample") {
+      propagate_sample = std::max(1, std::atoi(value));
+    } else if (name == "timeline_max_events") {
+      max_events = std::max(0, std::atoi(value));
+    } else {
+      return false;
+    }
+    return true;
+  }
+};
+
+class Timeline {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit Timeline(int max_events = 1 << 20)
+      : start_(Clock::now()), max_events_(max_events) {}
+
+  Timeline(const Timeline&) = delete;
+  Timeline& operator=(const Timeline&) = delete;
+
+  // Names the track of the calling thread, e.g. "batch 3". Threads that do
+  // not name theirs are shown as "main" (the first one seen) or "thread N".
+  void NameThread(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tracks_[TrackLocked()].name = name;
+  }
+
+  // A span of the calling thread from `begin` to `end`. `args` is a JSON
+  // object shown with the span, or empty.
+  void Complete(std::string_view name, const char* category, Clock::time_point begin,
+                Clock::time_point end, std::string_view args = {}) {
+    Add('X', name, category, begin, end - begin, args);
+  }
+
+  // A point event on the track of the calling thread.
+  void Instant(std::string_view name, const char* category, std::string_view args = {}) {
+    Add('i', name, category, Clock::now(), Clock::duration::zero(), args);
+  }
+
+  // Writes the recorded events, tracks sorted by first use.
+  bool WriteTo(const std::string& filename, std::string* error) const {
+    std::FILE* file = std::fopen(filename.c_str(), "wb");
+    if (file == nullptr) {
+      *error = "cannot write " + filename;
+      return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", file);
+    std::fputs("{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,\"tid\":0,"
+               "\"args\":{\"name\":\"rcpsp\"}}",
+               file);
+    for (size_t t = 0; t < tracks_.size(); ++t) {
+      std::fprintf(file,
+                   ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%zu,"
+                   "\"args\":{\"name\":\"%s\"}}",
+                   t, JsonEscaped(tracks_[t].name).c_str());
+      std::fprintf(file,
+                   ",\n{\"ph\":\"M\",\"name\":\"thread_sort_index\",\"pid\":1,\"tid\":%zu,"
+                   "\"args\":{\"sort_index\":%zu}}",
+                   t, t);
+    }
+    for (const Record& record : records_) {
+      std::fprintf(file, ",\n{\"ph\":\"%c\",\"name\":\"%s\",\"cat\":\"%s\",\"pid\":1,\"tid\":%d,",
+                   record.phase, JsonEscaped(record.name).c_str(), record.category, record.track);
+      std::fprintf(file, "\"ts\":%s", Micros(record.begin_ns).c_str());
+      if (record.phase == 'X') {
+        std::fprintf(file, ",\"dur\":%s", Micros(record.duration_ns).c_str());
+      } else {
+        std::fputs(",\"s\":\"t\"", file);
+      }
+      if (!record.args.empty()) std::fprintf(file, ",\"args\":%s", record.args.c_str());
+      std::fputc('}', file);
+    }
+    std::fprintf(file, "\n],\"otherData\":{\"events\":%zu,\"dropped\":%" PRId64 "}}\n",
+                 records_.size(), dropped_);
+    const bool ok = std::fclose(file) == 0;
+    if (!ok) *error = "write failed for " + filename;
+    return ok;
+  }
+
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return records_.size();
+  }
+
+ private:
+  struct Record {
+    char phase;
+    int track;
+    int64_t begin_ns;
+    int64_t duration_ns;
+    const char* category;
+    std::string name;
+    std::string args;
+  };
+
+  struct Track {
+    std::string name;
+  };
+
+  void Add(char phase, std::string_view name, const char* category, Clock::time_point begin,
+           Clock::duration duration, std::string_view args) {
+    const int64_t begin_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(begin - start_).count();
+    const int64_t duration_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (static_cast<int64_t>(records_.size()) >= max_events_) {
+      ++dropped_;
+      return;
+    }
+    records_.push_back({phase, TrackLocked(), begin_ns, duration_ns, category,
+                        std::string(name), std::string(args)});
+  }
+
+  int TrackLocked() {
+    const auto [it, inserted] =
+        track_of_thread_.emplace(std::this_thread::get_id(), static_cast<int>(tracks_.size()));
+    if (inserted) {
+      tracks_.push_back(
+          {it->second == 0 ? std::string("main") : "thread " + std::to_string(it->second)});
+    }
+    return it->second;
+  }
+
+  // Trace timestamps are microseconds; three decimals keep the nanoseconds.
+  static std::string Micros(int64_t nanos) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%" PRId64 ".%03" PRId64, nanos / 1000, nanos % 1000);
+    return text;
+  }
+
+  const Clock::time_point start_;
+  const int64_t max_events_;
+  mutable std::mutex mutex_;
+  std::vector<Record> records_;
+  std::vector<Track> tracks_;
+  std::unordered_map<std::thread::id, int> track_of_thread_;
+  int64_t dropped_ = 0;
+};
+
+// Records the lifetime of the scope as a span. A null timeline records
+// nothing and does not read the clock.
+class TimelineSpan {
+ public:
+  TimelineSpan(Timeline* timeline, const char* name, const char* category)
+      : timeline_(timeline), name_(name), category_(category) {
+    if (timeline_ != nullptr) begin_ = Timeline::Clock::now();
+  }
+
+  ~TimelineSpan() {
+    if (timeline_ != nullptr) {
+      timeline_->Complete(name_, category_, begin_, Timeline::Clock::now(), args_);
+    }
+  }
+
+  TimelineSpan(const TimelineSpan&) = delete;
+  TimelineSpan& operator=(const TimelineSpan&) = delete;
+
+  // JSON object shown with the span.
+  void set_args(std::string args) { args_ = std::move(args); }
+
+ private:
+  Timeline* const timeline_;
+  const char* const name_;
+  const char* const category_;
+  Timeline::Clock::time_point begin_;
+  std::string args_;
+};
+
+#endif  // TIMELINE_H_
@@ -0,0 +1,364 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "json_escape.h"
+#include "trace_reader.h"
+
+// Offline search-profile analyzer for events-*.json traces.
+//
+//   trace_analyze events-complex.json [--output=profile.json]
+//   trace_analyze baseline.json tuned.json [--output=diff.json]
+//
+// The trace is streamed event by event, so memory only grows with the number
+// of tasks, decision levels and improving solutions, never with trace length.
+
+// Nodes opened and backtracks taken at one decision level.
+struct LevelStats {
+  int64_t nodes = 0;
+  int64_t backtracks = 0;
+};
+
+// How often the search touched one task.
+struct TaskChurn {
+  std::string name;
+  int64_t bound_changes = 0;
+  int64_t assignments = 0;
+  int64_t backtracks = 0;
+
+  int64_t Total() const { return bound_changes + assignments + backtracks; }
+};
+
+// One point of the time-to-incumbent curve.
+struct CurvePoint {
+  int64_t timestamp;
+  double objective;
+  double best_bound;
+};
+
+class TraceProfile {
+ public:
+  explicit TraceProfile(const std::string& name) : name_(name) {}
+
+  void Add(const TraceEvent& event) {
+    // Incumbent lines captured from stdout only carry their wall time.
+    const int64_t timestamp =
+        event.timestamp == 0 && event.wall_time > 0.0
+            ? static_cast<int64_t>(std::llround(event.wall_time * 1000.0))
+            : event.timestamp;
+    ++num_events_;
+    if (num_events_ == 1) first_timestamp_ = timestamp;
+    last_timestamp_ = std::max(last_timestamp_, timestamp);
+
+    if (event.task_id < 0) {
+      if (event.type == "incumbent" && event.has_objective) {
+        AddIncumbent(timestamp, event.objective, event.best_bound);
+      } else if (event.type == "conflict") {
+        ++total_conflicts_;
+        total_explanation_size_ += std::max(0, event.explanation_size);
+      } else if (solver_start_ < 0 && event.description == "Solver started") {
+        solver_start_ = event.timestamp;
+      }
+      return;
+    }
+
+    TaskChurn& churn = tasks_[event.task_id];
+    if (churn.name.empty()) churn.name = event.task_name;
+
+    if (event.type == "modify") {
+      ++churn.bound_changes;
+      ++total_bound_changes_;
+    } else if (event.type == "assign") {
+      ++churn.assignments;
+      if (!event.node_id.empty()) {
+        ++levels_[event.decision_level].nodes;
+        ++total_nodes_;
+      }
+    } else if (event.type == "remove") {
+      ++churn.backtracks;
+      const int level = event.backtrack_to_level >= 0
+                            ? event.backtrack_to_level
+                            : event.decision_level;
+      ++levels_[level].backtracks;
+      ++total_backtracks_;
+    } else if (event.type == "start" &&
+               event.DescriptionStartsWith("Final solution")) {
+      if (final_solution_timestamp_ < 0) {
+        final_solution_timestamp_ = event.timestamp;
+      }
+      final_solution_makespan_ =
+          std::max(final_solution_makespan_, event.end_time);
+    }
+  }
+
+  // Must be called once the whole trace was read.
+  void Finish() {
+    // Traces written before incumbent events existed only carry the final
+    // schedule; use it as a single-point curve.
+    if (curve_.empty() && final_solution_timestamp_ >= 0) {
+      AddIncumbent(final_solution_timestamp_,
+                   static_cast<double>(final_solution_makespan_),
+                   std::numeric_limits<double>::quiet_NaN());
+    }
+    if (solver_start_ < 0) solver_start_ = first_timestamp_;
+  }
+
+  int64_t num_events() const { return num_events_; }
+  int64_t total_nodes() const { return total_nodes_; }
+  int64_t total_backtracks() const { return total_backtracks_; }
+  int64_t total_bound_changes() const { return total_bound_changes_; }
+  int64_t total_conflicts() const { return total_conflicts_; }
+  int64_t duration_ms() const { return last_timestamp_ - first_timestamp_; }
+
+  bool has_incumbent() const { return !curve_.empty(); }
+  double final_objective() const { return curve_.back().objective; }
+  int64_t time_to_first_incumbent_ms() const {
+    return curve_.front().timestamp - first_timestamp_;
+  }
+  int64_t time_to_best_ms() const {
+    return curve_.back().timestamp - first_timestamp_;
+  }
+
+  // Primal integral in seconds (Berthold 2013): the integral over the run of
+  // the primal gap to the best known objective, taken as 1 before the first
+  // incumbent. Lower is better; a solver that finds the final answer at once
+  // scores (time to first incumbent).
+  double PrimalIntegral() const {
+    const double duration = duration_ms() / 1000.0;
+    if (curve_.empty()) return duration;
+    const double best = curve_.back().objective;
+    double integral = (curve_.front().timestamp - first_timestamp_) / 1000.0;
+    for (size_t i = 0; i < curve_.size(); ++i) {
+      const int64_t until = i + 1 < curve_.size() ? curve_[i + 1].timestamp
+                                                  : last_timestamp_;
+      integral += PrimalGap(curve_[i].objective, best) *
+                  (until - curve_[i].timestamp) / 1000.0;
+    }
+    return integral;
+  }
+
+  std::string ToJson(const std::string& indent) const {
+    const std::string in = indent + "  ";
+    std::ostringstream oss;
+    oss << "{\n";
+    oss << in << "\"trace\": \"" << JsonEscaped(name_) << "\",\n";
+    oss << in << "\"events\": " << num_events_ << ",\n";
+    oss << in << "\"durationMs\": " << duration_ms() << ",\n";
+    oss << in << "\"nodes\": " << total_nodes_ << ",\n";
+    oss << in << "\"backtracks\": " << total_backtracks_ << ",\n";
+    oss << in << "\"boundChanges\": " << total_bound_changes_ << ",\n";
+    if (total_conflicts_ > 0) {
+      oss << in << "\"conflicts\": " << total_conflicts_ << ",\n";
+      oss << in << "\"meanExplanationSize\": "
+          << static_cast<double>(total_explanation_size_) / total_conflicts_
+          << ",\n";
+    }
+    if (has_incumbent()) {
+      oss << in << "\"finalObjective\": " << final_objective() << ",\n";
+      oss << in << "\"timeToFirstIncumbentMs\": "
+          << time_to_first_incumbent_ms() << ",\n";
+      oss << in << "\"timeToBestMs\": " << time_to_best_ms() << ",\n";
+    }
+    oss << in << "\"primalIntegral\": " << PrimalIntegral() << ",\n";
+
+    oss << in << "\"incumbentCurve\": [";
+    for (size_t i = 0; i < curve_.size(); ++i) {
+      const CurvePoint& point = curve_[i];
+      oss << (i > 0 ? "," : "") << "\n" << in << "  {\"timeMs\": "
+          << point.timestamp - first_timestamp_
+          << ", \"objective\": " << point.objective << ", \"bestBound\": ";
+      if (point.best_bound == point.best_bound) {
+        oss << point.best_bound;
+      } else {
+        oss << "null";
+      }
+      oss << ", \"gap\": " << PrimalGap(point.objective, final_objective())
+          << "}";
+    }
+    oss << (curve_.empty() ? "" : "\n" + in) << "],\n";
+
+    oss << in << "\"decisionLevels\": [";
+    bool first = true;
+    for (const auto& [level, stats] : levels_) {
+      oss << (first ? "" : ",") << "\n" << in << "  {\"level\": " << level
+          << ", \"nodes\": " << stats.nodes
+          << ", \"backtracks\": " << stats.backtracks << "}";
+      first = false;
+    }
+    oss << (levels_.empty() ? "" : "\n" + in) << "],\n";
+
+    // Sorted by churn so the plot shows the most contested tasks first.
+    std::vector<std::pair<int, const TaskChurn*>> tasks;
+    for (const auto& [task_id, churn] : tasks_) tasks.push_back({task_id, &churn});
+    std::stable_sort(tasks.begin(), tasks.end(), [](const auto& a, const auto& b) {
+      return a.second->Total() > b.second->Total();
+    });
+    oss << in << "\"taskChurn\": [";
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      const TaskChurn& churn = *tasks[i].second;
+      oss << (i > 0 ? "," : "") << "\n" << in << "  {\"taskId\": "
+          << tasks[i].first << ", \"taskName\": \"" << JsonEscaped(churn.name)
+          << "\", \"boundChanges\": " << churn.bound_changes
+          << ", \"assignments\": " << churn.assignments
+          << ", \"backtracks\": " << churn.backtracks
+          << ", \"churn\": " << churn.Total() << "}";
+    }
+    oss << (tasks.empty() ? "" : "\n" + in) << "],\n";
+
+    // Only inferred from incumbent timestamps; the solver's own phases are in
+    // the --timeline profile.
+    oss << in << "\"incumbentPhases\": [";
+    const std::vector<std::pair<const char*, int64_t>> phases = PhaseDurations();
+    for (size_t i = 0; i < phases.size(); ++i) {
+      const double share =
+          duration_ms() > 0 ? static_cast<double>(phases[i].second) / duration_ms()
+                            : 0.0;
+      oss << (i > 0 ? "," : "") << "\n" << in << "  {\"phase\": \""
+          << phases[i].first << "\", \"durationMs\": " << phases[i].second
+          << ", \"share\": " << share << "}";
+    }
+    oss << "\n" << in << "]\n";
+    oss << indent << "}";
+    return oss.str();
+  }
+
+ private:
+  void AddIncumbent(int64_t timestamp, double objective, double best_bound) {
+    if (!curve_.empty() && objective >= curve_.back().objective) return;
+    curve_.push_back({timestamp, objective, best_bound});
+  }
+
+  static double PrimalGap(double objective, double best) {
+    const double denominator = std::max(std::abs(objective), std::abs(best));
+    if (denominator == 0.0) return 0.0;
+    return std::abs(objective - best) / denominator;
+  }
+
+  // Splits the run at the solver start and at the first and last incumbent:
+  // building and loading the model, searching for a first solution, improving
+  // it, and the tail spent without further improvement (proving or waiting
+  // for the time limit). These are not the solver's phases, which the trace
+  // does not record, only what the incumbent timestamps imply.
+  std::vector<std::pair<const char*, int64_t>> PhaseDurations() const {
+    const int64_t first_incumbent =
+        curve_.empty() ? last_timestamp_ : curve_.front().timestamp;
+    const int64_t last_incumbent =
+        curve_.empty() ? last_timestamp_ : curve_.back().timestamp;
+    const int64_t search_start = std::max(first_timestamp_, solver_start_);
+    return {{"model", search_start - first_timestamp_},
+            {"firstSolution", std::max<int64_t>(0, first_incumbent - search_start)},
+            {"improve", last_incumbent - first_incumbent},
+            {"tail", last_timestamp_ - last_incumbent}};
+  }
+
+  std::string name_;
+  int64_t num_events_ = 0;
+  int64_t first_timestamp_ = 0;
+  int64_t last_timestamp_ = 0;
+  int64_t solver_start_ = -1;
+  int64_t final_solution_timestamp_ = -1;
+  int64_t final_solution_makespan_ = 0;
+  int64_t total_nodes_ = 0;
+  int64_t total_backtracks_ = 0;
+  int64_t total_bound_changes_ = 0;
+  int64_t total_conflicts_ = 0;
+  int64_t total_explanation_size_ = 0;
+  std::map<int, LevelStats> levels_;
+  std::map<int, TaskChurn> tasks_;
+  std::vector<CurvePoint> curve_;
+};
+
+bool AnalyzeTrace(const std::string& filename, TraceProfile* profile) {
+  TraceReader reader(filename);
+  if (!reader.is_open()) {
+    std::cerr << "Cannot open trace " << filename << std::endl;
+    return false;
+  }
+  TraceEvent event;
+  while (reader.Next(&event)) {
+    profile->Add(event);
+  }
+  profile->Finish();
+  return true;
+}
+
+// Differences are reported as (second - first), so negative values mean the
+// second configuration needed less of something.
+std::string DiffToJson(const TraceProfile& a, const TraceProfile& b) {
+  std::ostringstream oss;
+  oss << "{\n";
+  oss << "    \"events\": " << b.num_events() - a.num_events() << ",\n";
+  oss << "    \"durationMs\": " << b.duration_ms() - a.duration_ms() << ",\n";
+  oss << "    \"nodes\": " << b.total_nodes() - a.total_nodes() << ",\n";
+  oss << "    \"backtracks\": " << b.total_backtracks() - a.total_backtracks()
+      << ",\n";
+  oss << "    \"boundChanges\": "
+      << b.total_bound_changes() - a.total_bound_changes() << ",\n";
+  oss << "    \"conflicts\": " << b.total_conflicts() - a.total_conflicts()
+      << ",\n";
+  if (a.has_incumbent() && b.has_incumbent()) {
+    oss << "    \"finalObjective\": " << b.final_objective() - a.final_objective()
+        << ",\n";
+    oss << "    \"timeToFirstIncumbentMs\": "
+        << b.time_to_first_incumbent_ms() - a.time_to_first_incumbent_ms()
+        << ",\n";
+    oss << "    \"timeToBestMs\": " << b.time_to_best_ms() - a.time_to_best_ms()
+        << ",\n";
+  }
+  oss << "    \"primalIntegral\": " << b.PrimalIntegral() - a.PrimalIntegral()
+      << "\n";
+  oss << "  }";
+  return oss.str();
+}
+
+int main(int argc, char** argv) {
+  std::vector<std::string> traces;
+  std::string output_file;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg.rfind("--output=", 0) == 0) {
+      output_file = arg.substr(9);
+    } else if (arg.rfind("--", 0) == 0) {
+      std::cerr << "Unknown flag: " << arg << std::endl;
+      return 1;
+    } else {
+      traces.push_back(arg);
+    }
+  }
+  if (traces.empty() || traces.size() > 2) {
+    std::cerr << "Usage: trace_analyze <trace.json> [<other.json>] "
+                 "[--output=file]" << std::endl;
+    return 1;
+  }
+
+  std::vector<TraceProfile> profiles;
+  for (const std::string& trace : traces) {
+    profiles.emplace_back(trace);
+    if (!AnalyzeTrace(trace, &profiles.back())) return 1;
+  }
+
+  std::string json;
+  if (profiles.size() == 1) {
+    json = profiles[0].ToJson("") + "\n";
+  } else {
+    json = "{\n  \"traces\": [\n    " + profiles[0].ToJson("    ") + ",\n    " +
+           profiles[1].ToJson("    ") + "\n  ],\n  \"diff\": " +
+           DiffToJson(profiles[0], profiles[1]) + "\n}\n";
+  }
+
+  if (output_file.empty()) {
+    std::cout << json;
+  } else {
+    std::ofstream out(output_file);
+    out << json;
+    std::cerr << "Profile written to " << output_file << std::endl;
+  }
+  return 0;
+}
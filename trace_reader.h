@@ -0,0 +1,311 @@
+#ifndef TRACE_READER_H_
+#define TRACE_READER_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// One event of an events-*.json trace. Only the fields the offline tools need
+// are kept; everything else is skipped while parsing. The same instance is
+// reused for every event so that reading a trace does not allocate per event.
+struct TraceEvent {
+  std::string type;
+  int task_id = -1;
+  std::string task_name;
+  int64_t timestamp = 0;
+  int64_t start_time = 0;
+  int64_t end_time = 0;
+  int64_t time = 0;  // start/complete events of rcpsp_solver output
+  int decision_level = 0;
+  int backtrack_to_level = -1;
+  std::string node_id;
+  std::string description;
+  bool has_objective = false;
+  double objective = 0.0;
+  double best_bound = 0.0;
+  double wall_time = 0.0;
+  int explanation_size = -1;
+  std::vector<int64_t> dependencies;
+  std::vector<int64_t> successors;
+  std::vector<int64_t> solution;
+
+  void Clear() {
+    type.clear();
+    task_id = -1;
+    task_name.clear();
+    timestamp = 0;
+    start_time = 0;
+    end_time = 0;
+    time = 0;
+    decision_level = 0;
+    backtrack_to_level = -1;
+    node_id.clear();
+    description.clear();
+    has_objective = false;
+    objective = 0.0;
+    best_bound = 0.0;
+    wall_time = 0.0;
+    explanation_size = -1;
+    dependencies.clear();
+    successors.clear();
+    solution.clear();
+  }
+
+  bool DescriptionStartsWith(const char* prefix) const {
+    return description.rfind(prefix, 0) == 0;
+  }
+};
+
+// Streams events out of a trace file in constant memory. Accepts both the
+// {"version": ..., "events": [...]} files written by driver and a plain
+// sequence of JSON objects such as the incumbent lines printed on stdout.
+class TraceReader {
+ public:
+  explicit TraceReader(const std::string& filename)
+      : file_(std::fopen(filename.c_str(), "rb")) {
+    if (file_ == nullptr) return;
+    SkipWhitespace();
+    if (Peek() != '{') return;
+    // Look for an "events" array in the top-level object. If the first object
+    // is an event itself, rewind and read the file as a stream of objects.
+    Get();
+    std::string key;
+    while (ReadKey(&key)) {
+      if (key == "events") {
+        SkipWhitespace();
+        if (Get() == '[') {
+          event_file_ = true;
+          return;
+        }
+        break;
+      }
+      SkipValue();
+      SkipWhitespace();
+      if (Peek() == ',') Get();
+    }
+    std::rewind(file_);
+    buffer_pos_ = buffer_end_ = 0;
+  }
+
+  ~TraceReader() {
+    if (file_ != nullptr) std::fclose(file_);
+  }
+
+  TraceReader(const TraceReader&) = delete;
+  TraceReader& operator=(const TraceReader&) = delete;
+
+  bool is_open() const { return file_ != nullptr; }
+
+  // True for a single object with an "events" array, false for a stream of
+  // objects.
+  bool is_event_file() const { return event_file_; }
+
+  // Reads the next event. Returns false at the end of the trace.
+  bool Next(TraceEvent* event) {
+    if (file_ == nullptr) return false;
+    SkipWhitespace();
+    if (Peek() == ',') {
+      Get();
+      SkipWhitespace();
+    }
+    if (Peek() != '{') return false;
+    Get();
+    event->Clear();
+    std::string& key = key_buffer_;
+    while (ReadKey(&key)) {
+      SkipWhitespace();
+      if (key == "type") {
+        ReadString(&event->type);
+      } else if (key == "taskId") {
+        event->task_id = static_cast<int>(ReadInteger());
+      } else if (key == "taskName") {
+        ReadString(&event->task_name);
+      } else if (key == "timestamp") {
+        event->timestamp = ReadInteger();
+      } else if (key == "startTime") {
+        event->start_time = ReadInteger();
+      } else if (key == "endTime") {
+        event->end_time = ReadInteger();
+      } else if (key == "time") {
+        event->time = ReadInteger();
+      } else if (key == "decisionLevel") {
+        event->decision_level = static_cast<int>(ReadInteger());
+      } else if (key == "backtrackToLevel") {
+        event->backtrack_to_level = static_cast<int>(ReadInteger());
+      } else if (key == "nodeId") {
+        ReadString(&event->node_id);
+      } else if (key == "description") {
+        ReadString(&event->description);
+      } else if (key == "objective") {
+        event->has_objective = true;
+        event->objective = ReadNumber();
+      } else if (key == "bestBound") {
+        event->best_bound = ReadNumber();
+      } else if (key == "wallTime") {
+        event->wall_time = ReadNumber();
+      } else if (key == "explanationSize") {
+        event->explanation_size = static_cast<int>(ReadInteger());
+      } else if (key == "dependencies") {
+        ReadIntegerArray(&event->dependencies);
+      } else if (key == "successors") {
+        ReadIntegerArray(&event->successors);
+      } else if (key == "solution" || key == "starts") {
+        ReadIntegerArray(&event->solution);
+      } else {
+        SkipValue();
+      }
+      SkipWhitespace();
+      if (Peek() == ',') Get();
+    }
+    return true;
+  }
+
+ private:
+  int Peek() {
+    if (buffer_pos_ == buffer_end_ && !Fill()) return EOF;
+    return static_cast<unsigned char>(buffer_[buffer_pos_]);
+  }
+
+  int Get() {
+    const int c = Peek();
+    if (c != EOF) ++buffer_pos_;
+    return c;
+  }
+
+  bool Fill() {
+    if (file_ == nullptr) return false;
+    buffer_end_ = std::fread(buffer_, 1, sizeof(buffer_), file_);
+    buffer_pos_ = 0;
+    return buffer_end_ > 0;
+  }
+
+  void SkipWhitespace() {
+    for (int c = Peek(); c == ' ' || c == '\n' || c == '\r' || c == '\t';
+         c = Peek()) {
+      Get();
+    }
+  }
+
+  // Reads `"key":` and returns true, or consumes the closing brace of the
+  // current object and returns false.
+  bool ReadKey(std::string* key) {
+    SkipWhitespace();
+    if (Peek() != '"') {
+      if (Peek() == '}') Get();
+      return false;
+    }
+    ReadString(key);
+    SkipWhitespace();
+    if (Peek() == ':') Get();
+    return true;
+  }
+
+  void ReadString(std::string* out) {
+    out->clear();
+    if (Peek() != '"') {
+      SkipValue();
+      return;
+    }
+    Get();
+    for (int c = Get(); c != EOF && c != '"'; c = Get()) {
+      if (c == '\\') {
+        c = Get();
+        switch (c) {
+          case 'n': c = '\n'; break;
+          case 't': c = '\t'; break;
+          case 'u':
+            // Non-ASCII names are not used by the tools; keep a placeholder.
+            for (int i = 0; i < 4; ++i) Get();
+            c = '?';
+            break;
+          default: break;
+        }
+      }
+      out->push_back(static_cast<char>(c));
+    }
+  }
+
+  double ReadNumber() {
+    // Task ids are written as strings by driver, so accept quoted numbers.
+    const bool quoted = Peek() == '"';
+    if (quoted) Get();
+    char digits[64];
+    size_t length = 0;
+    for (int c = Peek(); c != EOF && length + 1 < sizeof(digits) &&
+                         ((c >= '0' && c <= '9') || c == '-' || c == '+' ||
+                          c == '.' || c == 'e' || c == 'E');
+         c = Peek()) {
+      digits[length++] = static_cast<char>(Get());
+    }
+    digits[length] = '\0';
+    if (quoted) {
+      while (Peek() != EOF && Get() != '"') {
+      }
+    } else if (length == 0) {
+      SkipValue();
+    }
+    return std::strtod(digits, nullptr);
+  }
+
+  int64_t ReadInteger() { return static_cast<int64_t>(ReadNumber()); }
+
+  void ReadIntegerArray(std::vector<int64_t>* out) {
+    out->clear();
+    if (Peek() != '[') {
+      SkipValue();
+      return;
+    }
+    Get();
+    SkipWhitespace();
+    while (Peek() != ']' && Peek() != EOF) {
+      out->push_back(ReadInteger());
+      SkipWhitespace();
+      if (Peek() == ',') Get();
+      SkipWhitespace();
+    }
+    Get();
+  }
+
+  void SkipValue() {
+    SkipWhitespace();
+    const int c = Peek();
+    if (c == '"') {
+      ReadString(&skip_buffer_);
+    } else if (c == '{' || c == '[') {
+      int depth = 0;
+      bool in_string = false;
+      for (int d = Get(); d != EOF; d = Get()) {
+        if (in_string) {
+          if (d == '\\') {
+            Get();
+          } else if (d == '"') {
+            in_string = false;
+          }
+        } else if (d == '"') {
+          in_string = true;
+        } else if (d == '{' || d == '[') {
+          ++depth;
+        } else if (d == '}' || d == ']') {
+          if (--depth == 0) return;
+        }
+      }
+    } else {
+      for (int d = Peek(); d != EOF && d != ',' && d != '}' && d != ']';
+           d = Peek()) {
+        Get();
+      }
+    }
+  }
+
+  std::FILE* file_;
+  bool event_file_ = false;
+  char buffer_[1 << 16];
+  size_t buffer_pos_ = 0;
+  size_t buffer_end_ = 0;
+  std::string key_buffer_;
+  std::string skip_buffer_;
+};
+
+#endif  // TRACE_READER_H_